@@ -0,0 +1,287 @@
+#include "ChunkCorpus.h"
+#include "VoxelWorld.h"
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+// xorshift32 determinista para los casos aleatorios
+static uint32_t nextRandom(uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static int voxelIndex(const glm::ivec3& size, int x, int y, int z) {
+	return z * size.y * size.x + y * size.x + x;
+}
+
+static bool solidAt(const CorpusCase& c, const glm::ivec3& p) {
+	if (p.x < 0 || p.x >= c.size.x || p.y < 0 || p.y >= c.size.y || p.z < 0 || p.z >= c.size.z)
+		return false;
+	return c.voxels[voxelIndex(c.size, p.x, p.y, p.z)] != 0;
+}
+
+static const glm::ivec3 kFaceDirs[6] = {
+	glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+	glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+	glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+};
+
+static CorpusCase makeCase(const std::string& name, const glm::ivec3& size) {
+	CorpusCase c;
+	c.name = name;
+	c.size = size;
+	c.voxels.assign(size.x * size.y * size.z, 0);
+	return c;
+}
+
+void ChunkCorpus::computeInvariants(CorpusCase& c) {
+	c.solidCount = 0;
+	c.exposedFaceArea = 0;
+
+	bool seen[256] = {};
+	for (int z = 0; z < c.size.z; z++) {
+		for (int y = 0; y < c.size.y; y++) {
+			for (int x = 0; x < c.size.x; x++) {
+				uint8_t v = c.voxels[voxelIndex(c.size, x, y, z)];
+				if (v == 0) continue;
+
+				c.solidCount++;
+				seen[v] = true;
+				for (int face = 0; face < 6; face++) {
+					if (!solidAt(c, glm::ivec3(x, y, z) + kFaceDirs[face])) c.exposedFaceArea++;
+				}
+			}
+		}
+	}
+
+	c.materialCount = 0;
+	for (int m = 1; m < 256; m++) if (seen[m]) c.materialCount++;
+}
+
+std::vector<CorpusCase> ChunkCorpus::generate(const glm::ivec3& size, uint32_t seed) {
+	std::vector<CorpusCase> cases;
+	uint32_t rng = seed ? seed : 1u;
+
+	cases.push_back(makeCase("empty", size));
+
+	{
+		CorpusCase c = makeCase("solid", size);
+		std::fill(c.voxels.begin(), c.voxels.end(), 1);
+		cases.push_back(c);
+	}
+
+	{
+		CorpusCase c = makeCase("single_voxel", size);
+		c.voxels[voxelIndex(size, size.x / 2, size.y / 2, size.z / 2)] = 1;
+		cases.push_back(c);
+	}
+
+	// Peor caso: ningn par de vecinos comparte estado
+	{
+		CorpusCase c = makeCase("checkerboard", size);
+		for (int z = 0; z < size.z; z++)
+			for (int y = 0; y < size.y; y++)
+				for (int x = 0; x < size.x; x++)
+					if (((x + y + z) & 1) == 0) c.voxels[voxelIndex(size, x, y, z)] = 1;
+		cases.push_back(c);
+	}
+
+	const int densities[] = { 10, 25, 50, 75, 90 };
+	for (int density : densities) {
+		CorpusCase c = makeCase("noise_" + std::to_string(density), size);
+		for (uint8_t& v : c.voxels) {
+			if ((int)(nextRandom(rng) % 100) < density) v = 1;
+		}
+		cases.push_back(c);
+	}
+
+	{
+		CorpusCase c = makeCase("hollow_shell", size);
+		for (int z = 0; z < size.z; z++)
+			for (int y = 0; y < size.y; y++)
+				for (int x = 0; x < size.x; x++) {
+					bool border = x == 0 || y == 0 || z == 0 ||
+						x == size.x - 1 || y == size.y - 1 || z == size.z - 1;
+					if (border) c.voxels[voxelIndex(size, x, y, z)] = 1;
+				}
+		cases.push_back(c);
+	}
+
+	// Slido pero con material aleatorio: el greedy no puede fusionar
+	{
+		CorpusCase c = makeCase("many_materials", size);
+		for (uint8_t& v : c.voxels) v = (uint8_t)(1 + nextRandom(rng) % 64);
+		cases.push_back(c);
+	}
+
+	{
+		CorpusCase c = makeCase("material_stripes", size);
+		for (int z = 0; z < size.z; z++)
+			for (int y = 0; y < size.y; y++)
+				for (int x = 0; x < size.x; x++)
+					c.voxels[voxelIndex(size, x, y, z)] = (uint8_t)(1 + (x + z) % 4);
+		cases.push_back(c);
+	}
+
+	{
+		CorpusCase c = makeCase("pillars", size);
+		for (int z = 0; z < size.z; z += 3)
+			for (int x = 0; x < size.x; x += 3) {
+				int height = 1 + (int)(nextRandom(rng) % size.y);
+				for (int y = 0; y < height; y++) c.voxels[voxelIndex(size, x, y, z)] = 2;
+			}
+		cases.push_back(c);
+	}
+
+	// Cuevas: piedra con tneles de suma de senos
+	{
+		CorpusCase c = makeCase("caves", size);
+		float phase = (nextRandom(rng) % 1000) / 100.0f;
+		for (int z = 0; z < size.z; z++)
+			for (int y = 0; y < size.y; y++)
+				for (int x = 0; x < size.x; x++) {
+					float d = std::sin(x * 0.31f + phase) + std::sin(y * 0.43f + z * 0.21f) +
+						std::sin(z * 0.37f + x * 0.13f + phase);
+					if (d < 1.1f) c.voxels[voxelIndex(size, x, y, z)] = 3;
+				}
+		cases.push_back(c);
+	}
+
+	// Cortes de terreno reales del generador de VoxelWorld
+	if (size == glm::ivec3(32)) {
+		VoxelWorld world(2, 4, 2);
+		world.setSeed(seed);
+		world.generateTerrain();
+
+		std::vector<const Chunk*> mixed;
+		for (const auto& entry : world.getChunks()) {
+			const Chunk* chunk = entry.second.get();
+			int solid = chunk->solidCount();
+			if (solid > 0 && solid < (int)chunk->voxelData.size()) mixed.push_back(chunk);
+		}
+		std::sort(mixed.begin(), mixed.end(), [](const Chunk* a, const Chunk* b) {
+			return a->id < b->id;
+		});
+
+		for (size_t i = 0; i < mixed.size() && i < 3; i++) {
+			CorpusCase c = makeCase("terrain_" + std::to_string(i), size);
+			mixed[i]->copyVoxels(c.voxels);
+			cases.push_back(c);
+		}
+	}
+
+	for (CorpusCase& c : cases) computeInvariants(c);
+	return cases;
+}
+
+CorpusCheck ChunkCorpus::checkCuboids(const CorpusCase& c, const std::vector<Cuboid>& cuboids) {
+	CorpusCheck check;
+	std::vector<uint8_t> covered(c.voxels.size(), 0);
+	std::ostringstream err;
+
+	for (const Cuboid& cub : cuboids) {
+		if (glm::any(glm::lessThan(cub.min, glm::ivec3(0))) ||
+			glm::any(glm::greaterThanEqual(cub.max, c.size)) ||
+			glm::any(glm::greaterThan(cub.min, cub.max))) {
+			check.valid = false;
+			err << "cuboid out of bounds; ";
+			continue;
+		}
+
+		for (int z = cub.min.z; z <= cub.max.z; z++)
+			for (int y = cub.min.y; y <= cub.max.y; y++)
+				for (int x = cub.min.x; x <= cub.max.x; x++) {
+					int idx = voxelIndex(c.size, x, y, z);
+					if (c.voxels[idx] != cub.material) {
+						check.valid = false;
+						err << "material mismatch at " << x << "," << y << "," << z << "; ";
+					}
+					if (covered[idx]++) {
+						check.valid = false;
+						err << "overlap at " << x << "," << y << "," << z << "; ";
+					}
+					check.cuboidVolume++;
+				}
+	}
+
+	if (check.cuboidVolume != c.solidCount) {
+		check.valid = false;
+		err << "volume " << check.cuboidVolume << " != solid " << c.solidCount << "; ";
+	}
+
+	check.error = err.str().substr(0, 256);
+	return check;
+}
+
+CorpusCheck ChunkCorpus::checkMesh(const CorpusCase& c, const Mesh& mesh, bool requireCulled) {
+	CorpusCheck check;
+	std::ostringstream err;
+
+	// Un contador por cara unitaria de voxel (6 por voxel)
+	std::vector<uint8_t> faceHits(c.voxels.size() * 6, 0);
+
+	if (mesh.vertices.size() % 4 != 0) {
+		check.valid = false;
+		check.error = "vertex count is not a multiple of 4";
+		return check;
+	}
+
+	for (size_t q = 0; q < mesh.vertices.size(); q += 4) {
+		glm::vec3 n = mesh.vertices[q].normal;
+		int axis = std::fabs(n.x) > 0.5f ? 0 : (std::fabs(n.y) > 0.5f ? 1 : 2);
+		bool positive = n[axis] > 0.0f;
+		int face = axis * 2 + (positive ? 0 : 1);
+		int ua = (axis + 1) % 3, va = (axis + 2) % 3;
+
+		glm::vec3 lo = mesh.vertices[q].position, hi = lo;
+		for (int k = 1; k < 4; k++) {
+			lo = glm::min(lo, mesh.vertices[q + k].position);
+			hi = glm::max(hi, mesh.vertices[q + k].position);
+		}
+
+		// El plano est a +-0.5 del centro del voxel interior
+		int inner = (int)std::lround(positive ? lo[axis] - 0.5f : lo[axis] + 0.5f);
+		int u0 = (int)std::lround(lo[ua] + 0.5f), u1 = (int)std::lround(hi[ua] + 0.5f);
+		int v0 = (int)std::lround(lo[va] + 0.5f), v1 = (int)std::lround(hi[va] + 0.5f);
+
+		for (int u = u0; u < u1; u++) {
+			for (int v = v0; v < v1; v++) {
+				glm::ivec3 p;
+				p[axis] = inner;
+				p[ua] = u;
+				p[va] = v;
+				check.emittedFaceArea++;
+
+				if (glm::any(glm::lessThan(p, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(p, c.size))) {
+					check.valid = false;
+					err << "quad outside chunk; ";
+					continue;
+				}
+
+				bool exposed = solidAt(c, p) && !solidAt(c, p + kFaceDirs[face]);
+				uint8_t& hits = faceHits[voxelIndex(c.size, p.x, p.y, p.z) * 6 + face];
+				if (exposed) {
+					if (hits == 0) check.coveredExposedArea++;
+				}
+				else {
+					check.hiddenFaceArea++;
+				}
+				if (hits < 255) hits++;
+			}
+		}
+	}
+
+	if (check.coveredExposedArea != c.exposedFaceArea) {
+		check.valid = false;
+		err << "covered " << check.coveredExposedArea << " of " << c.exposedFaceArea << " exposed faces; ";
+	}
+	if (requireCulled && check.hiddenFaceArea != 0) {
+		check.valid = false;
+		err << check.hiddenFaceArea << " hidden faces emitted; ";
+	}
+
+	check.error = err.str().substr(0, 256);
+	return check;
+}
@@ -0,0 +1,49 @@
+#ifndef CHUNK_CORPUS_H
+#define CHUNK_CORPUS_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "GreedyMesher.h"
+
+// Caso sinttico de chunk con sus invariantes precalculados
+struct CorpusCase {
+	std::string name;
+	glm::ivec3 size;
+	std::vector<uint8_t> voxels;
+
+	// Invariantes derivados solo de los voxels
+	int solidCount = 0;
+	int exposedFaceArea = 0;  // Caras de voxel slido contra vaco o borde
+	int materialCount = 0;
+};
+
+// Resultado de validar la salida de un mesher contra un caso
+struct CorpusCheck {
+	bool valid = true;
+	std::string error;
+
+	int cuboidVolume = 0;
+	int emittedFaceArea = 0;     // rea total de los quads emitidos
+	int coveredExposedArea = 0;  // Caras expuestas cubiertas por algn quad
+	int hiddenFaceArea = 0;      // rea emitida sobre caras no expuestas
+};
+
+class ChunkCorpus {
+public:
+	// Genera todos los casos para un tamao de chunk y semilla dados
+	static std::vector<CorpusCase> generate(const glm::ivec3& size, uint32_t seed);
+
+	static void computeInvariants(CorpusCase& c);
+
+	// Los cuboides deben cubrir exactamente los voxels slidos, sin solaparse,
+	// y cada uno con un solo material
+	static CorpusCheck checkCuboids(const CorpusCase& c, const std::vector<Cuboid>& cuboids);
+
+	// Toda cara expuesta debe quedar cubierta por un quad con su normal.
+	// requireCulled: adems no se admite rea sobre caras ocultas.
+	static CorpusCheck checkMesh(const CorpusCase& c, const Mesh& mesh, bool requireCulled);
+};
+
+#endif
@@ -0,0 +1,2126 @@
+// voxelbench: benchmark sin ventana ni contexto GL de generacin, mallado,
+// LOD y culling. Salida JSON en stdout (o --out fichero).
+#include "VoxelWorld.h"
+#include "GreedyMesher.h"
+#include "Profiler.h"
+#include "ChunkCorpus.h"
+#include "RegionFile.h"
+#include "EditJournal.h"
+#include "VoxelCollision.h"
+#include "LightEngine.h"
+#include "MaterialTable.h"
+#include "SurfaceNets.h"
+#include "MeshOptimizer.h"
+#include "MeshArena.h"
+#include "MortonLayout.h"
+#include "LodDownsampler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <iterator>
+#include <array>
+#include <set>
+#include <atomic>
+#include <new>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Reservas de memoria del proceso (operator new), para medir las del mallado.
+// Se reemplaza la familia completa (tambin las formas de array) y fuera de
+// lnea: si GCC ve el free() junto al operator new avisa de un par mal casado
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static std::atomic<uint64_t> allocationCount{ 0 };
+
+static BENCH_NOINLINE void* countedAlloc(std::size_t size) {
+	allocationCount++;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+static BENCH_NOINLINE void countedFree(void* p) noexcept {
+	std::free(p);
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+
+// Tiempo de CPU del hilo actual. Con pocos ncleos el reloj de pared tambin
+// cuenta los jobs que le quitan la CPU mientras tanto (la luz de una edicin)
+static uint64_t threadCpuNs() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+	uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (k + u) * 100;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+struct BenchConfig {
+	glm::ivec3 worldSize = glm::ivec3(8, 4, 8);
+	uint32_t seed = 1337;
+	int reps = 3;
+	int renderDistance = 8;
+	std::string pathFile;
+	std::string outFile;
+	std::string traceFile;
+	std::string suite = "all";  // all | world | corpus
+	std::string regionDir = "voxelbench_regions";
+};
+
+struct BenchResult {
+	std::string name;
+	std::string unit;      // "chunk" o "frame"
+	int items = 0;
+	double nsPerItem = 0.0;
+	std::vector<std::pair<std::string, double>> metrics;
+};
+
+struct CameraSample {
+	glm::vec3 position;
+	glm::vec3 front;
+};
+
+static std::vector<CameraSample> loadCameraPath(const std::string& path) {
+	std::vector<CameraSample> samples;
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open camera path: " << path << std::endl;
+		return samples;
+	}
+
+	CameraSample s;
+	while (file >> s.position.x >> s.position.y >> s.position.z >> s.front.x >> s.front.y >> s.front.z) {
+		samples.push_back(s);
+	}
+	return samples;
+}
+
+// Ruta por defecto: vuelo circular sobre el centro del mundo
+static std::vector<CameraSample> defaultCameraPath(const glm::ivec3& worldSize, int frames) {
+	std::vector<CameraSample> samples;
+	glm::vec3 center = glm::vec3(worldSize) * 16.0f;
+	float radius = std::max(worldSize.x, worldSize.z) * 12.0f;
+
+	for (int i = 0; i < frames; i++) {
+		float angle = 6.2831853f * i / frames;
+		CameraSample s;
+		s.position = glm::vec3(center.x + std::cos(angle) * radius,
+			worldSize.y * 32.0f * 0.8f,
+			center.z + std::sin(angle) * radius);
+		s.front = glm::normalize(glm::vec3(-std::sin(angle), -0.3f, std::cos(angle)));
+		samples.push_back(s);
+	}
+	return samples;
+}
+
+static glm::mat4 viewProjFor(const CameraSample& s) {
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, 1000.0f);
+	glm::mat4 view = glm::lookAt(s.position, s.position + s.front, glm::vec3(0.0f, 1.0f, 0.0f));
+	return proj * view;
+}
+
+static double meshBytes(const Mesh& mesh) {
+	// Las mallas de quads no guardan ndices (EBO compartido)
+	return (double)(mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(uint32_t));
+}
+
+static BenchResult benchGeneration(const BenchConfig& config) {
+	BenchResult result;
+	result.name = "generate_terrain";
+	result.unit = "chunk";
+
+	// Mismo mundo con todos los workers y con uno solo: escalado del pipeline
+	uint64_t best = ~0ull;
+	uint64_t bestSingle = ~0ull;
+	int workers = 0;
+	for (int rep = 0; rep < config.reps; rep++) {
+		for (int single = 0; single < 2; single++) {
+			VoxelWorld world(config.worldSize.x, config.worldSize.y, config.worldSize.z);
+			world.setSeed(config.seed);
+			// La luz se mide aparte (benchLight)
+			world.setLighting(false);
+			if (single) world.setWorkerCount(1);
+			else workers = world.getJobSystem()->getWorkerCount();
+
+			uint64_t start = Profiler::nowNs();
+			world.generateTerrain();
+			uint64_t elapsed = Profiler::nowNs() - start;
+			if (single) bestSingle = std::min(bestSingle, elapsed);
+			else best = std::min(best, elapsed);
+			result.items = world.getTotalChunks();
+		}
+	}
+
+	// Clasificacin de contenido y memoria de voxels que queda residente
+	int empty = 0, uniform = 0;
+	double voxelBytes = 0.0;
+	{
+		VoxelWorld world(config.worldSize.x, config.worldSize.y, config.worldSize.z);
+		world.setSeed(config.seed);
+		world.generateTerrain();
+		for (const auto& entry : world.getChunks()) {
+			const Chunk* chunk = entry.second.get();
+			if (chunk->content == ChunkContent::Empty) empty++;
+			else if (chunk->content == ChunkContent::Uniform) uniform++;
+			voxelBytes += (double)(chunk->voxelData.capacity() + chunk->occupancy.capacity() * sizeof(uint32_t));
+		}
+	}
+
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)best / n;
+	result.metrics.push_back(std::make_pair("empty_chunks", (double)empty));
+	result.metrics.push_back(std::make_pair("uniform_chunks", (double)uniform));
+	result.metrics.push_back(std::make_pair("voxel_bytes_per_chunk", voxelBytes / n));
+	result.metrics.push_back(std::make_pair("workers", (double)workers));
+	result.metrics.push_back(std::make_pair("one_worker_ns_per_chunk", (double)bestSingle / n));
+	result.metrics.push_back(std::make_pair("speedup", (double)bestSingle / std::max<uint64_t>(1, best)));
+	return result;
+}
+
+static BenchResult benchMeshing(VoxelWorld& world, const BenchConfig& config, int lodLevel) {
+	BenchResult result;
+	result.name = "mesh_lod" + std::to_string(lodLevel);
+	result.unit = "chunk";
+
+	GreedyMesher mesher;
+	glm::ivec3 size(world.getChunkSize());
+	uint64_t best = ~0ull;
+	double triangles = 0.0, bytes = 0.0, cuboids = 0.0;
+	std::vector<uint8_t> voxels;
+
+	// Todos los chunks, tambin los uniformes que el mundo ya no malla
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t total = 0;
+		triangles = bytes = 0.0;
+		for (const auto& entry : world.getChunks()) {
+			entry.second->copyVoxels(voxels);
+
+			uint64_t start = Profiler::nowNs();
+			Mesh mesh = mesher.generateLODMesh(voxels.data(), size, lodLevel);
+			total += Profiler::nowNs() - start;
+
+			triangles += mesh.indexCount() / 3;
+			bytes += meshBytes(mesh);
+		}
+		best = std::min(best, total);
+	}
+
+	// LOD 0 va por caras con AO; la ruta de cuboides queda como referencia
+	double cuboidTriangles = 0.0;
+	if (lodLevel == 0) {
+		for (const auto& entry : world.getChunks()) {
+			entry.second->copyVoxels(voxels);
+			cuboids += mesher.greedy3DBinary(voxels.data(), size).size();
+			cuboidTriangles += mesher.greedy3DBinaryToVertices(voxels.data(), size).indexCount() / 3;
+		}
+	}
+
+	result.items = (int)world.getChunks().size();
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)best / n;
+	result.metrics.push_back(std::make_pair("triangles_per_chunk", triangles / n));
+	result.metrics.push_back(std::make_pair("bytes_per_chunk", bytes / n));
+	if (lodLevel == 0) {
+		result.metrics.push_back(std::make_pair("cuboids_per_chunk", cuboids / n));
+		result.metrics.push_back(std::make_pair("cuboid_triangles_per_chunk", cuboidTriangles / n));
+	}
+	return result;
+}
+
+// Aristas dirigidas sin su pareja inversa: 0 en una superficie cerrada y orientada
+static int openEdges(const Mesh& mesh) {
+	std::vector<uint64_t> forward, backward;
+	for (size_t i = 0; i + 2 < mesh.indexCount(); i += 3) {
+		for (int e = 0; e < 3; e++) {
+			uint64_t a = mesh.index(i + e), b = mesh.index(i + (e + 1) % 3);
+			forward.push_back((a << 32) | b);
+			backward.push_back((b << 32) | a);
+		}
+	}
+	std::sort(forward.begin(), forward.end());
+	std::sort(backward.begin(), backward.end());
+	std::vector<uint64_t> unmatched;
+	std::set_symmetric_difference(forward.begin(), forward.end(), backward.begin(), backward.end(),
+		std::back_inserter(unmatched));
+	return (int)unmatched.size();
+}
+
+// Surface nets frente al greedy del mismo LOD sobre los chunks del mundo
+static BenchResult benchSmooth(VoxelWorld& world, const BenchConfig& config, int lodLevel, int& failures) {
+	BenchResult result;
+	result.name = "mesh_smooth_lod" + std::to_string(lodLevel);
+	result.unit = "chunk";
+
+	SurfaceNets nets;
+	GreedyMesher mesher;
+	glm::ivec3 size(world.getChunkSize());
+	uint64_t best = ~0ull;
+	double triangles = 0.0, greedyTriangles = 0.0;
+	int open = 0;
+	std::vector<uint8_t> voxels;
+
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t total = 0;
+		triangles = 0.0;
+		for (const auto& entry : world.getChunks()) {
+			entry.second->copyVoxels(voxels);
+			uint64_t start = Profiler::nowNs();
+			Mesh mesh = nets.generate(voxels.data(), size, nullptr, lodLevel);
+			total += Profiler::nowNs() - start;
+			triangles += mesh.indexCount() / 3;
+			if (rep == 0) open += openEdges(mesh);
+		}
+		best = std::min(best, total);
+	}
+	for (const auto& entry : world.getChunks()) {
+		entry.second->copyVoxels(voxels);
+		greedyTriangles += mesher.generateLODMesh(voxels.data(), size, lodLevel).indexCount() / 3;
+	}
+
+	// Con el borde de aire cada chunk es una superficie cerrada
+	if (open > 0) {
+		failures++;
+		std::cerr << "surface nets LOD " << lodLevel << " left " << open << " open edge(s)" << std::endl;
+	}
+
+	result.items = (int)world.getChunks().size();
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)best / n;
+	result.metrics.push_back(std::make_pair("triangles_per_chunk", triangles / n));
+	result.metrics.push_back(std::make_pair("greedy_triangles_per_chunk", greedyTriangles / n));
+	result.metrics.push_back(std::make_pair("triangle_ratio", triangles / std::max(1.0, greedyTriangles)));
+	result.metrics.push_back(std::make_pair("open_edges", (double)open));
+	return result;
+}
+
+// Referencia: un nivel de LOD voxel a voxel sobre el chunk original (como lo
+// haca GreedyMesher::downsample); slidos de cada bloque de factor^3
+static void countSolidBlocks(const uint8_t* voxels, const glm::ivec3& size, int factor, std::vector<uint16_t>& counts) {
+	glm::ivec3 grid = size / factor;
+	counts.assign(grid.x * grid.y * grid.z, 0);
+	for (int z = 0; z < grid.z; z++)
+		for (int y = 0; y < grid.y; y++)
+			for (int x = 0; x < grid.x; x++) {
+				int solid = 0;
+				for (int dz = 0; dz < factor; dz++)
+					for (int dy = 0; dy < factor; dy++)
+						for (int dx = 0; dx < factor; dx++) {
+							int idx = ((z * factor + dz) * size.y + y * factor + dy) * size.x + x * factor + dx;
+							if (voxels[idx] > 0) solid++;
+						}
+				counts[(z * grid.y + y) * grid.x + x] = (uint16_t)solid;
+			}
+}
+
+// Pirmide de LOD 1-3 de una pasada frente a un recorrido por nivel, y el kernel
+// 2x2x2 vectorial frente al escalar
+static BenchResult benchDownsample(VoxelWorld& world, const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "lod_downsample";
+	result.unit = "chunk";
+
+	const int kLevels = 3;
+	glm::ivec3 size(world.getChunkSize());
+	std::vector<std::vector<uint8_t>> chunks;
+	for (const auto& entry : world.getChunks()) {
+		if (entry.second->content != ChunkContent::Mixed) continue;
+		chunks.push_back(std::vector<uint8_t>());
+		entry.second->copyVoxels(chunks.back());
+	}
+
+	LodDownsampler downsampler;
+	glm::ivec3 grid = size / 2;
+	size_t blocks = (size_t)grid.x * grid.y * grid.z;
+	std::vector<uint16_t> counts(blocks), scalarCounts(blocks), reference;
+	std::vector<uint8_t> materials(blocks), scalarMaterials(blocks);
+	uint64_t bestPyramid = ~0ull, bestLevels = ~0ull, bestVector = ~0ull, bestScalar = ~0ull;
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t start = Profiler::nowNs();
+		for (const std::vector<uint8_t>& voxels : chunks) downsampler.build(voxels.data(), size, kLevels);
+		bestPyramid = std::min(bestPyramid, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const std::vector<uint8_t>& voxels : chunks) {
+			for (int level = 1; level <= kLevels; level++) countSolidBlocks(voxels.data(), size, 1 << level, reference);
+		}
+		bestLevels = std::min(bestLevels, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const std::vector<uint8_t>& voxels : chunks)
+			LodDownsampler::reduceVoxels(voxels.data(), size, counts.data(), materials.data());
+		bestVector = std::min(bestVector, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const std::vector<uint8_t>& voxels : chunks)
+			LodDownsampler::reduceVoxelsScalar(voxels.data(), size, scalarCounts.data(), scalarMaterials.data());
+		bestScalar = std::min(bestScalar, Profiler::nowNs() - start);
+	}
+
+	// Las cuentas encadenadas deben ser exactas en cada nivel, el kernel vectorial
+	// igual al escalar y el material el ms repetido del bloque
+	int mismatches = 0;
+	for (const std::vector<uint8_t>& voxels : chunks) {
+		downsampler.build(voxels.data(), size, kLevels);
+		for (int level = 1; level <= kLevels; level++) {
+			countSolidBlocks(voxels.data(), size, 1 << level, reference);
+			if (downsampler.getLevels() < level ||
+				!std::equal(reference.begin(), reference.end(), downsampler.getCounts(level))) mismatches++;
+		}
+
+		LodDownsampler::reduceVoxels(voxels.data(), size, counts.data(), materials.data());
+		LodDownsampler::reduceVoxelsScalar(voxels.data(), size, scalarCounts.data(), scalarMaterials.data());
+		if (counts != scalarCounts || materials != scalarMaterials) mismatches++;
+
+		for (int z = 0; z < grid.z; z++)
+			for (int y = 0; y < grid.y; y++)
+				for (int x = 0; x < grid.x; x++) {
+					int votes[256] = { 0 };
+					for (int d = 0; d < 8; d++) votes[voxels[((2 * z + (d >> 2)) * size.y + 2 * y + ((d >> 1) & 1)) * size.x + 2 * x + (d & 1)]]++;
+					uint8_t material = materials[(z * grid.y + y) * grid.x + x];
+					int most = 0;
+					for (int m = 1; m < 256; m++) most = std::max(most, votes[m]);
+					if (material == 0 ? most != 0 : votes[material] != most) mismatches++;
+				}
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "LOD downsampling differs from the reference in " << mismatches << " check(s)" << std::endl;
+	}
+
+	int n = std::max(1, (int)chunks.size());
+	result.items = (int)chunks.size();
+	result.nsPerItem = (double)bestPyramid / n;
+	result.metrics.push_back(std::make_pair("per_level_ns_per_chunk", (double)bestLevels / n));
+	result.metrics.push_back(std::make_pair("speedup", (double)bestLevels / std::max<uint64_t>(1, bestPyramid)));
+	result.metrics.push_back(std::make_pair("kernel_ns_per_chunk", (double)bestVector / n));
+	result.metrics.push_back(std::make_pair("kernel_scalar_ns_per_chunk", (double)bestScalar / n));
+	result.metrics.push_back(std::make_pair("kernel_speedup", (double)bestScalar / std::max<uint64_t>(1, bestVector)));
+	result.metrics.push_back(std::make_pair("vector_width", (double)LodDownsampler::vectorWidth()));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Tringulos de un rango por posiciones, rotados para empezar por el menor (mismo
+// sentido de giro): iguales antes y despus de reordenar ndices y vrtices
+static std::vector<std::array<float, 9>> canonicalTriangles(const Mesh& mesh, size_t begin, size_t end) {
+	std::vector<std::array<float, 9>> triangles;
+	for (size_t i = begin; i + 2 < end; i += 3) {
+		std::array<std::array<float, 3>, 3> corners;
+		for (int k = 0; k < 3; k++) {
+			const glm::vec3& p = mesh.vertices[mesh.index(i + k)].position;
+			corners[k] = { { p.x, p.y, p.z } };
+		}
+		int first = (int)(std::min_element(corners.begin(), corners.end()) - corners.begin());
+		std::array<float, 9> triangle;
+		for (int k = 0; k < 3; k++) {
+			std::copy(corners[(first + k) % 3].begin(), corners[(first + k) % 3].end(), triangle.begin() + k * 3);
+		}
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+// MeshOptimizer sobre las mallas LOD 0 del mundo (secciones greedy o surface nets):
+// ACMR antes y despus, y bytes de ndices con 32 y con 16 bits. Las de quads
+// salen tal cual: el optimizador no las toca
+static BenchResult benchOptimize(VoxelWorld& world, const BenchConfig& config, MeshingMode mode, int& failures) {
+	BenchResult result;
+	result.name = mode == MeshingMode::Smooth ? "mesh_optimize_smooth" : "mesh_optimize_blocky";
+	result.unit = "chunk";
+
+	GreedyMesher mesher;
+	SurfaceNets nets;
+	MeshOptimizer optimizer;
+	glm::ivec3 size(world.getChunkSize());
+	std::vector<uint8_t> voxels;
+	std::vector<Mesh> meshes;
+	for (const auto& entry : world.getChunks()) {
+		entry.second->copyVoxels(voxels);
+		if (mode == MeshingMode::Smooth) {
+			meshes.push_back(nets.generate(voxels.data(), size, nullptr));
+			continue;
+		}
+		std::vector<Mesh> sections;
+		mesher.greedyFaceMeshSections(voxels.data(), size, nullptr, Chunk::kSectionSize, Chunk::kAllSections, sections);
+		for (Mesh& section : sections) meshes.push_back(std::move(section));
+	}
+
+	auto weightedAcmr = [](const std::vector<Mesh>& list) {
+		double misses = 0.0, triangles = 0.0;
+		std::vector<uint32_t> indices;
+		for (const Mesh& mesh : list) {
+			size_t count = mesh.indexCount() / 3;
+			indices.resize(mesh.indexCount());
+			for (size_t i = 0; i < indices.size(); i++) indices[i] = mesh.index(i);
+			misses += MeshOptimizer::acmr(indices.data(), indices.size(), mesh.vertices.size()) * count;
+			triangles += count;
+		}
+		return misses / std::max(1.0, triangles);
+	};
+	double before = weightedAcmr(meshes);
+
+	uint64_t best = ~0ull;
+	std::vector<Mesh> optimized;
+	for (int rep = 0; rep < config.reps; rep++) {
+		optimized = meshes;
+		uint64_t start = Profiler::nowNs();
+		for (Mesh& mesh : optimized) optimizer.optimize(mesh);
+		best = std::min(best, Profiler::nowNs() - start);
+	}
+	double after = weightedAcmr(optimized);
+
+	// Mismos tringulos en cada rango, y 16 bits cuando la malla tiene <= 65535
+	// vrtices (las de quads no suben ndices: usan el EBO compartido)
+	int mismatches = 0;
+	double indices = 0.0, shortBytes = 0.0, shortMeshes = 0.0;
+	for (size_t i = 0; i < meshes.size(); i++) {
+		const Mesh& a = meshes[i];
+		const Mesh& b = optimized[i];
+		size_t opaqueA = a.indexCount() - a.translucentIndexCount;
+		size_t opaqueB = b.indexCount() - b.translucentIndexCount;
+		if (a.translucentIndexCount != b.translucentIndexCount ||
+			canonicalTriangles(a, 0, opaqueA) != canonicalTriangles(b, 0, opaqueB) ||
+			canonicalTriangles(a, opaqueA, a.indexCount()) != canonicalTriangles(b, opaqueB, b.indexCount())) {
+			mismatches++;
+		}
+		bool fits = b.vertices.size() <= 65535;
+		indices += b.indexCount();
+		shortBytes += b.quads ? 0.0 : b.indexCount() * (fits ? 2.0 : 4.0);
+		shortMeshes += fits ? 1.0 : 0.0;
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << result.name << ": " << mismatches << " mesh(es) changed their triangles" << std::endl;
+	}
+
+	result.items = (int)world.getChunks().size();
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)best / n;
+	result.metrics.push_back(std::make_pair("acmr_before", before));
+	result.metrics.push_back(std::make_pair("acmr_after", after));
+	result.metrics.push_back(std::make_pair("index_bytes_32_per_chunk", indices * 4.0 / n));
+	result.metrics.push_back(std::make_pair("index_bytes_per_chunk", shortBytes / n));
+	result.metrics.push_back(std::make_pair("short_index_share", shortMeshes / std::max<size_t>(1, meshes.size())));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Mallado de los chunks del mundo como en los jobs (LOD 0 por secciones, LOD 1..3
+// y surface nets), con mallas nuevas por job o recicladas por MeshArena
+static BenchResult benchArena(VoxelWorld& world, const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "mesh_arena";
+	result.unit = "job";
+
+	GreedyMesher mesher;
+	SurfaceNets nets;
+	MeshArena arena;
+	const int size = world.getChunkSize();
+	std::vector<uint8_t> voxels;
+	std::vector<Mesh> fresh, recycled;
+	uint64_t bestFresh = ~0ull, bestArena = ~0ull;
+	uint64_t freshAllocations = 0, arenaAllocations = 0;
+	int jobs = 0, mismatches = 0;
+
+	// Un job: LOD 0 a 3 y surface nets del mismo chunk
+	auto meshJob = [&](bool useArena, int lod, std::vector<Mesh>& sections) {
+		if (lod == 4) {
+			if (useArena) arena.acquire(sections, 1);
+			else sections.assign(1, Mesh());
+			nets.generate(voxels.data(), glm::ivec3(size), nullptr, 0, sections[0]);
+		}
+		else if (lod == 0) {
+			if (useArena) arena.acquire(sections, 8);
+			else sections.clear();
+			mesher.greedyFaceMeshSections(voxels.data(), glm::ivec3(size), nullptr, Chunk::kSectionSize, Chunk::kAllSections, sections);
+		}
+		else if (useArena) {
+			arena.acquire(sections, 1);
+			mesher.generateLODMesh(voxels.data(), glm::ivec3(size), lod, sections[0]);
+		}
+		else {
+			sections.assign(1, mesher.generateLODMesh(voxels.data(), glm::ivec3(size), lod));
+		}
+	};
+
+	for (int rep = 0; rep < config.reps + 1; rep++) {
+		uint64_t freshTime = 0, arenaTime = 0;
+		uint64_t freshCount = 0, arenaCount = 0;
+		jobs = 0;
+		for (const auto& entry : world.getChunks()) {
+			entry.second->copyVoxels(voxels);
+			for (int lod = 0; lod <= 4; lod++) {
+				uint64_t before = allocationCount.load();
+				uint64_t start = Profiler::nowNs();
+				std::vector<Mesh> sections;
+				meshJob(false, lod, sections);
+				fresh.swap(sections);
+				uint64_t middle = Profiler::nowNs();
+				uint64_t freshDone = allocationCount.load();
+				sections.clear();
+
+				uint64_t arenaStart = Profiler::nowNs();
+				meshJob(true, lod, recycled);
+				uint64_t end = Profiler::nowNs();
+				freshCount += freshDone - before;
+				arenaCount += allocationCount.load() - freshDone;
+				freshTime += middle - start;
+				arenaTime += end - arenaStart;
+				jobs++;
+
+				if (rep == 0) {
+					bool same = fresh.size() == recycled.size();
+					for (size_t i = 0; same && i < fresh.size(); i++) {
+						same = fresh[i].vertices.size() == recycled[i].vertices.size() &&
+							fresh[i].indices == recycled[i].indices &&
+							std::memcmp(fresh[i].vertices.data(), recycled[i].vertices.data(), fresh[i].vertices.size() * sizeof(Vertex)) == 0;
+					}
+					if (!same) mismatches++;
+				}
+				// La subida ha terminado: las mallas vuelven a la arena
+				arena.release(recycled);
+			}
+		}
+		// La primera vuelta llena la arena y los buffers del mallador
+		if (rep == 0) continue;
+		bestFresh = std::min(bestFresh, freshTime);
+		bestArena = std::min(bestArena, arenaTime);
+		freshAllocations = freshCount;
+		arenaAllocations = arenaCount;
+	}
+
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "mesh arena: " << mismatches << " job(s) differ from freshly allocated meshes" << std::endl;
+	}
+
+	result.items = jobs;
+	int n = std::max(1, jobs);
+	result.nsPerItem = (double)bestArena / n;
+	result.metrics.push_back(std::make_pair("fresh_ns", (double)bestFresh / n));
+	result.metrics.push_back(std::make_pair("speedup", (double)bestFresh / std::max<uint64_t>(1, bestArena)));
+	result.metrics.push_back(std::make_pair("fresh_allocations_per_job", (double)freshAllocations / n));
+	result.metrics.push_back(std::make_pair("arena_allocations_per_job", (double)arenaAllocations / n));
+	result.metrics.push_back(std::make_pair("retained_kb", arena.getRetainedBytes() / 1024.0));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+static BenchResult benchCulling(VoxelWorld& world, const std::vector<CameraSample>& path, const BenchConfig& config) {
+	BenchResult result;
+	result.name = "lod_and_cull";
+	result.unit = "frame";
+	result.items = (int)path.size();
+
+	uint64_t best = ~0ull;
+	double visible = 0.0;
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t total = 0;
+		visible = 0.0;
+		for (const CameraSample& s : path) {
+			glm::mat4 viewProj = viewProjFor(s);
+			uint64_t start = Profiler::nowNs();
+			world.updateLOD(s.position);
+			visible += world.cullChunks(s.position, viewProj);
+			total += Profiler::nowNs() - start;
+		}
+		best = std::min(best, total);
+	}
+
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)best / n;
+	result.metrics.push_back(std::make_pair("visible_chunks", visible / n));
+	return result;
+}
+
+// xorshift32 -> [0, 1) para los rayos del benchmark
+static float randomUnit(uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (state & 0xFFFFFF) / 16777216.0f;
+}
+
+// Referencia: DDA voxel a voxel con getWorldVoxel en cada paso, sin saltos
+static RaycastHit naiveRaycast(VoxelWorld& world, const Ray& ray) {
+	RaycastHit result;
+	glm::vec3 dir = glm::normalize(ray.direction);
+	glm::vec3 origin = ray.origin + glm::vec3(0.5f);
+	glm::ivec3 voxel = glm::ivec3(glm::floor(origin));
+	glm::ivec3 step(0), normal(0);
+	glm::vec3 tNext(std::numeric_limits<float>::infinity());
+	for (int a = 0; a < 3; a++) {
+		if (dir[a] == 0.0f) continue;
+		step[a] = dir[a] > 0.0f ? 1 : -1;
+		tNext[a] = ((float)(voxel[a] + (step[a] > 0 ? 1 : 0)) - origin[a]) / dir[a];
+	}
+
+	float t = 0.0f;
+	while (t <= ray.maxDistance) {
+		uint8_t value = world.getWorldVoxel(voxel.x, voxel.y, voxel.z);
+		if (value != 0) {
+			result.hit = true;
+			result.voxel = voxel;
+			result.normal = normal;
+			result.distance = t;
+			result.value = value;
+			return result;
+		}
+		int axis = 0;
+		if (tNext.y < tNext[axis]) axis = 1;
+		if (tNext.z < tNext[axis]) axis = 2;
+		t = tNext[axis];
+		voxel[axis] += step[axis];
+		tNext[axis] = ((float)(voxel[axis] + (step[axis] > 0 ? 1 : 0)) - origin[axis]) / dir[axis];
+		normal = glm::ivec3(0);
+		normal[axis] = -step[axis];
+	}
+	return result;
+}
+
+// Rayos de picking y de visibilidad: origen sobre el terreno, direcciones al azar
+static BenchResult benchRaycast(VoxelWorld& world, const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "raycast";
+	result.unit = "ray";
+
+	const int kRays = 8192;
+	glm::vec3 extent = glm::vec3(config.worldSize * world.getChunkSize());
+	uint32_t rng = config.seed ? config.seed : 1u;
+
+	std::vector<Ray> rays(kRays);
+	for (Ray& ray : rays) {
+		ray.origin = glm::vec3(randomUnit(rng), 0.6f + 0.4f * randomUnit(rng), randomUnit(rng)) * (extent - 1.0f);
+		ray.direction = glm::vec3(randomUnit(rng) * 2.0f - 1.0f, -randomUnit(rng), randomUnit(rng) * 2.0f - 1.0f);
+		if (glm::length(ray.direction) < 1e-3f) ray.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+		ray.maxDistance = 256.0f;
+	}
+
+	uint64_t bestSingle = ~0ull, bestBatch = ~0ull, bestNaive = ~0ull;
+	std::vector<RaycastHit> hits, reference(kRays);
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t start = Profiler::nowNs();
+		for (int i = 0; i < kRays; i++)
+			reference[i] = naiveRaycast(world, rays[i]);
+		bestNaive = std::min(bestNaive, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		hits.resize(kRays);
+		for (int i = 0; i < kRays; i++)
+			hits[i] = world.raycast(rays[i].origin, rays[i].direction, rays[i].maxDistance);
+		bestSingle = std::min(bestSingle, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		world.raycastBatch(rays, hits);
+		bestBatch = std::min(bestBatch, Profiler::nowNs() - start);
+	}
+
+	// El salto de espacio vaco no debe cambiar el voxel ni la cara de impacto
+	int hitCount = 0, mismatches = 0;
+	for (int i = 0; i < kRays; i++) {
+		if (hits[i].hit) hitCount++;
+		if (hits[i].hit != reference[i].hit ||
+			(hits[i].hit && (hits[i].voxel != reference[i].voxel || hits[i].normal != reference[i].normal)))
+			mismatches++;
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "raycast differs from the reference DDA on " << mismatches << " ray(s)" << std::endl;
+	}
+
+	result.items = kRays;
+	result.nsPerItem = (double)bestSingle / kRays;
+	result.metrics.push_back(std::make_pair("batch_ns_per_ray", (double)bestBatch / kRays));
+	result.metrics.push_back(std::make_pair("naive_ns_per_ray", (double)bestNaive / kRays));
+	result.metrics.push_back(std::make_pair("speedup", (double)bestNaive / std::max<uint64_t>(1, bestSingle)));
+	result.metrics.push_back(std::make_pair("hit_ratio", (double)hitCount / kRays));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Voxels slidos que solapan estrictamente la caja (referencia sin broadphase)
+static int solidVoxelsIn(VoxelWorld& world, const AABB& box) {
+	glm::ivec3 first = glm::ivec3(glm::floor(box.min - 0.5f)) + 1;
+	glm::ivec3 last = glm::ivec3(glm::ceil(box.max + 0.5f)) - 1;
+	int count = 0;
+	for (int z = first.z; z <= last.z; z++)
+		for (int y = first.y; y <= last.y; y++)
+			for (int x = first.x; x <= last.x; x++)
+				if (world.getWorldVoxel(x, y, z) != 0) count++;
+	return count;
+}
+
+// Miles de entidades cayendo y andando sobre el terreno, un moveBatch por tick
+static BenchResult benchCollision(VoxelWorld& world, const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "collision";
+	result.unit = "move";
+
+	const int kEntities = 4096;
+	const int kTicks = 60;
+	const float dt = 1.0f / 60.0f;
+	glm::vec3 extent = glm::vec3(config.worldSize * world.getChunkSize());
+	uint32_t rng = config.seed ? config.seed : 1u;
+
+	VoxelCollision collision(&world);
+	std::vector<MoveQuery> start(kEntities);
+	std::vector<glm::vec3> walk(kEntities);
+	for (int i = 0; i < kEntities; i++) {
+		glm::vec3 p = glm::vec3(randomUnit(rng), 0.5f + 0.4f * randomUnit(rng), randomUnit(rng)) * (extent - 2.0f);
+		start[i].box = AABB{ p, p + glm::vec3(0.6f, 1.8f, 0.6f) };
+		walk[i] = glm::vec3(randomUnit(rng) * 8.0f - 4.0f, 0.0f, randomUnit(rng) * 8.0f - 4.0f);
+	}
+
+	// Las que nacen dentro del terreno pueden salir, no se validan
+	std::vector<bool> startedInside(kEntities);
+	for (int i = 0; i < kEntities; i++) startedInside[i] = collision.overlaps(start[i].box);
+
+	uint64_t bestBatch = ~0ull, bestSingle = ~0ull;
+	std::vector<MoveQuery> queries;
+	std::vector<MoveResult> results;
+	std::vector<glm::vec3> velocity(kEntities);
+	int grounded = 0, penetrations = 0;
+
+	for (int rep = 0; rep < config.reps; rep++) {
+		queries = start;
+		for (int i = 0; i < kEntities; i++) velocity[i] = walk[i];
+		collision.clear();
+
+		uint64_t batchTime = 0, singleTime = 0;
+		for (int tick = 0; tick < kTicks; tick++) {
+			for (int i = 0; i < kEntities; i++) {
+				velocity[i].y = std::max(velocity[i].y - 20.0f * dt, -50.0f);
+				queries[i].delta = velocity[i] * dt;
+			}
+
+			uint64_t t0 = Profiler::nowNs();
+			collision.moveBatch(queries, results);
+			batchTime += Profiler::nowNs() - t0;
+
+			// Mismo tick en serie, con la cach ya caliente
+			if (tick == kTicks - 1) {
+				t0 = Profiler::nowNs();
+				for (int i = 0; i < kEntities; i++) collision.move(queries[i].box, queries[i].delta);
+				singleTime = Profiler::nowNs() - t0;
+			}
+
+			for (int i = 0; i < kEntities; i++) {
+				queries[i].box = results[i].box;
+				if (results[i].blocked.y != 0) velocity[i].y = 0.0f;
+				if (results[i].blocked.x != 0) velocity[i].x = -velocity[i].x;
+				if (results[i].blocked.z != 0) velocity[i].z = -velocity[i].z;
+			}
+		}
+		bestBatch = std::min(bestBatch, batchTime);
+		bestSingle = std::min(bestSingle, singleTime);
+
+		grounded = penetrations = 0;
+		for (int i = 0; i < kEntities; i++) {
+			if (results[i].onGround) grounded++;
+			if (!startedInside[i] && solidVoxelsIn(world, queries[i].box) > 0) penetrations++;
+		}
+	}
+	if (penetrations > 0) {
+		failures++;
+		std::cerr << "collision left " << penetrations << " entities inside solid voxels" << std::endl;
+	}
+
+	// Cajas de la broadphase frente a voxels en la misma regin
+	double boxes = 0.0, voxels = 0.0;
+	std::vector<AABB> found;
+	const int kSamples = 256;
+	for (int i = 0; i < kSamples; i++) {
+		AABB region = queries[i].box;
+		region.min -= 1.0f;
+		region.max += 1.0f;
+		found.clear();
+		boxes += collision.queryBoxes(region, found);
+		voxels += solidVoxelsIn(world, region);
+	}
+
+	result.items = kEntities * kTicks;
+	result.nsPerItem = (double)bestBatch / result.items;
+	result.metrics.push_back(std::make_pair("single_ns_per_move", (double)bestSingle / kEntities));
+	result.metrics.push_back(std::make_pair("boxes_per_query", boxes / kSamples));
+	result.metrics.push_back(std::make_pair("voxels_per_query", voxels / kSamples));
+	result.metrics.push_back(std::make_pair("on_ground_ratio", (double)grounded / kEntities));
+	result.metrics.push_back(std::make_pair("cached_chunks", (double)collision.getCachedChunks()));
+	result.metrics.push_back(std::make_pair("penetrations", (double)penetrations));
+	return result;
+}
+
+// Ocupacin en bits frente a bytes: solapes de cajas (tambin frente a los
+// cuboides de colisin), recuentos de slidos y operaciones entre chunks
+static BenchResult benchOccupancy(VoxelWorld& world, const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "occupancy";
+	result.unit = "query";
+	uint32_t rng = config.seed ? config.seed : 1u;
+
+	// Tras ediciones sueltas y por regiones los bits deben seguir a voxelData
+	glm::ivec3 editSize = glm::min(config.worldSize, glm::ivec3(2));
+	VoxelWorld edited(editSize.x, editSize.y, editSize.z);
+	edited.setSeed(config.seed);
+	edited.generateTerrain();
+	glm::vec3 editExtent = glm::vec3(editSize * edited.getChunkSize());
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 center = glm::vec3(randomUnit(rng), randomUnit(rng), randomUnit(rng)) * editExtent;
+		edited.fillSphere(center, 4.0f + 8.0f * randomUnit(rng), (uint8_t)(i % 2 == 0 ? 0 : 3));
+	}
+	for (int i = 0; i < 4096; i++) {
+		glm::ivec3 v = glm::ivec3(glm::vec3(randomUnit(rng), randomUnit(rng), randomUnit(rng)) * (editExtent - 1.0f));
+		edited.setWorldVoxel(v.x, v.y, v.z, (uint8_t)(i % 3));
+	}
+	int mismatches = 0;
+	for (const auto& entry : edited.getChunks()) {
+		const Chunk* chunk = entry.second.get();
+		for (int z = 0; z < 32; z++)
+			for (int y = 0; y < 32; y++)
+				for (int x = 0; x < 32; x++)
+					if (chunk->isSolid(x, y, z) != (chunk->getVoxel(x, y, z) != 0)) mismatches++;
+	}
+
+	// Cajas de entidad por el mundo
+	const int kBoxes = 16384;
+	glm::vec3 extent = glm::vec3(config.worldSize * world.getChunkSize());
+	std::vector<AABB> boxes(kBoxes);
+	for (AABB& box : boxes) {
+		glm::vec3 p = glm::vec3(randomUnit(rng), 0.3f + 0.6f * randomUnit(rng), randomUnit(rng)) * (extent - 2.0f);
+		box = AABB{ p, p + glm::vec3(0.6f, 1.8f, 0.6f) };
+	}
+	VoxelCollision collision(&world);
+	std::vector<AABB> found;
+	for (const AABB& box : boxes) collision.queryBoxes(box, found);
+
+	std::vector<char> bits(kBoxes), cuboids(kBoxes), voxels(kBoxes);
+	uint64_t bestBits = ~0ull, bestCuboids = ~0ull, bestVoxels = ~0ull;
+	for (int rep = 0; rep < config.reps; rep++) {
+		uint64_t start = Profiler::nowNs();
+		for (int i = 0; i < kBoxes; i++) bits[i] = collision.overlaps(boxes[i]);
+		bestBits = std::min(bestBits, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (int i = 0; i < kBoxes; i++) {
+			found.clear();
+			cuboids[i] = collision.queryBoxes(boxes[i], found) > 0;
+		}
+		bestCuboids = std::min(bestCuboids, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (int i = 0; i < kBoxes; i++) voxels[i] = solidVoxelsIn(world, boxes[i]) > 0;
+		bestVoxels = std::min(bestVoxels, Profiler::nowNs() - start);
+	}
+	int overlapping = 0;
+	for (int i = 0; i < kBoxes; i++) {
+		if (voxels[i]) overlapping++;
+		if (bits[i] != voxels[i] || cuboids[i] != voxels[i]) mismatches++;
+	}
+
+	// Recuento de slidos y "slido aqu y aire en el chunk de encima"
+	std::vector<const Chunk*> mixed;
+	for (const auto& entry : world.getChunks()) {
+		if (entry.second->content == ChunkContent::Mixed) mixed.push_back(entry.second.get());
+	}
+	std::sort(mixed.begin(), mixed.end(), [](const Chunk* a, const Chunk* b) { return a->id < b->id; });
+	std::vector<std::pair<const Chunk*, const Chunk*>> pairs;
+	for (const Chunk* chunk : mixed) {
+		const Chunk* above = world.findGeneratedChunk(chunk->position.x, chunk->position.y + 1, chunk->position.z);
+		if (above) pairs.push_back(std::make_pair(chunk, above));
+	}
+
+	std::vector<uint32_t> combined(32 * 32);
+	uint64_t bestCount = ~0ull, bestCountBytes = ~0ull, bestCombine = ~0ull, bestCombineBytes = ~0ull;
+	int64_t solidBits = 0, solidBytes = 0, exposedBits = 0, exposedBytes = 0;
+	for (int rep = 0; rep < config.reps; rep++) {
+		solidBits = solidBytes = exposedBits = exposedBytes = 0;
+		uint64_t start = Profiler::nowNs();
+		for (const Chunk* chunk : mixed) solidBits += chunk->solidCount();
+		bestCount = std::min(bestCount, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const Chunk* chunk : mixed)
+			for (uint8_t v : chunk->voxelData) solidBytes += v != 0;
+		bestCountBytes = std::min(bestCountBytes, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const auto& pair : pairs)
+			exposedBits += Chunk::combineOccupancy(*pair.first, *pair.second, Chunk::OccupancyOp::AndNot, combined.data());
+		bestCombine = std::min(bestCombine, Profiler::nowNs() - start);
+
+		start = Profiler::nowNs();
+		for (const auto& pair : pairs) {
+			for (int i = 0; i < 32 * 32 * 32; i++)
+				exposedBytes += pair.first->voxelData[pair.first->voxelIndex(i)] != 0 && pair.second->getVoxel(i & 31, (i >> 5) & 31, i >> 10) == 0;
+		}
+		bestCombineBytes = std::min(bestCombineBytes, Profiler::nowNs() - start);
+	}
+	if (solidBits != solidBytes) mismatches++;
+	if (exposedBits != exposedBytes) mismatches++;
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "occupancy bits differ from the voxel bytes in " << mismatches << " check(s)" << std::endl;
+	}
+
+	int chunkCount = std::max<int>(1, (int)mixed.size());
+	int pairCount = std::max<int>(1, (int)pairs.size());
+	result.items = kBoxes;
+	result.nsPerItem = (double)bestBits / kBoxes;
+	result.metrics.push_back(std::make_pair("cuboid_ns_per_query", (double)bestCuboids / kBoxes));
+	result.metrics.push_back(std::make_pair("voxel_ns_per_query", (double)bestVoxels / kBoxes));
+	result.metrics.push_back(std::make_pair("speedup_vs_cuboids", (double)bestCuboids / std::max<uint64_t>(1, bestBits)));
+	result.metrics.push_back(std::make_pair("overlap_ratio", (double)overlapping / kBoxes));
+	result.metrics.push_back(std::make_pair("count_ns_per_chunk", (double)bestCount / chunkCount));
+	result.metrics.push_back(std::make_pair("count_bytes_ns_per_chunk", (double)bestCountBytes / chunkCount));
+	result.metrics.push_back(std::make_pair("combine_ns_per_pair", (double)bestCombine / pairCount));
+	result.metrics.push_back(std::make_pair("combine_bytes_ns_per_pair", (double)bestCombineBytes / pairCount));
+	result.metrics.push_back(std::make_pair("bytes_per_chunk", (double)(32 * 32 * sizeof(uint32_t))));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Caras expuestas mirando los 6 vecinos con getVoxel, como el culling y la AO
+static int exposedFaces(const Chunk* chunk) {
+	static const int offsets[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	int faces = 0;
+	for (int z = 1; z < 31; z++)
+		for (int y = 1; y < 31; y++)
+			for (int x = 1; x < 31; x++) {
+				if (chunk->getVoxel(x, y, z) == 0) continue;
+				for (const int* o : offsets)
+					faces += chunk->getVoxel(x + o[0], y + o[1], z + o[2]) == 0;
+			}
+	return faces;
+}
+
+// LOD 1 leyendo voxelData: primer voxel no vaco de cada bloque 2x2x2
+static void downsampleChunk(const Chunk* chunk, uint8_t* out) {
+	const uint8_t* data = chunk->voxelData.data();
+	uint8_t block[8];
+	for (int z = 0; z < 32; z += 2)
+		for (int y = 0; y < 32; y += 2)
+			for (int x = 0; x < 32; x += 2) {
+				if (chunk->layout == ChunkLayout::Morton) {
+					std::memcpy(block, data + MortonLayout::index(x, y, z), 8);
+				} else {
+					const uint8_t* p = data + (z * 32 + y) * 32 + x;
+					const int offsets[8] = { 0, 1, 32, 33, 1024, 1025, 1056, 1057 };
+					for (int k = 0; k < 8; k++) block[k] = p[offsets[k]];
+				}
+				uint8_t value = 0;
+				for (int k = 0; k < 8 && value == 0; k++) value = block[k];
+				out[((z / 2) * 16 + y / 2) * 16 + x / 2] = value;
+			}
+}
+
+// Columnas de luz de cielo: primer slido bajando por y en cada (x, z)
+static int columnDepths(const Chunk* chunk) {
+	int sum = 0;
+	for (int z = 0; z < 32; z++)
+		for (int x = 0; x < 32; x++) {
+			int y = 31;
+			while (y >= 0 && chunk->voxelData[chunk->voxelIndex(x, y, z)] == 0) y--;
+			sum += y;
+		}
+	return sum;
+}
+
+// Orden lineal frente a Morton dentro de los chunks: mismo mundo, mismas
+// ediciones y las mismas lecturas en los dos
+static BenchResult benchChunkLayout(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "chunk_layout";
+	result.unit = "chunk";
+
+	auto timeBest = [&](auto&& body) {
+		uint64_t best = ~0ull;
+		for (int rep = 0; rep < config.reps; rep++) {
+			uint64_t start = Profiler::nowNs();
+			body();
+			best = std::min(best, Profiler::nowNs() - start);
+		}
+		return best;
+	};
+
+	glm::ivec3 size = glm::min(config.worldSize, glm::ivec3(4));
+	const ChunkLayout layouts[2] = { ChunkLayout::Linear, ChunkLayout::Morton };
+	std::unique_ptr<VoxelWorld> worlds[2];
+	uint64_t generate[2];
+	for (int l = 0; l < 2; l++) {
+		generate[l] = timeBest([&] {
+			worlds[l].reset(new VoxelWorld(size.x, size.y, size.z));
+			worlds[l]->setSeed(config.seed);
+			worlds[l]->setChunkLayout(layouts[l]);
+			worlds[l]->generateTerrain();
+		});
+	}
+
+	uint32_t rng = config.seed ? config.seed : 1u;
+	glm::vec3 extent = glm::vec3(size * worlds[0]->getChunkSize());
+	for (int i = 0; i < 6; i++) {
+		glm::vec3 center = glm::vec3(randomUnit(rng), randomUnit(rng), randomUnit(rng)) * extent;
+		float radius = 4.0f + 8.0f * randomUnit(rng);
+		for (auto& world : worlds) world->fillSphere(center, radius, (uint8_t)(i % 2 == 0 ? 0 : 3));
+	}
+	for (int i = 0; i < 2048; i++) {
+		glm::ivec3 v = glm::ivec3(glm::vec3(randomUnit(rng), randomUnit(rng), randomUnit(rng)) * (extent - 1.0f));
+		for (auto& world : worlds) world->setWorldVoxel(v.x, v.y, v.z, (uint8_t)(i % 3));
+	}
+
+	// Chunks Mixed, emparejados por id
+	std::vector<const Chunk*> mixed[2];
+	for (int l = 0; l < 2; l++) {
+		for (const auto& entry : worlds[l]->getChunks()) {
+			if (entry.second->content == ChunkContent::Mixed) mixed[l].push_back(entry.second.get());
+		}
+		std::sort(mixed[l].begin(), mixed[l].end(), [](const Chunk* a, const Chunk* b) { return a->id < b->id; });
+	}
+
+	int mismatches = 0;
+	std::vector<uint8_t> a, b;
+	std::vector<uint32_t> diff(32 * 32);
+	if (mixed[0].size() != mixed[1].size()) mismatches++;
+	size_t chunkCount = std::min(mixed[0].size(), mixed[1].size());
+	for (size_t i = 0; i < chunkCount; i++) {
+		mixed[0][i]->copyVoxels(a);
+		mixed[1][i]->copyVoxels(b);
+		if (mixed[0][i]->id != mixed[1][i]->id || a != b) mismatches++;
+		if (Chunk::combineOccupancy(*mixed[0][i], *mixed[1][i], Chunk::OccupancyOp::Xor, diff.data()) != 0) mismatches++;
+		if (mixed[1][i]->layout != ChunkLayout::Morton) mismatches++;
+	}
+
+	// Conversin en bloque, ida y vuelta
+	std::vector<uint8_t> morton(32 * 32 * 32), linear(32 * 32 * 32);
+	uint64_t toMorton = timeBest([&] {
+		for (const Chunk* chunk : mixed[0]) MortonLayout::fromLinear(chunk->voxelData.data(), morton.data());
+	});
+	uint64_t toLinear = timeBest([&] {
+		for (const Chunk* chunk : mixed[1]) MortonLayout::toLinear(chunk->voxelData.data(), linear.data());
+	});
+	for (size_t i = 0; i < chunkCount; i++) {
+		MortonLayout::fromLinear(mixed[0][i]->voxelData.data(), morton.data());
+		if (morton != mixed[1][i]->voxelData) mismatches++;
+	}
+
+	// Lecturas de cada subsistema con los dos rdenes; los resultados deben coincidir
+	uint64_t copy[2], neighbors[2], downsample[2], columns[2], colliders[2];
+	int64_t faces[2] = { 0, 0 }, depths[2] = { 0, 0 }, boxes[2] = { 0, 0 };
+	std::vector<uint8_t> lods[2];
+	std::vector<AABB> found;
+	for (int l = 0; l < 2; l++) {
+		const std::vector<const Chunk*>& chunks = mixed[l];
+		copy[l] = timeBest([&] {
+			for (const Chunk* chunk : chunks) chunk->copyVoxels(a);
+		});
+		neighbors[l] = timeBest([&] {
+			faces[l] = 0;
+			for (const Chunk* chunk : chunks) faces[l] += exposedFaces(chunk);
+		});
+		lods[l].resize(chunks.size() * 16 * 16 * 16);
+		downsample[l] = timeBest([&] {
+			for (size_t i = 0; i < chunks.size(); i++) downsampleChunk(chunks[i], &lods[l][i * 16 * 16 * 16]);
+		});
+		columns[l] = timeBest([&] {
+			depths[l] = 0;
+			for (const Chunk* chunk : chunks) depths[l] += columnDepths(chunk);
+		});
+		VoxelCollision collision(worlds[l].get());
+		colliders[l] = timeBest([&] {
+			collision.clear();
+			boxes[l] = 0;
+			for (const Chunk* chunk : chunks) {
+				glm::vec3 chunkMin = glm::vec3(chunk->position * 32);
+				found.clear();
+				boxes[l] += collision.queryBoxes(AABB{ chunkMin - 0.25f, chunkMin + 31.25f }, found);
+			}
+		});
+	}
+	if (faces[0] != faces[1] || depths[0] != depths[1] || boxes[0] != boxes[1] || lods[0] != lods[1]) mismatches++;
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "Morton chunk layout differs from the linear one in " << mismatches << " check(s)" << std::endl;
+	}
+
+	double n = (double)std::max<size_t>(1, chunkCount);
+	double all = (double)std::max<size_t>(1, worlds[0]->getChunks().size());
+	result.items = (int)chunkCount;
+	result.nsPerItem = (double)toMorton / n;
+	result.metrics.push_back(std::make_pair("to_linear_ns_per_chunk", (double)toLinear / n));
+	result.metrics.push_back(std::make_pair("generate_linear_ns_per_chunk", (double)generate[0] / all));
+	result.metrics.push_back(std::make_pair("generate_morton_ns_per_chunk", (double)generate[1] / all));
+	result.metrics.push_back(std::make_pair("copy_linear_ns_per_chunk", (double)copy[0] / n));
+	result.metrics.push_back(std::make_pair("copy_morton_ns_per_chunk", (double)copy[1] / n));
+	result.metrics.push_back(std::make_pair("neighbors_linear_ns_per_chunk", (double)neighbors[0] / n));
+	result.metrics.push_back(std::make_pair("neighbors_morton_ns_per_chunk", (double)neighbors[1] / n));
+	result.metrics.push_back(std::make_pair("downsample_linear_ns_per_chunk", (double)downsample[0] / n));
+	result.metrics.push_back(std::make_pair("downsample_morton_ns_per_chunk", (double)downsample[1] / n));
+	result.metrics.push_back(std::make_pair("columns_linear_ns_per_chunk", (double)columns[0] / n));
+	result.metrics.push_back(std::make_pair("columns_morton_ns_per_chunk", (double)columns[1] / n));
+	result.metrics.push_back(std::make_pair("colliders_linear_ns_per_chunk", (double)colliders[0] / n));
+	result.metrics.push_back(std::make_pair("colliders_morton_ns_per_chunk", (double)colliders[1] / n));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Explosiones: esfera voxel a voxel con setWorldVoxel frente a fillSphere
+static BenchResult benchBulkEdit(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "bulk_edit";
+	result.unit = "voxel";
+
+	glm::ivec3 size = glm::min(config.worldSize, glm::ivec3(4));
+	VoxelWorld single(size.x, size.y, size.z), bulk(size.x, size.y, size.z);
+	single.setSeed(config.seed);
+	bulk.setSeed(config.seed);
+	single.generateTerrain();
+	bulk.generateTerrain();
+	// La luz inicial de ambos mundos no cuenta en las ediciones
+	single.finishJobs();
+	bulk.finishJobs();
+
+	const int kBlasts = 16;
+	const float radius = 13.3f;
+	glm::vec3 extent = glm::vec3(size * single.getChunkSize());
+	uint32_t rng = config.seed ? config.seed : 1u;
+	std::vector<glm::vec3> centers(kBlasts);
+	for (glm::vec3& c : centers)
+		c = glm::vec3(randomUnit(rng), 0.3f + 0.4f * randomUnit(rng), randomUnit(rng)) * extent;
+
+	// Tiempo de CPU del hilo que edita; la luz se rehace en un job aparte
+	uint64_t singleTime = 0, bulkTime = 0, bulkWall = 0, relightTime = 0;
+	int changed = 0;
+	for (int i = 0; i < kBlasts; i++) {
+		const glm::vec3& center = centers[i];
+		uint8_t value = (uint8_t)(i % 2 == 0 ? 0 : 3);
+
+		uint64_t start = threadCpuNs();
+		glm::ivec3 lo = glm::ivec3(glm::ceil(center - radius));
+		glm::ivec3 hi = glm::ivec3(glm::floor(center + radius));
+		for (int z = lo.z; z <= hi.z; z++)
+			for (int y = lo.y; y <= hi.y; y++)
+				for (int x = lo.x; x <= hi.x; x++) {
+					glm::vec3 d = glm::vec3(x, y, z) - center;
+					if (glm::dot(d, d) <= radius * radius) single.setWorldVoxel(x, y, z, value);
+				}
+		singleTime += threadCpuNs() - start;
+		// La luz pendiente de un mundo no se cuela en el tiempo del otro
+		single.finishJobs();
+
+		start = threadCpuNs();
+		uint64_t wallStart = Profiler::nowNs();
+		changed += bulk.fillSphere(center, radius, value);
+		bulkTime += threadCpuNs() - start;
+		bulkWall += Profiler::nowNs() - wallStart;
+		wallStart = Profiler::nowNs();
+		bulk.finishJobs();
+		relightTime += Profiler::nowNs() - wallStart;
+	}
+
+	// Copiar y pegar un trozo en ambos mundos, y reemplazar un material
+	glm::ivec3 worldMax = size * single.getChunkSize() - 1;
+	VoxelVolume a = single.copyRegion(glm::ivec3(0), glm::ivec3(40, 60, 40));
+	VoxelVolume b = bulk.copyRegion(glm::ivec3(0), glm::ivec3(40, 60, 40));
+	for (int z = 0; z < a.size.z; z++)
+		for (int y = 0; y < a.size.y; y++)
+			for (int x = 0; x < a.size.x; x++)
+				single.setWorldVoxel(70 + x, 20 + y, 70 + z, a.get(x, y, z));
+	bulk.paste(b, glm::ivec3(70, 20, 70), false);
+
+	for (int z = 0; z <= worldMax.z; z++)
+		for (int y = 0; y <= worldMax.y; y++)
+			for (int x = 0; x <= worldMax.x; x++)
+				if (single.getWorldVoxel(x, y, z) == 1) single.setWorldVoxel(x, y, z, 2);
+	bulk.replaceMaterial(glm::ivec3(0), worldMax, 1, 2);
+
+	// Ambas rutas deben dejar el mundo igual
+	VoxelVolume finalSingle = single.copyRegion(glm::ivec3(0), worldMax);
+	VoxelVolume finalBulk = bulk.copyRegion(glm::ivec3(0), worldMax);
+	int mismatches = 0;
+	for (size_t i = 0; i < finalSingle.voxels.size(); i++) {
+		if (finalSingle.voxels[i] != finalBulk.voxels[i]) mismatches++;
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "bulk edits differ from per-voxel edits on " << mismatches << " voxel(s)" << std::endl;
+	}
+
+	int n = std::max(1, changed);
+	result.items = changed;
+	result.nsPerItem = (double)bulkTime / n;
+	result.metrics.push_back(std::make_pair("single_ns_per_voxel", (double)singleTime / n));
+	result.metrics.push_back(std::make_pair("wall_ns_per_voxel", (double)bulkWall / n));
+	result.metrics.push_back(std::make_pair("relight_ns_per_voxel", (double)relightTime / n));
+	result.metrics.push_back(std::make_pair("speedup", (double)singleTime / std::max<uint64_t>(1, bulkTime)));
+	result.metrics.push_back(std::make_pair("voxels_per_blast", (double)changed / kBlasts));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Luz: inicializacin de todo el mundo y ediciones incrementales (lmparas,
+// excavar, techos), comparadas con iluminar el resultado desde cero
+static BenchResult benchLight(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "light";
+	result.unit = "edit";
+
+	// Coste de la luz al generar: mismo mundo con y sin ella
+	uint64_t bestLit = ~0ull, bestUnlit = ~0ull;
+	int chunkCount = 0;
+	for (int rep = 0; rep < config.reps; rep++) {
+		for (int lit = 0; lit < 2; lit++) {
+			VoxelWorld world(config.worldSize.x, config.worldSize.y, config.worldSize.z);
+			world.setSeed(config.seed);
+			world.setLighting(lit != 0);
+			uint64_t start = Profiler::nowNs();
+			world.generateTerrain();
+			world.finishJobs();
+			uint64_t elapsed = Profiler::nowNs() - start;
+			if (lit) bestLit = std::min(bestLit, elapsed);
+			else bestUnlit = std::min(bestUnlit, elapsed);
+			chunkCount = world.getTotalChunks();
+		}
+	}
+
+	glm::ivec3 size = glm::min(config.worldSize, glm::ivec3(4));
+	VoxelWorld world(size.x, size.y, size.z);
+	world.setSeed(config.seed);
+	world.generateTerrain();
+	world.finishJobs();
+	LightStats before = world.getLightEngine()->getStats();
+
+	const int kEdits = 64;
+	glm::ivec3 worldMax = size * world.getChunkSize() - 1;
+	uint32_t rng = config.seed ? config.seed : 1u;
+	std::vector<glm::ivec3> lamps;
+	uint64_t editTime = 0, worstEdit = 0;
+	int edits = 0;
+
+	for (int i = 0; i < kEdits; i++) {
+		glm::vec3 origin(randomUnit(rng) * worldMax.x, (float)worldMax.y, randomUnit(rng) * worldMax.z);
+		RaycastHit hit = world.raycast(origin, glm::vec3(0.0f, -1.0f, 0.0f), (float)worldMax.y);
+		if (!hit.hit) continue;
+		glm::ivec3 top = hit.voxel + glm::ivec3(0, 1, 0);
+
+		uint64_t start = Profiler::nowNs();
+		switch (i % 4) {
+		case 0:
+			world.setWorldVoxel(top.x, top.y, top.z, MaterialTable::kLamp);
+			lamps.push_back(top);
+			break;
+		case 1:
+			world.setWorldVoxel(hit.voxel.x, hit.voxel.y, hit.voxel.z, 0);
+			break;
+		case 2:
+			world.fillBox(top + glm::ivec3(-3, 4, -3), top + glm::ivec3(3, 4, 3), 3);
+			break;
+		default:
+			if (!lamps.empty()) {
+				glm::ivec3 lamp = lamps[lamps.size() / 2];
+				world.setWorldVoxel(lamp.x, lamp.y, lamp.z, 0);
+			}
+			break;
+		}
+		// Latencia hasta que la luz est propagada
+		world.finishJobs();
+		uint64_t elapsed = Profiler::nowNs() - start;
+		editTime += elapsed;
+		worstEdit = std::max(worstEdit, elapsed);
+		edits++;
+	}
+	LightStats after = world.getLightEngine()->getStats();
+
+	// Referencia: el mismo mundo iluminado desde cero
+	world.setLighting(false);
+	VoxelWorld reference(size.x, size.y, size.z);
+	reference.setSeed(config.seed);
+	reference.setLighting(false);
+	reference.generateTerrain();
+	VoxelVolume edited = world.copyRegion(glm::ivec3(0), worldMax);
+	reference.paste(edited, glm::ivec3(0), false);
+	reference.setLighting(true);
+	reference.finishJobs();
+
+	// La luz incremental se conserva en 'world' aunque ya no tenga LightEngine
+	int mismatches = 0;
+	for (const auto& entry : world.getChunks()) {
+		const Chunk* chunk = entry.second.get();
+		const glm::ivec3& p = chunk->position;
+		const Chunk* other = reference.findGeneratedChunk(p.x, p.y, p.z);
+		if (!chunk->generated || !other) continue;
+		for (int i = 0; i < 32 * 32 * 32; i++) {
+			if (chunk->getLight(i) != other->getLight(i)) mismatches++;
+		}
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "incremental light differs from a full relight on " << mismatches << " voxel(s)" << std::endl;
+	}
+
+	int n = std::max(1, edits);
+	result.items = edits;
+	result.nsPerItem = (double)editTime / n;
+	result.metrics.push_back(std::make_pair("worst_edit_ns", (double)worstEdit));
+	result.metrics.push_back(std::make_pair("nodes_per_edit", (double)(after.nodesProcessed - before.nodesProcessed) / n));
+	result.metrics.push_back(std::make_pair("init_ns_per_chunk",
+		((double)bestLit - (double)bestUnlit) / std::max(1, chunkCount)));
+	result.metrics.push_back(std::make_pair("generate_overhead", (double)bestLit / std::max<uint64_t>(1, bestUnlit)));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// rea total de los tringulos de un rango de ndices
+static double triangleArea(const Mesh& mesh, size_t begin, size_t end) {
+	double area = 0.0;
+	for (size_t i = begin; i + 2 < end; i += 3) {
+		glm::vec3 a = mesh.vertices[mesh.index(i)].position;
+		glm::vec3 b = mesh.vertices[mesh.index(i + 1)].position;
+		glm::vec3 c = mesh.vertices[mesh.index(i + 2)].position;
+		area += 0.5 * glm::length(glm::cross(b - a, c - a));
+	}
+	return area;
+}
+
+// Chunk sinttico con piedra, agua, cristal y hojas: el rea de cada rango de
+// la malla (opaco/translcido) debe ser la de las caras unitarias visibles
+static BenchResult benchMaterials(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "mesh_materials";
+	result.unit = "chunk";
+
+	const int n = 32;
+	const glm::ivec3 size(n);
+	std::vector<uint8_t> voxels(n * n * n, MaterialTable::kAir);
+	uint32_t rng = config.seed ? config.seed : 1u;
+	for (int z = 0; z < n; z++) {
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				uint8_t& v = voxels[(z * n + y) * n + x];
+				int ground = 8 + (int)(randomUnit(rng) * 3.0f);
+				if (y < ground) v = MaterialTable::kStone;
+				else if (y < 12 && x < 20) v = MaterialTable::kWater;
+				else if (x == 24 && y < 20 && z > 4 && z < 28) v = MaterialTable::kGlass;
+				else if (y >= 16 && y < 24 && glm::length(glm::vec3(x - 10, y - 20, z - 16)) < 5.0f) v = MaterialTable::kLeaves;
+			}
+		}
+	}
+
+	// Referencia por fuerza bruta: caras unitarias segn MaterialTable
+	const MaterialTable& table = MaterialTable::get();
+	static const glm::ivec3 dirs[6] = {
+		glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0), glm::ivec3(0, 1, 0),
+		glm::ivec3(0, -1, 0), glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+	};
+	auto at = [&](const glm::ivec3& p) -> uint8_t {
+		if (glm::any(glm::lessThan(p, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(p, size))) return MaterialTable::kAir;
+		return voxels[(p.z * n + p.y) * n + p.x];
+	};
+	double expectedOpaque = 0.0, expectedTranslucent = 0.0;
+	for (int z = 0; z < n; z++) {
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				glm::ivec3 p(x, y, z);
+				uint8_t m = at(p);
+				for (int f = 0; f < 6; f++) {
+					if (!table.isFaceVisible(m, at(p + dirs[f]))) continue;
+					if (table.isTranslucent(m)) expectedTranslucent += 1.0;
+					else expectedOpaque += 1.0;
+				}
+			}
+		}
+	}
+
+	GreedyMesher mesher;
+	uint64_t best = ~0ull;
+	Mesh mesh;
+	for (int rep = 0; rep < std::max(1, config.reps) * 8; rep++) {
+		uint64_t start = Profiler::nowNs();
+		mesh = mesher.greedyFaceMesh(voxels.data(), size, nullptr);
+		best = std::min(best, Profiler::nowNs() - start);
+	}
+
+	size_t split = mesh.indexCount() - mesh.translucentIndexCount;
+	double opaqueArea = triangleArea(mesh, 0, split);
+	double translucentArea = triangleArea(mesh, split, mesh.indexCount());
+	if (std::fabs(opaqueArea - expectedOpaque) > 0.5 || std::fabs(translucentArea - expectedTranslucent) > 0.5) {
+		failures++;
+		std::cerr << "material mesh area " << opaqueArea << "/" << translucentArea
+			<< " differs from visible faces " << expectedOpaque << "/" << expectedTranslucent << std::endl;
+	}
+
+	result.items = 1;
+	result.nsPerItem = (double)best;
+	result.metrics.push_back(std::make_pair("triangles", (double)mesh.indexCount() / 3));
+	result.metrics.push_back(std::make_pair("translucent_share", (double)mesh.translucentIndexCount / std::max<size_t>(1, mesh.indexCount())));
+	result.metrics.push_back(std::make_pair("visible_faces", expectedOpaque + expectedTranslucent));
+	return result;
+}
+
+// Ediciones puntuales en un mundo ya mallado: solo se remallan y resuben las
+// secciones de 16^3 que ven el voxel. Al final, cada seccin debe coincidir
+// con un mallado completo del chunk.
+static BenchResult benchSections(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "remesh_sections";
+	result.unit = "edit";
+
+	glm::ivec3 size = glm::min(config.worldSize, glm::ivec3(4));
+	VoxelWorld world(size.x, size.y, size.z);
+	world.setSeed(config.seed);
+	world.generateTerrain();
+	world.finishJobs();
+	// La luz puede volver a ensuciar mallas recin hechas
+	for (int pass = 0; pass < 8; pass++) {
+		int scheduled = world.updateMeshes();
+		world.finishJobs();
+		if (scheduled == 0) break;
+	}
+
+	GreedyMesher mesher;
+	LightEngine* light = world.getLightEngine();
+	uint64_t partialBefore = world.getPartialRemeshes();
+	uint64_t relayoutsBefore = world.getSectionRelayouts();
+	const int kEdits = 64;
+	glm::ivec3 worldMax = size * world.getChunkSize() - 1;
+	uint32_t rng = config.seed ? config.seed : 1u;
+	uint64_t editTime = 0, fullTime = 0, partialTime = 0;
+	double sections = 0.0;
+	int edits = 0;
+	std::vector<uint8_t> voxels, lightData;
+	std::vector<Mesh> meshes;
+
+	for (int i = 0; i < kEdits; i++) {
+		glm::vec3 origin(randomUnit(rng) * worldMax.x, (float)worldMax.y, randomUnit(rng) * worldMax.z);
+		RaycastHit hit = world.raycast(origin, glm::vec3(0.0f, -1.0f, 0.0f), (float)worldMax.y);
+		if (!hit.hit) continue;
+		glm::ivec3 target = (i % 2 == 0) ? hit.voxel : hit.voxel + glm::ivec3(0, 1, 0);
+		if (target.y > worldMax.y) continue;
+
+		// Edicin, luz y remallado hasta que todo est subido
+		uint64_t start = Profiler::nowNs();
+		world.setWorldVoxel(target.x, target.y, target.z, (i % 2 == 0) ? 0 : MaterialTable::kStone);
+		for (int pass = 0; pass < 4; pass++) {
+			world.finishJobs();
+			if (world.updateMeshes() == 0) break;
+		}
+		world.finishJobs();
+		editTime += Profiler::nowNs() - start;
+		edits++;
+
+		// Coste del mallado solo: secciones afectadas frente al chunk entero
+		glm::ivec3 cp = target / world.getChunkSize();
+		const Chunk* chunk = world.findGeneratedChunk(cp.x, cp.y, cp.z);
+		if (!chunk) continue;
+		chunk->copyVoxels(voxels);
+		light->copyPadded(chunk, lightData);
+		glm::ivec3 local = target - cp * world.getChunkSize();
+		uint8_t mask = Chunk::sectionsAround(local, local);
+		uint64_t bestFull = ~0ull, bestPartial = ~0ull;
+		for (int rep = 0; rep < std::max(1, config.reps); rep++) {
+			uint64_t t0 = Profiler::nowNs();
+			mesher.greedyFaceMeshSections(voxels.data(), glm::ivec3(32), lightData.data(), Chunk::kSectionSize, Chunk::kAllSections, meshes);
+			uint64_t t1 = Profiler::nowNs();
+			mesher.greedyFaceMeshSections(voxels.data(), glm::ivec3(32), lightData.data(), Chunk::kSectionSize, mask, meshes);
+			uint64_t t2 = Profiler::nowNs();
+			bestFull = std::min(bestFull, t1 - t0);
+			bestPartial = std::min(bestPartial, t2 - t1);
+		}
+		fullTime += bestFull;
+		partialTime += bestPartial;
+		for (int s = 0; s < 8; s++) sections += (mask >> s) & 1;
+	}
+
+	// Las secciones parcheadas deben ser las de un mallado desde cero
+	int mismatches = 0;
+	double sectionTriangles = 0.0, wholeTriangles = 0.0;
+	for (const auto& entry : world.getChunks()) {
+		const Chunk* chunk = entry.second.get();
+		const ChunkMesh* mesh = chunk->mesh.get();
+		if (!chunk->generated || !mesh || mesh->sections.size() != 8) continue;
+		chunk->copyVoxels(voxels);
+		light->copyPadded(chunk, lightData);
+		mesher.greedyFaceMeshSections(voxels.data(), glm::ivec3(32), lightData.data(), Chunk::kSectionSize, Chunk::kAllSections, meshes);
+		for (int s = 0; s < 8; s++) {
+			const MeshSection& slot = mesh->sections[s];
+			if (slot.vertexCount != (int)meshes[s].vertices.size() || slot.indexCount != (int)meshes[s].indexCount() ||
+				slot.translucentIndexCount != (int)meshes[s].translucentIndexCount) mismatches++;
+			if (slot.vertexCount > slot.vertexCapacity || slot.indexCount > slot.indexCapacity) mismatches++;
+			sectionTriangles += meshes[s].indexCount() / 3;
+		}
+		wholeTriangles += mesher.greedyFaceMesh(voxels.data(), glm::ivec3(32), lightData.data()).indexCount() / 3;
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "partial remesh differs from a full remesh on " << mismatches << " section(s)" << std::endl;
+	}
+
+	int n = std::max(1, edits);
+	result.items = edits;
+	result.nsPerItem = (double)editTime / n;
+	result.metrics.push_back(std::make_pair("mesh_full_ns", (double)fullTime / n));
+	result.metrics.push_back(std::make_pair("mesh_partial_ns", (double)partialTime / n));
+	result.metrics.push_back(std::make_pair("mesh_speedup", (double)fullTime / std::max<uint64_t>(1, partialTime)));
+	result.metrics.push_back(std::make_pair("sections_per_edit", sections / n));
+	result.metrics.push_back(std::make_pair("partial_remeshes_per_edit", (double)(world.getPartialRemeshes() - partialBefore) / n));
+	result.metrics.push_back(std::make_pair("relayouts_per_edit", (double)(world.getSectionRelayouts() - relayoutsBefore) / n));
+	result.metrics.push_back(std::make_pair("section_triangle_overhead", sectionTriangles / std::max(1.0, wholeTriangles)));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Guardado asncrono y carga por mmap de todos los chunks del mundo
+static std::vector<BenchResult> benchRegions(VoxelWorld& world, const BenchConfig& config) {
+	std::vector<BenchResult> results;
+	int chunkCount = (int)world.getChunks().size();
+	int n = std::max(1, chunkCount);
+
+	// Empezar desde regiones vacas para que el tamao sea reproducible
+	{
+		RegionStore probe(config.regionDir);
+		for (const auto& entry : world.getChunks())
+			std::remove(probe.regionPath(RegionFile::regionOf(entry.second->position)).c_str());
+	}
+
+	RegionStore store(config.regionDir);
+
+	BenchResult save;
+	save.name = "region_save";
+	save.unit = "chunk";
+	save.items = chunkCount;
+
+	std::vector<std::vector<uint8_t>> contents;
+	for (const auto& entry : world.getChunks()) {
+		contents.push_back(std::vector<uint8_t>());
+		entry.second->copyVoxels(contents.back());
+	}
+
+	uint64_t start = Profiler::nowNs();
+	size_t index = 0;
+	for (const auto& entry : world.getChunks())
+		store.saveChunkAsync(entry.second->position, contents[index++]);
+	uint64_t enqueued = Profiler::nowNs() - start;
+	store.flush();
+	uint64_t total = Profiler::nowNs() - start;
+
+	save.nsPerItem = (double)total / n;
+	save.metrics.push_back(std::make_pair("enqueue_ns_per_chunk", (double)enqueued / n));
+	save.metrics.push_back(std::make_pair("bytes_per_chunk", (double)store.getBytesWritten() / n));
+	results.push_back(save);
+
+	BenchResult load;
+	load.name = "region_load";
+	load.unit = "chunk";
+	load.items = chunkCount;
+
+	uint64_t best = ~0ull;
+	int mismatches = 0;
+	std::vector<uint8_t> voxels;
+	for (int rep = 0; rep < config.reps; rep++) {
+		start = Profiler::nowNs();
+		index = 0;
+		for (const auto& entry : world.getChunks()) {
+			if (!store.loadChunk(entry.second->position, voxels, contents[index].size()) || voxels != contents[index])
+				mismatches++;
+			index++;
+		}
+		best = std::min(best, Profiler::nowNs() - start);
+	}
+
+	load.nsPerItem = (double)best / n;
+	load.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	results.push_back(load);
+
+	// Reescrituras con tamaos que cambian: los huecos liberados se reutilizan y
+	// el fichero no crece con cada guardado
+	BenchResult rewrite;
+	rewrite.name = "region_rewrite";
+	rewrite.unit = "chunk";
+	const int rounds = 4;
+	rewrite.items = chunkCount * rounds;
+
+	std::set<std::string> paths;
+	for (const auto& entry : world.getChunks())
+		paths.insert(store.regionPath(RegionFile::regionOf(entry.second->position)));
+	auto totalFileBytes = [&]() {
+		uint64_t bytes = 0;
+		for (const std::string& path : paths) {
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (file.is_open()) bytes += (uint64_t)file.tellg();
+		}
+		return bytes;
+	};
+
+	uint64_t firstBytes = totalFileBytes();
+	int rewriteMismatches = 0;
+	start = Profiler::nowNs();
+	for (int round = 0; round < rounds; round++) {
+		index = 0;
+		for (const auto& entry : world.getChunks()) {
+			std::vector<uint8_t>& voxels = contents[index++];
+			// Tramos nuevos en el RLE: cada ronda el payload cambia de tamao
+			for (size_t i = (round * 131 + index) % 97; i < voxels.size(); i += 97 * (round + 1))
+				voxels[i] = (uint8_t)(1 + (voxels[i] + round) % 3);
+			store.saveChunkAsync(entry.second->position, voxels);
+		}
+		if (!store.flush()) rewriteMismatches++;
+	}
+	uint64_t rewriteNs = Profiler::nowNs() - start;
+
+	// Reabrir: la tabla y los huecos se reconstruyen desde el fichero
+	{
+		RegionStore reopened(config.regionDir);
+		index = 0;
+		for (const auto& entry : world.getChunks()) {
+			if (!reopened.loadChunk(entry.second->position, voxels, contents[index].size()) || voxels != contents[index])
+				rewriteMismatches++;
+			index++;
+		}
+	}
+
+	// Bytes vivos: cabeceras y la ltima versin de cada chunk
+	uint64_t liveBytes = paths.size() * (uint64_t)RegionFile::kHeaderSize;
+	std::vector<uint8_t> payload;
+	for (const std::vector<uint8_t>& voxels : contents) {
+		RegionFile::encode(voxels.data(), voxels.size(), payload);
+		liveBytes += payload.size();
+	}
+
+	rewrite.nsPerItem = (double)rewriteNs / std::max(1, rewrite.items);
+	rewrite.metrics.push_back(std::make_pair("file_growth", (double)totalFileBytes() / std::max<uint64_t>(1, firstBytes)));
+	rewrite.metrics.push_back(std::make_pair("file_vs_live", (double)totalFileBytes() / std::max<uint64_t>(1, liveBytes)));
+	rewrite.metrics.push_back(std::make_pair("save_errors", (double)store.getSaveErrors()));
+	rewrite.metrics.push_back(std::make_pair("mismatches", (double)rewriteMismatches));
+	results.push_back(rewrite);
+	return results;
+}
+
+// Latencia de una edicin durable: journal con group commit frente a reescribir el chunk
+static BenchResult benchJournal(const BenchConfig& config) {
+	BenchResult result;
+	result.name = "journal_edit";
+	result.unit = "edit";
+
+	std::string activePath = config.regionDir + "/edits.wal";
+	std::remove(activePath.c_str());
+	std::remove((config.regionDir + "/edits.compacting.wal").c_str());
+
+	const int bursts = 64;
+	const int editsPerBurst = 32;
+	result.items = bursts * editsPerBurst;
+
+	std::vector<VoxelEdit> written;
+	uint64_t recordNs = 0;
+	uint64_t durableNs = 0;
+	uint64_t batches = 0;
+	{
+		EditJournal journal(config.regionDir);
+		journal.setGroupCommitMs(1);
+		journal.open();
+
+		// Rfagas como las de un pincel: se espera a que la ltima sea durable
+		for (int b = 0; b < bursts; b++) {
+			uint64_t start = Profiler::nowNs();
+			uint64_t seq = 0;
+			for (int i = 0; i < editsPerBurst; i++) {
+				VoxelEdit edit = { b, i, b + i, (uint8_t)(1 + (b + i) % 3) };
+				seq = journal.record(edit);
+				written.push_back(edit);
+			}
+			uint64_t recorded = Profiler::nowNs();
+			journal.waitCommitted(seq);
+			recordNs += recorded - start;
+			durableNs += Profiler::nowNs() - start;
+		}
+		batches = journal.getBatchesWritten();
+	}
+
+	// Reabrir y reproducir: debe salir la misma secuencia
+	size_t mismatches = 0;
+	size_t replayed = 0;
+	{
+		EditJournal journal(config.regionDir);
+		journal.open();
+		journal.replay([&](const VoxelEdit& edit) {
+			const VoxelEdit* expected = replayed < written.size() ? &written[replayed] : nullptr;
+			if (!expected || edit.x != expected->x || edit.y != expected->y ||
+				edit.z != expected->z || edit.value != expected->value)
+				mismatches++;
+			replayed++;
+		});
+	}
+	if (replayed != written.size()) mismatches++;
+	std::remove(activePath.c_str());
+
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)recordNs / n;
+	result.metrics.push_back(std::make_pair("durable_burst_us", durableNs / 1000.0 / bursts));
+	result.metrics.push_back(std::make_pair("batches", (double)batches));
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Rellenos que cubren chunks enteros (quedan uniformes o vacos) guardados al
+// cerrar el mundo y cargados de las regiones al reabrirlo
+static BenchResult benchFillReload(const BenchConfig& config, int& failures) {
+	BenchResult result;
+	result.name = "region_fill_reload";
+	result.unit = "chunk";
+
+	const glm::ivec3 size(2);
+	{
+		RegionStore probe(config.regionDir);
+		for (int z = 0; z < size.z; z++)
+			for (int y = 0; y < size.y; y++)
+				for (int x = 0; x < size.x; x++)
+					std::remove(probe.regionPath(RegionFile::regionOf(glm::ivec3(x, y, z))).c_str());
+	}
+	std::remove((config.regionDir + "/edits.wal").c_str());
+	std::remove((config.regionDir + "/edits.compacting.wal").c_str());
+
+	VoxelVolume expected;
+	uint64_t start = Profiler::nowNs();
+	{
+		VoxelWorld world(size.x, size.y, size.z);
+		world.setSeed(config.seed);
+		world.openRegionStore(config.regionDir);
+		world.generateTerrain();
+		// Un chunk entero de piedra, otro entero de aire y una caja parcial
+		world.fillBox(glm::ivec3(32), glm::ivec3(63), 3);
+		world.fillBox(glm::ivec3(0), glm::ivec3(31), 0);
+		world.fillBox(glm::ivec3(20, 40, 20), glm::ivec3(44, 50, 44), 2);
+		expected = world.copyRegion(glm::ivec3(0), size * world.getChunkSize() - 1);
+	}
+
+	VoxelWorld reopened(size.x, size.y, size.z);
+	reopened.setSeed(config.seed);
+	reopened.openRegionStore(config.regionDir);
+	reopened.generateTerrain();
+	VoxelVolume loaded = reopened.copyRegion(glm::ivec3(0), size * reopened.getChunkSize() - 1);
+	uint64_t total = Profiler::nowNs() - start;
+
+	int mismatches = 0;
+	for (size_t i = 0; i < expected.voxels.size(); i++) {
+		if (i >= loaded.voxels.size() || expected.voxels[i] != loaded.voxels[i]) mismatches++;
+	}
+	if (mismatches > 0) {
+		failures++;
+		std::cerr << "reloaded fills differ on " << mismatches << " voxel(s)" << std::endl;
+	}
+
+	result.items = size.x * size.y * size.z;
+	result.nsPerItem = (double)total / result.items;
+	result.metrics.push_back(std::make_pair("mismatches", (double)mismatches));
+	return result;
+}
+
+// Recorrido completo: LOD + culling + remallado de lo que cambia de LOD
+static BenchResult benchStreaming(const BenchConfig& config, const std::vector<CameraSample>& path) {
+	BenchResult result;
+	result.name = "camera_path_frames";
+	result.unit = "frame";
+	result.items = (int)path.size();
+
+	VoxelWorld world(config.worldSize.x, config.worldSize.y, config.worldSize.z);
+	world.setSeed(config.seed);
+	world.setRenderDistance(config.renderDistance);
+	world.generateTerrain();
+
+	uint64_t total = 0;
+	double triangles = 0.0;
+	std::vector<double> frameMs;
+	for (const CameraSample& s : path) {
+		uint64_t start = Profiler::nowNs();
+		world.render(nullptr, s.position, viewProjFor(s));
+		uint64_t elapsed = Profiler::nowNs() - start;
+		total += elapsed;
+		frameMs.push_back(elapsed / 1.0e6);
+		triangles += world.getRenderedTriangles();
+	}
+	world.finishJobs();
+
+	int n = std::max(1, result.items);
+	result.nsPerItem = (double)total / n;
+	std::sort(frameMs.begin(), frameMs.end());
+	if (!frameMs.empty()) {
+		result.metrics.push_back(std::make_pair("p50_ms", frameMs[frameMs.size() / 2]));
+		result.metrics.push_back(std::make_pair("p99_ms", frameMs[(frameMs.size() * 99) / 100]));
+	}
+	result.metrics.push_back(std::make_pair("triangles_per_frame", triangles / n));
+	result.metrics.push_back(std::make_pair("jobs", (double)world.getJobSystem()->getJobsExecuted()));
+	result.metrics.push_back(std::make_pair("jobs_stolen", (double)world.getJobSystem()->getJobsStolen()));
+	result.metrics.push_back(std::make_pair("mesh_cache_hits", (double)world.getMeshCacheHits()));
+	result.metrics.push_back(std::make_pair("meshes_built", (double)world.getMeshCacheMisses()));
+	return result;
+}
+
+// Vuelo rpido en lnea recta a 60 fps simulados sobre un mundo en streaming:
+// mide cunto trabajo se cancela y cunto de lo visible llega a estar mallado
+static BenchResult benchFastFlight(const BenchConfig& config, bool prefetch) {
+	BenchResult result;
+	result.name = prefetch ? "fast_flight_prefetch" : "fast_flight";
+	result.unit = "frame";
+	result.items = 120;
+
+	// El vuelo recorre worldSize.x chunks con renderDistance chunks ms de mundo a
+	// cada lado: siempre hay terreno por delante que cargar (y que prefetchear)
+	glm::ivec3 worldSize = config.worldSize;
+	worldSize.x += config.renderDistance * 2;
+
+	VoxelWorld world(worldSize.x, worldSize.y, worldSize.z);
+	world.setSeed(config.seed);
+	world.setRenderDistance(config.renderDistance);
+	if (!prefetch) world.setPrefetch(0, 0.0f);
+
+	const float dt = 1.0f / 60.0f;
+	glm::vec3 start(config.renderDistance * 32.0f + 16.0f, worldSize.y * 32.0f * 0.8f, worldSize.z * 16.0f);
+	glm::vec3 end((config.renderDistance + config.worldSize.x) * 32.0f - 16.0f, start.y, start.z);
+	glm::vec3 velocity = (end - start) / (result.items * dt);
+
+	uint64_t total = 0;
+	double visibleMeshed = 0.0;
+	auto next = std::chrono::steady_clock::now();
+	for (int i = 0; i < result.items; i++) {
+		CameraSample s;
+		s.position = start + velocity * (i * dt);
+		s.front = glm::normalize(glm::vec3(1.0f, -0.3f, 0.0f));
+
+		uint64_t frameStart = Profiler::nowNs();
+		world.setCameraVelocity(velocity);
+		world.render(nullptr, s.position, viewProjFor(s));
+		total += Profiler::nowNs() - frameStart;
+
+		int visible = 0, meshed = 0;
+		for (const auto& entry : world.getChunks()) {
+			const Chunk* chunk = entry.second.get();
+			if (!chunk->isVisible) continue;
+			visible++;
+			if (chunk->generated && !chunk->needsUpdate && !chunk->meshJob) meshed++;
+		}
+		visibleMeshed += visible > 0 ? (double)meshed / visible : 1.0;
+
+		// Los workers siguen trabajando mientras el "frame" espera al vsync
+		next += std::chrono::microseconds(16667);
+		std::this_thread::sleep_until(next);
+	}
+	world.finishJobs();
+
+	int generated = 0;
+	for (const auto& entry : world.getChunks())
+		if (entry.second->generated) generated++;
+
+	result.nsPerItem = (double)total / result.items;
+	result.metrics.push_back(std::make_pair("speed", (double)glm::length(velocity)));
+	result.metrics.push_back(std::make_pair("world_chunks_x", (double)worldSize.x));
+	result.metrics.push_back(std::make_pair("visible_meshed_ratio", visibleMeshed / result.items));
+	result.metrics.push_back(std::make_pair("chunks_generated", (double)generated));
+	result.metrics.push_back(std::make_pair("jobs", (double)world.getJobSystem()->getJobsExecuted()));
+	result.metrics.push_back(std::make_pair("jobs_cancelled", (double)world.getCancelledJobs()));
+
+	const PrefetchStats& stats = world.getPrefetchStats();
+	result.metrics.push_back(std::make_pair("prefetch_requested", (double)stats.requested));
+	result.metrics.push_back(std::make_pair("prefetch_hits", (double)stats.hits));
+	result.metrics.push_back(std::make_pair("prefetch_late", (double)stats.late));
+	result.metrics.push_back(std::make_pair("prefetch_wasted", (double)stats.wasted));
+	result.metrics.push_back(std::make_pair("popin_misses", (double)stats.misses));
+	return result;
+}
+
+// Corpus sinttico: tiempo de mallado y validacin de invariantes
+static std::vector<BenchResult> benchCorpus(const BenchConfig& config, int& failures) {
+	std::vector<BenchResult> results;
+	GreedyMesher mesher;
+	std::vector<CorpusCase> corpus = ChunkCorpus::generate(glm::ivec3(32), config.seed);
+
+	for (const CorpusCase& c : corpus) {
+		BenchResult result;
+		result.name = "corpus_" + c.name;
+		result.unit = "chunk";
+		result.items = 1;
+
+		uint64_t best = ~0ull;
+		std::vector<Cuboid> cuboids;
+		Mesh mesh;
+		for (int rep = 0; rep < config.reps; rep++) {
+			uint64_t start = Profiler::nowNs();
+			cuboids = mesher.greedy3DBinary(c.voxels.data(), c.size);
+			mesh = mesher.cuboidsToVertices(cuboids);
+			best = std::min(best, Profiler::nowNs() - start);
+		}
+
+		CorpusCheck cuboidCheck = ChunkCorpus::checkCuboids(c, cuboids);
+		CorpusCheck meshCheck = ChunkCorpus::checkMesh(c, mesh, false);
+		bool valid = cuboidCheck.valid && meshCheck.valid;
+		if (!valid) {
+			failures++;
+			std::cerr << "corpus " << c.name << " FAILED: " << cuboidCheck.error << meshCheck.error << std::endl;
+		}
+
+		result.nsPerItem = (double)best;
+		result.metrics.push_back(std::make_pair("triangles_per_chunk", (double)mesh.indexCount() / 3));
+		result.metrics.push_back(std::make_pair("bytes_per_chunk", meshBytes(mesh)));
+		result.metrics.push_back(std::make_pair("cuboids", (double)cuboids.size()));
+		result.metrics.push_back(std::make_pair("solid_voxels", (double)c.solidCount));
+		result.metrics.push_back(std::make_pair("exposed_face_area", (double)c.exposedFaceArea));
+		result.metrics.push_back(std::make_pair("emitted_face_area", (double)meshCheck.emittedFaceArea));
+		result.metrics.push_back(std::make_pair("valid", valid ? 1.0 : 0.0));
+		results.push_back(result);
+	}
+	return results;
+}
+
+static void writeResults(std::ostream& out, const BenchConfig& config, const std::vector<BenchResult>& results) {
+	out << std::fixed << std::setprecision(2);
+	out << "{\n  \"config\": {\"world\": [" << config.worldSize.x << ", " << config.worldSize.y << ", "
+		<< config.worldSize.z << "], \"seed\": " << config.seed << ", \"reps\": " << config.reps
+		<< ", \"render_distance\": " << config.renderDistance << "},\n  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"items\": " << r.items
+			<< ", \"ns_per_" << r.unit << "\": " << (uint64_t)r.nsPerItem;
+		for (const auto& metric : r.metrics) {
+			out << ", \"" << metric.first << "\": " << metric.second;
+		}
+		out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+}
+
+static bool parseArgs(int argc, char** argv, BenchConfig& config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--world" && hasValue) {
+			if (sscanf(argv[++i], "%dx%dx%d", &config.worldSize.x, &config.worldSize.y, &config.worldSize.z) != 3)
+				return false;
+		}
+		else if (arg == "--seed" && hasValue) config.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--reps" && hasValue) config.reps = std::max(1, atoi(argv[++i]));
+		else if (arg == "--render-distance" && hasValue) config.renderDistance = atoi(argv[++i]);
+		else if (arg == "--path" && hasValue) config.pathFile = argv[++i];
+		else if (arg == "--out" && hasValue) config.outFile = argv[++i];
+		else if (arg == "--trace" && hasValue) config.traceFile = argv[++i];
+		else if (arg == "--suite" && hasValue) config.suite = argv[++i];
+		else if (arg == "--region-dir" && hasValue) config.regionDir = argv[++i];
+		else return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	BenchConfig config;
+	if (!parseArgs(argc, argv, config)) {
+		std::cerr << "usage: voxelbench [--world WxHxD] [--seed N] [--reps N] [--render-distance N]\n"
+			"                  [--path camera_path.txt] [--out results.json] [--trace trace.json]\n"
+			"                  [--suite all|world|corpus] [--region-dir dir]" << std::endl;
+		return 1;
+	}
+
+	// El profiler solo se activa si se pide una traza
+	Profiler::get().setEnabled(!config.traceFile.empty());
+	Profiler::get().setThreadName("main");
+
+	// Los logs del mundo van a stderr para no mezclarse con el JSON
+	std::streambuf* coutBuf = std::cout.rdbuf(std::cerr.rdbuf());
+
+	std::vector<CameraSample> path = config.pathFile.empty()
+		? defaultCameraPath(config.worldSize, 240)
+		: loadCameraPath(config.pathFile);
+
+	std::vector<BenchResult> results;
+	int failures = 0;
+	bool runWorld = config.suite == "all" || config.suite == "world";
+	bool runCorpus = config.suite == "all" || config.suite == "corpus";
+
+	if (runWorld) {
+		results.push_back(benchGeneration(config));
+
+		VoxelWorld world(config.worldSize.x, config.worldSize.y, config.worldSize.z);
+		world.setSeed(config.seed);
+		world.setRenderDistance(config.renderDistance);
+		world.generateTerrain();
+
+		for (int lod = 0; lod <= 3; lod++) {
+			results.push_back(benchMeshing(world, config, lod));
+		}
+		for (int lod = 0; lod <= 3; lod++) {
+			results.push_back(benchSmooth(world, config, lod, failures));
+		}
+		results.push_back(benchDownsample(world, config, failures));
+		results.push_back(benchOptimize(world, config, MeshingMode::Blocky, failures));
+		results.push_back(benchOptimize(world, config, MeshingMode::Smooth, failures));
+		results.push_back(benchArena(world, config, failures));
+		results.push_back(benchCulling(world, path, config));
+		results.push_back(benchRaycast(world, config, failures));
+		results.push_back(benchCollision(world, config, failures));
+		results.push_back(benchOccupancy(world, config, failures));
+		results.push_back(benchChunkLayout(config, failures));
+
+		std::vector<BenchResult> regionResults = benchRegions(world, config);
+		results.insert(results.end(), regionResults.begin(), regionResults.end());
+		results.push_back(benchJournal(config));
+		results.push_back(benchFillReload(config, failures));
+		results.push_back(benchBulkEdit(config, failures));
+		results.push_back(benchLight(config, failures));
+		results.push_back(benchMaterials(config, failures));
+		results.push_back(benchSections(config, failures));
+		results.push_back(benchStreaming(config, path));
+		results.push_back(benchFastFlight(config, false));
+		results.push_back(benchFastFlight(config, true));
+	}
+
+	if (runCorpus) {
+		std::vector<BenchResult> corpusResults = benchCorpus(config, failures);
+		results.insert(results.end(), corpusResults.begin(), corpusResults.end());
+	}
+
+	std::cout.rdbuf(coutBuf);
+
+	if (!config.outFile.empty()) {
+		std::ofstream out(config.outFile);
+		writeResults(out, config, results);
+	}
+	else {
+		writeResults(std::cout, config, results);
+	}
+
+	if (!config.traceFile.empty()) Profiler::get().exportChromeTrace(config.traceFile);
+
+	// Un mesher que rompe invariantes no debe pasar por ms rpido
+	if (failures > 0) {
+		std::cerr << failures << " corpus case(s) failed validation" << std::endl;
+		return 2;
+	}
+	return 0;
+}
@@ -4,110 +4,43 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+flat in uint Material;
+in vec3 Light;
 
-vec4 lightColor = vec4 (1.f, 1.f, 1.f, 1.f);
-
-uniform sampler2D tex0;
-uniform sampler2D tex1;
+// one layer per material, indexed by Vertex::material
+uniform sampler2DArray materials;
 uniform vec3 camPos;
 
-vec4 pointLight(vec3 lightPos)
-{   
-    // used in two variables so I calculate it here to not have to do it twice
-    vec3 lightVec = lightPos - FragPos;
-
-    // intensity of light with respect to distance
-    float dist = length(lightVec);
-    float a = 0.0032;
-    float b = 0.07;
-    float inten = 1.0f / (a * dist * dist + b * dist + 1.0f);
-
-    // ambient lighting
-    float ambient = 0.01f;
-
-    // diffuse lighting
-    vec3 normal = normalize(Normal);
-    vec3 lightDirection = normalize(lightVec);
-    float diffuse = max(dot(normal, lightDirection), 0.0f);
-
-    // specular lighting
-    float specularLight = 0.50f;
-    vec3 viewDirection = normalize(camPos - FragPos);
-    vec3 reflectionDirection = reflect(-lightDirection, normal);
-    float specAmount = pow(max(dot(viewDirection, reflectionDirection), 0.0f), 16);
-    float specular = specAmount * specularLight;
-
-    return (1.f * (diffuse * inten + ambient) + 1.f * specular * inten) * lightColor;
-}
-
-vec4 direcLight(vec3 lightPos)
-{   
-    // used in two variables so I calculate it here to not have to do it twice
-    vec3 lightVec = lightPos - FragPos;
-
-    // intensity of light with respect to distance
-    float dist = length(lightVec);
-    float a = 0.0000032;
-    float b = 0.00007;
-    float inten = 1.0f / (a * dist * dist + b * dist + 1.0f);
-
-    // ambient lighting
-    float ambient = 0.20f;
-
-    // diffuse lighting
-    vec3 normal = normalize(Normal);
-    vec3 lightDirection = normalize(vec3(1.0f, 1.0f, 1.0f));
-    float diffuse = max(dot(normal, lightDirection), 0.0f);
+vec3 skyColor = vec3(1.0f, 0.98f, 0.92f);
+vec3 blockColor = vec3(1.0f, 0.78f, 0.45f);
+vec3 sunDirection = normalize(vec3(0.4f, 1.0f, 0.25f));
 
-    // specular lighting
-    float specularLight = 0.50f;
-    vec3 viewDirection = normalize(camPos - FragPos);
-    vec3 reflectionDirection = reflect(-lightDirection, normal);
-    float specAmount = pow(max(dot(viewDirection, reflectionDirection), 0.0f), 16);
-    float specular = specAmount * specularLight;
-
-    return (texture(tex0, TexCoord) * (diffuse * inten + ambient) + texture(tex1, TexCoord).r * specular * inten) * lightColor;
+// light levels are linear in the baked value; this curve makes every level
+// step look roughly the same (level 15 = 1.0, level 0 = ambient only)
+float levelCurve(float level)
+{
+    return level * level * (0.4f + 0.6f * level);
 }
 
-vec4 spotLight(vec3 lightPos)
-{   
-    // used in two variables so I calculate it here to not have to do it twice
-    vec3 lightVec = lightPos - FragPos;
-
-    // intensity of light with respect to distance
-    float dist = 0;
-    float a = 0.00032;
-    float b = 0.007;
-    float inten = 1.0f / (a * dist * dist + b * dist + 1.0f);
-
-    // controls how big the area that is lit up is
-    float outerCone = 0.90f;
-    float innerCone = 0.95f;
-
-    // ambient lighting
-    float ambient = 0.20f;
+void main()
+{
+    vec4 albedo = texture(materials, vec3(TexCoord, float(Material)));
+    // cutout materials (leaves): texels with zero alpha are holes
+    if (albedo.a < 0.1f)
+        discard;
 
-    // diffuse lighting
+    // all lights are baked per vertex: the cost does not depend on how many there are
     vec3 normal = normalize(Normal);
-    vec3 lightDirection = normalize(lightPos - FragPos);
-    float diffuse = max(dot(normal, lightDirection), 0.0f);
-
-    // specular lighting
-    float specularLight = 0.50f;
-    vec3 viewDirection = normalize(camPos - FragPos);
-    vec3 reflectionDirection = reflect(-lightDirection, normal);
-    float specAmount = pow(max(dot(viewDirection, reflectionDirection), 0.0f), 16);
-    float specular = specAmount * specularLight;
+    float sun = 0.6f + 0.4f * max(dot(normal, sunDirection), 0.0f);
+    float sky = levelCurve(Light.x);
+    float block = levelCurve(Light.y);
 
-    // calculates the intensity of the FragPos based on its angle to the center of the light cone
-    float angle = dot(vec3(0.0f, -1.0f, 0.0f), -lightDirection);
-    inten += clamp((angle - outerCone) / (innerCone - outerCone), 0.0f, 1.0f);
+    // voxel ambient occlusion: 0 (two solid sides) .. 1 (open corner)
+    float occlusion = 0.4f + 0.6f * Light.z;
 
-    return (texture(tex0, TexCoord) * (diffuse * inten + ambient) + texture(tex1, TexCoord).r * specular * inten) * lightColor;
-}
+    float ambient = 0.03f;
+    vec3 light = (skyColor * sky * sun + blockColor * block + vec3(ambient)) * occlusion;
 
-void main()
-{
     // outputs final color
-    FragColor = pointLight(vec3(1.5f, 1.5f, 1.5f));
-}
\ No newline at end of file
+    FragColor = vec4(albedo.rgb * min(light, vec3(1.0f)), albedo.a);
+}
@@ -3,18 +3,26 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in uint aMaterial;
+// baked per vertex: x = sky light, y = block light, z = ambient occlusion (0..1)
+layout (location = 4) in vec4 aLight;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
+flat out uint Material;
+out vec3 Light;
 
+uniform mat4 model;
 uniform mat4 view;
 uniform mat4 proj;
 
 void main()
 {
-    FragPos = aPos;
+    FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = aNormal;
     TexCoord = aTexCoord;
-    gl_Position = proj * view * vec4(aPos, 1.0);
+    Material = aMaterial;
+    Light = aLight.xyz;
+    gl_Position = proj * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+
+class RegionStore;
+
+// Edicin de un voxel en coordenadas de mundo
+struct VoxelEdit {
+	int32_t x, y, z;
+	uint8_t value;
+};
+
+// Journal de ediciones (write-ahead log). Cada edicin se aade a un lote en
+// memoria; un hilo hace group commit de los lotes con un solo write + fsync.
+// Al cargar se reproduce encima de las regiones, y se compacta en ellas en
+// segundo plano.
+//
+// Formato de lote: [uint32 magic][uint32 count][uint32 crc32][count * 13 bytes]
+// Un lote cortado por un crash falla el CRC y se descarta junto con la cola.
+//
+// Si una escritura falla el journal queda en fallo: no se escribe ms en l y
+// las esperas devuelven false. La siguiente rotacin abre un journal nuevo.
+class EditJournal {
+public:
+	static const uint32_t kBatchMagic = 0x424A5856;  // "VXJB"
+	static const int kEditBytes = 13;
+	static const int kBatchHeaderBytes = 12;
+
+private:
+	std::string directory;
+	std::string activePath;
+	std::string compactingPath;
+	FILE* file = nullptr;
+
+	std::mutex mutex;
+	std::mutex fileMutex;  // Escritura y rotacin del fichero activo
+	std::condition_variable commitCv;
+	std::condition_variable committedCv;
+	std::vector<VoxelEdit> batch;
+	uint64_t recordedSeq = 0;
+	uint64_t committedSeq = 0;
+	uint64_t lostSeq = 0;  // Ediciones hasta aqu no llegaron al journal
+	uint64_t activeBytes = 0;
+	bool stopping = false;
+	bool failed = false;
+
+	// Compactacin: borrar el journal antiguo cuando las regiones estn en disco
+	RegionStore* retireStore = nullptr;
+	bool compacting = false;
+
+	int groupCommitMs = 4;
+	size_t maxBatchEdits = 8192;
+	uint64_t compactThresholdBytes = 4 * 1024 * 1024;
+
+	std::atomic<uint64_t> batchesWritten{ 0 };
+	std::atomic<uint64_t> editsWritten{ 0 };
+
+	std::thread committerThread;
+
+	void committerLoop();
+	bool writeBatch(const std::vector<VoxelEdit>& edits);
+	static size_t validPrefix(const std::vector<uint8_t>& data,
+		const std::function<void(const VoxelEdit&)>& apply);
+	static bool readFile(const std::string& path, std::vector<uint8_t>& data);
+	// Escribe en un temporal con fsync y lo renombra sobre 'path'
+	bool writeFileAtomic(const std::string& path, const std::vector<uint8_t>& data);
+
+public:
+	explicit EditJournal(const std::string& directory);
+	~EditJournal();
+
+	// Abre el journal activo descartando una cola corrupta
+	bool open();
+
+	// Encola una edicin; devuelve su nmero de secuencia
+	uint64_t record(const VoxelEdit& edit);
+	// Encola varias ediciones con un solo lock; devuelve la secuencia de la ltima
+	uint64_t record(const VoxelEdit* edits, size_t count);
+	// Bloquea hasta que la edicin 'seq' est en disco; false si no lleg a estarlo
+	bool waitCommitted(uint64_t seq);
+	bool commitAll();
+	// Una escritura fall: las ediciones desde entonces solo estn en los chunks
+	bool hasFailed();
+
+	// Aplica todas las ediciones guardadas (journal en compactacin primero)
+	size_t replay(const std::function<void(const VoxelEdit&)>& apply);
+
+	bool needsCompaction();
+	// Rota el journal activo. Falla si an hay una compactacin en curso o si no
+	// se pudo rotar; en ese caso se sigue escribiendo en el journal anterior.
+	bool beginCompaction();
+	// Tras encolar los chunks modificados: espera al store y borra el journal rotado
+	// solo si todos los guardados llegaron a disco; si no, se conserva para la prxima
+	void finishCompactionAsync(RegionStore* store);
+	bool isCompacting();
+
+	void setGroupCommitMs(int ms) { groupCommitMs = ms; }
+	void setCompactThreshold(uint64_t bytes) { compactThresholdBytes = bytes; }
+
+	uint64_t getBatchesWritten() const { return batchesWritten.load(); }
+	uint64_t getEditsWritten() const { return editsWritten.load(); }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+#include "Profiler.h"
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// Tiempos de GPU con pares de queries GL_TIME_ELAPSED. Los resultados se leen
+// frames despus (sin bloquear) y se envan al track "GPU" del Profiler.
+// GL_TIME_ELAPSED no admite anidamiento: un solo pase activo a la vez.
+class GpuTimer {
+private:
+	struct PendingQuery {
+		GLuint query;
+		const char* name;
+		uint64_t cpuStartNs;
+	};
+
+	std::vector<GLuint> freeQueries;
+	std::deque<PendingQuery> pending;
+	PendingQuery active = { 0, nullptr, 0 };
+	bool hasActive = false;
+
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	void begin(const char* name);
+	void end();
+
+	// Recoge las queries ya resueltas (llamar una vez por frame)
+	void collect();
+};
+
+class GpuScope {
+private:
+	GpuTimer& timer;
+
+public:
+	GpuScope(GpuTimer& gpuTimer, const char* name) : timer(gpuTimer) { timer.begin(name); }
+	~GpuScope() { timer.end(); }
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
+
+#ifndef VOXELGL_NO_PROFILER
+#define GPU_PROFILE_SCOPE(timer, name) GpuScope PROFILE_CONCAT(gpuScope_, __LINE__)(timer, name)
+#else
+#define GPU_PROFILE_SCOPE(timer, name) ((void)0)
+#endif
+
+#endif
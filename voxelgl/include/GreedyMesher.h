@@ -4,21 +4,47 @@
 #include <vector>
 #include <cstdint>
 #include <glm/glm.hpp>
+#include "LodDownsampler.h"
+
+// Luz horneada por vrtice: byte 0 cielo, byte 1 bloque, byte 2 oclusin ambiental
+// (0..255, normalizados en el shader)
+const uint32_t kFullSkyLight = 0x00FF00FF;
 
 struct Vertex {
 	glm::vec3 position;
 	glm::vec3 normal;
 	glm::vec2 uv;
 	uint32_t material;
+	uint32_t light;
 
 	Vertex() = default;
-	Vertex(glm::vec3 pos, glm::vec3 norm, glm::vec2 tex, uint32_t mat)
-		: position(pos), normal(norm), uv(tex), material(mat) {}
+	Vertex(glm::vec3 pos, glm::vec3 norm, glm::vec2 tex, uint32_t mat, uint32_t lightValue = kFullSkyLight)
+		: position(pos), normal(norm), uv(tex), material(mat), light(lightValue) {}
 };
 
 struct Mesh {
 	std::vector<Vertex> vertices;
+	// Vaco en las mallas de quads: cada 4 vrtices son un quad con los ndices
+	// fijos { 0, 1, 2, 0, 2, 3 } + 4q, que se comparten en un solo EBO
 	std::vector<uint32_t> indices;
+	// Las ltimas translucentIndexCount (de indexCount()) son translcidas: se
+	// dibujan despus de lo opaco, con blending y ordenadas por distancia
+	uint32_t translucentIndexCount = 0;
+	bool quads = false;
+
+	// Vaca la malla conservando la capacidad de los vectores
+	void clear() {
+		vertices.clear();
+		indices.clear();
+		translucentIndexCount = 0;
+		quads = false;
+	}
+	size_t indexCount() const { return quads ? vertices.size() / 4 * 6 : indices.size(); }
+	uint32_t index(size_t i) const {
+		if (!quads) return indices[i];
+		uint32_t k = (uint32_t)(i % 6);
+		return (uint32_t)(i / 6) * 4 + (k < 3 ? k : (k == 3 ? 0 : k - 2));
+	}
 };
 
 struct Cuboid {
@@ -30,8 +56,22 @@ struct Cuboid {
 class GreedyMesher {
 private:
 	// Buffer para marcado de visitados
-	bool* visitedBuffer = nullptr;
+	uint8_t* visitedBuffer = nullptr;
 	int bufferSize = 0;
+	// Mscara de caras de una capa, voxels con borde y quads translcidos (greedyFaceMesh)
+	std::vector<uint64_t> faceMask;
+	std::vector<uint8_t> paddedVoxels;
+	std::vector<Vertex> translucentVertices;
+	// Voxels reducidos y cuboides del LOD (generateLODMesh con salida)
+	std::vector<uint8_t> lodVoxels;
+	std::vector<Cuboid> lodCuboids;
+	LodDownsampler downsampler;
+
+	// Copia los voxels a paddedVoxels (con borde de aire)
+	void padVoxels(const uint8_t* voxels, const glm::ivec3& size);
+	// Caras de los voxels de [regionMin, regionMax) ledos de 'pv', con borde
+	void faceMeshRegion(const uint8_t* pv, const glm::ivec3& size, const uint8_t* light,
+		const glm::ivec3& regionMin, const glm::ivec3& regionMax, Mesh& mesh);
 
 	// Direcciones normales
 	const glm::vec3 faceNormals[6] = {
@@ -47,28 +87,47 @@ public:
 	GreedyMesher();
 	~GreedyMesher();
 
+	// Las variantes con parmetro de salida lo vacan y lo rellenan reutilizando su
+	// capacidad (MeshArena); las que devuelven por valor reservan memoria nueva.
+
 	// Greedy meshing 3D binario (slido/vaco)
 	std::vector<Cuboid> greedy3DBinary(const uint8_t* voxels, const glm::ivec3& size);
+	void greedy3DBinary(const uint8_t* voxels, const glm::ivec3& size, std::vector<Cuboid>& cuboids);
 
-	// Convertir cuboides a vrtices
+	// Convertir cuboides a vrtices (24 por cuboide, reservados de una vez)
 	Mesh cuboidsToVertices(const std::vector<Cuboid>& cuboids);
+	void cuboidsToVertices(const std::vector<Cuboid>& cuboids, Mesh& mesh);
 
 	// Funcin combinada para fcil uso
 	Mesh greedy3DBinaryToVertices(const uint8_t* voxels, const glm::ivec3& size);
 
-	// LOD: Downsample y greedy meshing
+	// Greedy por caras: solo caras visibles (MaterialTable::isFaceVisible), fusionadas
+	// en quads del mismo material y la misma luz y oclusin ambiental (AO) en las
+	// cuatro esquinas. Las caras translcidas van al final (Mesh::translucentIndexCount).
+	// 'light' es la luz de (size + 2)^3 voxels (el chunk con un voxel de borde; cielo
+	// en el nibble alto, bloque en el bajo); null: todo a plena luz de cielo.
+	Mesh greedyFaceMesh(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light);
+	void greedyFaceMesh(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, Mesh& mesh);
+	// Igual, pero una malla por seccin de sectionSize^3 (x ms rpido, luego y, luego z).
+	// Solo se rehacen las secciones de 'sectionMask'; las dems no se tocan. Los quads
+	// no cruzan secciones; ndices locales a cada malla, posiciones en el espacio del chunk.
+	void greedyFaceMeshSections(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light,
+		int sectionSize, uint32_t sectionMask, std::vector<Mesh>& sections);
+	// Igual, con 'padded' de (size + 2)^3 voxels como 'light': el borde trae los voxels
+	// de los vecinos, as las caras y la AO del borde del chunk miran al mundo real
+	void greedyFaceMeshSectionsPadded(const uint8_t* padded, const glm::ivec3& size, const uint8_t* light,
+		int sectionSize, uint32_t sectionMask, std::vector<Mesh>& sections);
+
+	// LOD: Downsample y greedy meshing (LOD 0: greedyFaceMesh sin luz)
 	Mesh generateLODMesh(const uint8_t* voxels, const glm::ivec3& size, int lodLevel);
+	void generateLODMesh(const uint8_t* voxels, const glm::ivec3& size, int lodLevel, Mesh& mesh);
 
 private:
 	// Funciones auxiliares
 	void ensureVisitedBuffer(int size);
-	bool isSolid(const uint8_t* voxels, const glm::ivec3& size, const glm::ivec3& pos);
-	bool isFaceVisible(const uint8_t* voxels, const glm::ivec3& size,
-		const glm::ivec3& pos, int face);
 
-	// Downsampling para LOD
-	std::vector<uint8_t> downsample(const uint8_t* voxels,
-		const glm::ivec3& size, int factor);
+	// Downsampling para LOD; false si el tamao no admite ese factor (result queda vaco)
+	bool downsample(const uint8_t* voxels, const glm::ivec3& size, int factor, std::vector<uint8_t>& result);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+enum class JobAffinity {
+	Any,        // Cualquier worker
+	MainThread  // Solo el hilo con el contexto GL (runMainThreadJobs)
+};
+
+struct Job {
+	std::function<void()> task;
+	float priority = 0.0f;  // Menor = antes (distancia a la cmara). Clave del heap.
+	std::atomic<float> requestedPriority{ 0.0f };  // Se aplica en refreshPriorities()
+	JobAffinity affinity = JobAffinity::Any;
+
+	// Dependencias sin terminar, ms 1 hasta que se llama a submit()
+	std::atomic<int> pendingCount{ 1 };
+	std::atomic<bool> finished{ false };
+
+	std::mutex mutex;
+	std::vector<std::shared_ptr<Job>> continuations;
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+// Scheduler con work stealing: cada worker tiene su propia cola ordenada por
+// prioridad y, cuando se vaca, roba la mejor tarea de otro worker. Un job se
+// encola cuando terminan todos sus prerequisitos (addDependency).
+class JobSystem {
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::vector<JobHandle> heap;  // Min-heap por prioridad
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	WorkerQueue mainQueue;
+	std::vector<std::thread> workers;
+
+	std::mutex sleepMutex;
+	std::condition_variable sleepCv;
+	std::mutex doneMutex;
+	std::condition_variable doneCv;
+
+	std::atomic<int> queuedJobs{ 0 };   // Listos en colas de workers
+	std::atomic<int> activeJobs{ 0 };   // Enviados y sin terminar
+	std::atomic<uint32_t> nextQueue{ 0 };
+	std::atomic<bool> stopping{ false };
+	std::atomic<bool> prioritiesDirty{ false };
+
+	std::atomic<uint64_t> jobsExecuted{ 0 };
+	std::atomic<uint64_t> jobsStolen{ 0 };
+
+	void workerLoop(int index);
+	void schedule(const JobHandle& job);
+	void execute(const JobHandle& job);
+	JobHandle pop(WorkerQueue& queue);
+	JobHandle steal(int thief);
+
+	static void push(WorkerQueue& queue, const JobHandle& job);
+	static void reheap(WorkerQueue& queue);
+
+public:
+	// workerCount <= 0: un worker por ncleo menos el hilo principal
+	explicit JobSystem(int workerCount = 0);
+	~JobSystem();
+
+	JobHandle create(std::function<void()> task, float priority = 0.0f,
+		JobAffinity affinity = JobAffinity::Any);
+	// 'job' no se ejecuta hasta que termine 'prerequisite'. Antes de submit(job).
+	void addDependency(const JobHandle& job, const JobHandle& prerequisite);
+	void submit(const JobHandle& job);
+	JobHandle run(std::function<void()> task, float priority = 0.0f,
+		JobAffinity affinity = JobAffinity::Any);
+
+	// Cambia la prioridad de un job ya encolado o an bloqueado. El cambio se
+	// aplica en bloque con refreshPriorities() (una vez por frame).
+	void setPriority(const JobHandle& job, float priority);
+	void refreshPriorities();
+
+	// Ejecuta jobs fijados al hilo principal (budget < 0: todos los listos)
+	int runMainThreadJobs(int budget = -1);
+	// Desde el hilo principal: ayuda con los jobs hasta que 'job' termine
+	void wait(const JobHandle& job);
+	void waitIdle();
+
+	static bool isFinished(const JobHandle& job) { return !job || job->finished.load(); }
+
+	int getWorkerCount() const { return (int)workers.size(); }
+	int getActiveJobs() const { return activeJobs.load(); }
+	uint64_t getJobsExecuted() const { return jobsExecuted.load(); }
+	uint64_t getJobsStolen() const { return jobsStolen.load(); }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef LIGHT_ENGINE_H
+#define LIGHT_ENGINE_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "MaterialTable.h"
+
+class VoxelWorld;
+struct Chunk;
+
+// Nodo de las colas de propagacin (coordenadas de mundo)
+struct LightNode {
+	int32_t x, y, z;
+	uint8_t level;
+};
+
+// Voxels cambiados de un chunk en una edicin en bloque: un bit por x en cada
+// fila (z * 32 + y), y el rango local de filas con cambios
+struct LightEditMask {
+	glm::ivec3 origin;
+	glm::ivec3 lo, hi;
+	std::vector<uint32_t> rows;
+};
+
+struct LightStats {
+	uint64_t chunksLit = 0;
+	uint64_t editsApplied = 0;
+	uint64_t nodesProcessed = 0;
+	uint64_t batches = 0;
+};
+
+// Luz por flood fill: 4 bits de cielo y 4 de bloque por voxel (Chunk::light).
+// La luz de cielo baja sin perder nivel desde el techo del mundo; la de bloque
+// sale de los materiales emisores. Las ediciones se aplican de forma
+// incremental (colas de borrado y de adicin en BFS).
+//
+// Todo el trabajo ocurre en un solo job de worker a la vez, por lotes con un
+// presupuesto de nodos, bajo VoxelWorld::voxelMutex. El lote va por tramos
+// (un chunk, una edicin o kNodesPerSlice nodos) y entre uno y otro cede el
+// mutex si el hilo principal lo espera para editar. El hilo principal solo
+// encola (requestChunk/notifyEdit) y copia la luz para mallar.
+class LightEngine {
+public:
+	static const int kMaxLevel = 15;
+	static const int kNodesPerBatch = 32768;
+	static const int kNodesPerSlice = 2048;
+
+	// Nivel de luz que emite un material (0: ninguno)
+	static int emission(uint8_t material) { return MaterialTable::get().emission(material); }
+	// Solo los materiales opacos paran la luz (el cristal, el agua y las hojas no)
+	static bool isOpaque(uint8_t material) { return MaterialTable::get().isOpaque(material); }
+
+private:
+	VoxelWorld* world;
+	int chunkSize;
+	glm::ivec3 worldVoxels;  // Tamao del mundo en voxels
+
+	// Entradas del hilo principal y de la generacin
+	std::mutex queueMutex;
+	std::vector<Chunk*> pendingChunks;
+	std::vector<glm::ivec3> pendingEdits;
+	std::vector<LightEditMask> pendingMasks;
+
+	// Colas de BFS: solo las toca el job activo
+	std::deque<LightNode> skyRemove, blockRemove;
+	std::deque<LightNode> skyAdd, blockAdd;
+	// Chunks cuya luz cambi en el lote (se remallan al terminarlo)
+	std::vector<Chunk*> touched;
+
+	// Cach de la ltima bsqueda de chunk (se invalida en cada lote)
+	glm::ivec3 cachedCoord = glm::ivec3(-1);
+	Chunk* cachedChunk = nullptr;
+
+	std::atomic<bool> jobQueued{ false };
+	std::atomic<bool> stopping{ false };
+
+	std::atomic<uint64_t> chunksLit{ 0 };
+	std::atomic<uint64_t> editsApplied{ 0 };
+	std::atomic<uint64_t> nodesProcessed{ 0 };
+	std::atomic<uint64_t> batches{ 0 };
+
+	void scheduleJob();
+	void runBatch();
+	bool hasPendingInput();
+	// Fin de tramo: suelta voxelMutex si el hilo principal lo est esperando
+	void yieldVoxels(std::unique_lock<std::mutex>& lock);
+
+	Chunk* findChunk(const glm::ivec3& coord);
+	// Chunk iluminado que contiene 'pos' e ndice local; null si no lo hay
+	Chunk* locate(const glm::ivec3& pos, int& index);
+	// Vecino en la direccin 'dir' de un voxel de 'chunk' (mismo chunk salvo en el borde)
+	Chunk* step(Chunk* chunk, const glm::ivec3& local, int index, const glm::ivec3& pos, int dir, int& outIndex);
+	uint8_t voxelAt(const Chunk* chunk, int index) const;
+	void touch(Chunk* chunk, const glm::ivec3& local);
+	// Anota el chunk en el lote con las secciones de malla que leen la luz cambiada
+	void touchChunk(Chunk* chunk, uint8_t sections);
+	// Pasa los chunks tocados en el lote (y los vecinos de sus bordes) a lightDirty
+	void flushTouched();
+
+	void initChunk(Chunk* chunk);
+	void applyEdit(const glm::ivec3& pos);
+	void applyMask(const LightEditMask& mask);
+	// Nivel propio de un voxel (techo del mundo, emisin)
+	int sourceLevel(const glm::ivec3& pos, uint8_t material, bool sky) const;
+
+	void propagateRemove(std::deque<LightNode>& removeQueue, std::deque<LightNode>& addQueue, bool sky, int& budget);
+	void propagateAdd(std::deque<LightNode>& addQueue, bool sky, int& budget);
+
+public:
+	explicit LightEngine(VoxelWorld* owner);
+	~LightEngine();
+
+	// Desde el job de generacin, con el chunk ya generado
+	void requestChunk(Chunk* chunk);
+	// Tras cambiar el voxel 'pos' (mundo), con voxelMutex tomado
+	void notifyEdit(const glm::ivec3& pos);
+	// Igual para una edicin en bloque entera (una mscara por chunk): se encola
+	// de una vez al terminarla y se ilumina en el mismo lote
+	void notifyEdits(std::vector<LightEditMask>& masks);
+
+	// Copia la luz de (chunkSize + 2)^3 voxels alrededor del chunk, con voxelMutex
+	// tomado. Los vecinos sin luz repiten el borde del chunk; encima del mundo
+	// hay cielo pleno.
+	void copyPadded(const Chunk* chunk, std::vector<uint8_t>& out);
+
+	// Deja de encolar lotes (antes de destruir el mundo)
+	void stop() { stopping.store(true); }
+	bool isIdle();
+	LightStats getStats() const;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LOD_DOWNSAMPLER_H
+#define LOD_DOWNSAMPLER_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Pirmide de LOD de un volumen: cada nivel reduce bloques de 2x2x2 del anterior
+// y guarda cuntos voxels originales del bloque son slidos (exacto) y su material
+// mayoritario. Todos los niveles salen de una sola pasada por los voxels.
+class LodDownsampler {
+public:
+	static const int kMaxLevels = 5;
+
+private:
+	glm::ivec3 sizes[kMaxLevels + 1];
+	std::vector<uint16_t> counts[kMaxLevels + 1];  // [0] sin usar
+	std::vector<uint8_t> materials[kMaxLevels + 1];
+	int levels = 0;
+
+	// Niveles 2 en adelante: suma de cuentas y mayora ponderada por ellas
+	static void reduceLevel(const uint16_t* counts, const uint8_t* materials, const glm::ivec3& size,
+		uint16_t* outCounts, uint8_t* outMaterials);
+
+public:
+	// Niveles 1..levels de 'voxels' (x ms rpido). El nivel k mide size / 2^k;
+	// los voxels que sobran en un eje impar se descartan.
+	void build(const uint8_t* voxels, const glm::ivec3& size, int levels);
+
+	int getLevels() const { return levels; }
+	glm::ivec3 getSize(int level) const { return sizes[level]; }
+	// Voxels slidos de cada bloque de 2^k x 2^k x 2^k
+	const uint16_t* getCounts(int level) const { return counts[level].data(); }
+	// Material ms repetido entre los slidos (empate: el primero; 0 sin slidos)
+	const uint8_t* getMaterials(int level) const { return materials[level].data(); }
+
+	// Primer nivel: AVX2 (si la CPU lo tiene) o NEON, 16 bloques por fila de
+	// vector; el resto y las CPU sin ellos van por la versin escalar
+	static void reduceVoxels(const uint8_t* voxels, const glm::ivec3& size, uint16_t* counts, uint8_t* materials);
+	static void reduceVoxelsScalar(const uint8_t* voxels, const glm::ivec3& size, uint16_t* counts, uint8_t* materials);
+	// Bloques por instruccin de reduceVoxels (1: escalar)
+	static int vectorWidth();
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Vista de solo lectura de un fichero mapeado en memoria (Win32 / POSIX).
+// remap() vuelve a mapear tras crecer el fichero.
+class MappedFile {
+private:
+	std::string path;
+	const uint8_t* mapped = nullptr;
+	size_t mappedSize = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	void unmap();
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string& filePath);
+	bool remap();
+	void close();
+
+	bool isOpen() const { return mapped != nullptr; }
+	const uint8_t* data() const { return mapped; }
+	size_t size() const { return mappedSize; }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif
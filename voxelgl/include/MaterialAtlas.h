@@ -0,0 +1,54 @@
+#ifndef MATERIAL_ATLAS_H
+#define MATERIAL_ATLAS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// Atlas de materiales: todas las texturas de bloque en un GL_TEXTURE_2D_ARRAY.
+// La capa de cada textura es el propio id de material (Vertex::material), de modo
+// que todos los chunks se dibujan con un solo binding.
+class MaterialAtlas {
+private:
+	GLuint textureID = 0;
+	int tileSize = 0;
+	int layerCount = 0;
+	int mipLevels = 0;
+
+	// Nivel de mip listo por capa (los mips se generan en streaming)
+	std::vector<int> readyLevel;
+	// Copia en CPU del ltimo nivel generado de cada capa
+	std::vector<std::vector<uint8_t>> lastLevelPixels;
+	// Capas con mips pendientes
+	std::deque<int> pendingLayers;
+	int maxLevelSet = -1;
+
+	void uploadLevel(int layer, int level, const uint8_t* rgba);
+	void updateMaxLevel();
+
+public:
+	MaterialAtlas();
+	~MaterialAtlas();
+
+	// Crea el array con capas de tileSize x tileSize (potencia de 2)
+	bool create(int tileSize, int maxMaterials);
+
+	// Sube el nivel 0 de un material y encola la generacin de sus mips
+	void setMaterialTexture(uint32_t material, const uint8_t* rgba);
+	// Textura procedural de color slido con algo de ruido. 'alpha' es la opacidad
+	// (translcidos); 'holes' la fraccin de texels con alpha 0 (cutout)
+	void setMaterialColor(uint32_t material, const glm::vec3& color, float alpha = 1.0f, float holes = 0.0f);
+
+	// Genera y sube como mximo 'budget' niveles de mip (llamar una vez por frame)
+	void update(int budget = 1);
+	bool isComplete() const { return pendingLayers.empty(); }
+
+	void bind(GLuint unit = 0) const;
+
+	GLuint getTextureID() const { return textureID; }
+	int getLayerCount() const { return layerCount; }
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <cstdint>
+
+enum class MaterialKind : uint8_t {
+	Air,          // Sin caras
+	Opaque,       // Tapa las caras vecinas, la luz y hace AO
+	Cutout,       // Con huecos (alpha test): va con lo opaco pero no tapa nada
+	Translucent   // Mezcla alpha: malla aparte; solo tapa caras de su mismo material
+};
+
+struct MaterialProperties {
+	MaterialKind kind = MaterialKind::Opaque;
+	uint8_t emission = 0;  // Nivel de luz que emite (0..15)
+};
+
+// Propiedades por id de material (el mismo de Vertex::material y del atlas).
+// La consultan el mesher (caras visibles, malla opaca/translcida) y la luz.
+// Se configura al arrancar, antes de generar: los jobs la leen sin lock.
+class MaterialTable {
+public:
+	static const uint8_t kAir = 0;
+	static const uint8_t kGrass = 1;
+	static const uint8_t kDirt = 2;
+	static const uint8_t kStone = 3;
+	static const uint8_t kLamp = 4;
+	static const uint8_t kGlass = 5;
+	static const uint8_t kLeaves = 6;
+	static const uint8_t kWater = 7;
+
+private:
+	MaterialProperties properties[256];
+	MaterialTable();
+
+public:
+	static MaterialTable& get();
+
+	void set(uint8_t material, const MaterialProperties& value) { properties[material] = value; }
+	const MaterialProperties& operator[](uint8_t material) const { return properties[material]; }
+
+	MaterialKind kind(uint8_t material) const { return properties[material].kind; }
+	bool isOpaque(uint8_t material) const { return properties[material].kind == MaterialKind::Opaque; }
+	bool isTranslucent(uint8_t material) const { return properties[material].kind == MaterialKind::Translucent; }
+	int emission(uint8_t material) const { return properties[material].emission; }
+
+	// Cara de 'material' visible contra el voxel 'neighbor'
+	bool isFaceVisible(uint8_t material, uint8_t neighbor) const {
+		MaterialKind self = properties[material].kind;
+		MaterialKind other = properties[neighbor].kind;
+		if (self == MaterialKind::Air || other == MaterialKind::Opaque) return false;
+		// Interior de un volumen de agua o cristal
+		if (self == MaterialKind::Translucent && material == neighbor) return false;
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "GreedyMesher.h"
+
+// Mallas recicladas para los jobs de mallado: el mallador escribe en vectores que
+// conservan la capacidad de una malla anterior, la subida lee de ellos sin copiar
+// y al terminar vuelven aqu. En rgimen estable remallar no reserva memoria.
+// Seguro entre hilos.
+class MeshArena {
+private:
+	std::mutex mutex;
+	std::vector<Mesh> freeMeshes;
+	size_t retainedBytes = 0;
+	size_t maxRetainedBytes;
+	// Las mallas ms grandes que esto no se guardan (un chunk patolgico no
+	// deja reservados sus megas para siempre)
+	size_t maxMeshBytes;
+
+	uint64_t reused = 0;
+	uint64_t created = 0;
+
+	static size_t capacityBytes(const Mesh& mesh);
+
+public:
+	explicit MeshArena(size_t maxRetainedBytes = 64u << 20, size_t maxMeshBytes = 4u << 20);
+
+	// Deja 'meshes' con 'count' mallas vacas, recicladas si las hay
+	void acquire(std::vector<Mesh>& meshes, size_t count);
+	// Devuelve las mallas con su capacidad; 'meshes' queda vaco
+	void release(std::vector<Mesh>& meshes);
+
+	size_t getRetainedBytes();
+	uint64_t getReused();
+	uint64_t getCreated();
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "GreedyMesher.h"
+
+// Pasada opcional tras mallar: reordena los tringulos para la cach de vrtices
+// post-transform (Tipsify) y para el overdraw (grupos que miran hacia fuera
+// primero), y los vrtices por orden de primer uso. Los rangos opaco y
+// translcido de Mesh se ordenan cada uno por su lado. Una instancia por hilo.
+//
+// Las mallas de quads (greedy, cuboides) se dejan como estn: no comparten
+// vrtices entre quads y se dibujan con el EBO compartido de ndices fijos, as
+// que su ACMR ya es 2 y no hay nada que reordenar. Solo surface nets comparte
+// vrtices y se beneficia de la pasada.
+class MeshOptimizer {
+public:
+	static const int kCacheSize = 16;
+
+	struct Cluster {
+		uint32_t begin, end;
+		float sortKey;
+	};
+
+private:
+	// Tipsify: tringulos por vrtice, vida restante y sello de cach
+	std::vector<uint32_t> adjacencyOffset;
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> live;
+	std::vector<uint32_t> cacheStamp;
+	std::vector<uint8_t> emitted;
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> output;
+	std::vector<uint32_t> remap;
+	std::vector<uint32_t> original;
+
+	std::vector<uint32_t> candidates;
+	// Overdraw: grupos de tringulos con su clave de orden
+	std::vector<Cluster> clusters;
+	std::vector<Vertex> sortedVertices;
+
+	// acmr() sin reservar memoria (usa cacheStamp)
+	float cacheMissRatio(const uint32_t* indices, size_t count, size_t vertexCount);
+	void tipsify(uint32_t* indices, size_t count, size_t vertexCount);
+	void sortForOverdraw(const std::vector<Vertex>& vertices, uint32_t* indices, size_t count);
+	void remapVertices(Mesh& mesh);
+
+public:
+	// Vrtices transformados por tringulo con una cach FIFO de 'cacheSize' entradas
+	static float acmr(const uint32_t* indices, size_t count, size_t vertexCount, int cacheSize = kCacheSize);
+
+	void optimize(Mesh& mesh);
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef MORTON_LAYOUT_H
+#define MORTON_LAYOUT_H
+
+#include <cstdint>
+
+// Orden de los 32^3 voxels de un chunk dentro de voxelData
+enum class ChunkLayout {
+	Linear,  // x ms rpido, luego y, luego z
+	Morton   // Curva Z: bits de x, y, z entrelazados
+};
+
+// Curva Z de un chunk de 32^3: el bit i de x, y, z va a los bits 3i, 3i + 1 y 3i + 2
+// del ndice. Los vecinos en y, z quedan cerca y cada bloque 2x2x2 alineado ocupa
+// 8 bytes seguidos (4x4x4: 64 bytes, una lnea de cach).
+class MortonLayout {
+public:
+	static const uint16_t spread[32];  // Bits de 0..31 separados dos huecos
+
+	static int index(int x, int y, int z) {
+		return spread[x] | spread[y] << 1 | spread[z] << 2;
+	}
+
+	// Conversin de un chunk completo (32^3 bytes) por bloques de 2x2x2
+	static void fromLinear(const uint8_t* linear, uint8_t* morton);
+	static void toLinear(const uint8_t* morton, uint8_t* linear);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Evento de profiling. 'name' debe ser un literal (no se copia).
+struct ProfileEvent {
+	const char* name;
+	uint64_t startNs;
+	uint64_t durationNs;
+};
+
+struct FrameStats {
+	float avgMs = 0.0f;
+	float p50Ms = 0.0f;
+	float p95Ms = 0.0f;
+	float p99Ms = 0.0f;
+	float maxMs = 0.0f;
+	int samples = 0;
+};
+
+// Profiler de CPU con un ring buffer por hilo. Escribir un evento no toma
+// ningn lock; solo el registro de un hilo nuevo y la exportacin lo hacen.
+class Profiler {
+public:
+	static const int kEventsPerThread = 16384;
+	static const int kFrameHistory = 512;
+	// Track sinttico para los tiempos de GPU en la traza
+	static const uint32_t kGpuTrack = 0xFFFF;
+
+	struct ThreadBuffer {
+		uint32_t threadId = 0;
+		std::string threadName;
+		std::vector<ProfileEvent> events;
+		std::atomic<uint64_t> writeIndex{ 0 };
+	};
+
+private:
+	std::mutex registryMutex;
+	std::vector<ThreadBuffer*> threads;
+	std::atomic<bool> enabled{ true };
+	uint64_t epochNs;
+
+	// Historial circular de duraciones de frame
+	float frameTimes[kFrameHistory];
+	int frameCount = 0;
+	int frameHead = 0;
+	uint64_t frameStartNs = 0;
+
+	ThreadBuffer gpuBuffer;
+
+	Profiler();
+	ThreadBuffer* threadBuffer();
+	static void push(ThreadBuffer* buffer, const char* name, uint64_t startNs, uint64_t durationNs);
+
+public:
+	~Profiler();
+	static Profiler& get();
+	static uint64_t nowNs();
+
+	void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// Nombre del hilo actual en la traza ("main", "worker 3", ...)
+	void setThreadName(const std::string& name);
+
+	void record(const char* name, uint64_t startNs, uint64_t endNs);
+	void recordGpu(const char* name, uint64_t startNs, uint64_t durationNs);
+
+	// Delimitan un frame del hilo principal
+	void beginFrame();
+	void endFrame();
+	FrameStats getFrameStats() const;
+
+	// Exporta los eventos en formato Chrome trace_event (chrome://tracing, Perfetto)
+	bool exportChromeTrace(const std::string& path);
+	void clear();
+};
+
+// Temporizador de mbito: registra su duracin al destruirse
+class ProfileScope {
+private:
+	const char* name;
+	uint64_t startNs;
+
+public:
+	explicit ProfileScope(const char* scopeName)
+		: name(scopeName), startNs(Profiler::get().isEnabled() ? Profiler::nowNs() : 0) {}
+	~ProfileScope() {
+		if (startNs != 0) Profiler::get().record(name, startNs, Profiler::nowNs());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifndef VOXELGL_NO_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif
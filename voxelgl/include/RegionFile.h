@@ -0,0 +1,136 @@
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_map>
+#include <map>
+#include <cstdio>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "MappedFile.h"
+
+// Entrada de la tabla de offsets: payload comprimido dentro del fichero
+struct RegionEntry {
+	uint32_t offset;
+	uint32_t size;
+};
+
+// Fichero de regin: 32x32x32 chunks. Cabecera con tabla de offsets y
+// payloads comprimidos. Un payload nuevo nunca pisa al que sustituye: va a un
+// hueco libre o al final, y el hueco anterior se libera al apuntar la tabla.
+// Lecturas por mmap desde cualquier hilo; escrituras solo desde un hilo.
+class RegionFile {
+public:
+	static const int kRegionSize = 32;  // Chunks por eje
+	static const int kEntries = kRegionSize * kRegionSize * kRegionSize;
+	static const uint32_t kMagic = 0x47525856;  // "VXRG"
+	static const uint32_t kVersion = 1;
+	static const int kTableOffset = 16;
+	static const int kHeaderSize = kTableOffset + kEntries * (int)sizeof(RegionEntry);
+
+	enum Codec : uint8_t { CodecRaw = 0, CodecRLE = 1 };
+
+private:
+	std::string path;
+	std::mutex mutex;
+	std::vector<RegionEntry> table;
+	MappedFile map;
+	FILE* writer = nullptr;
+	uint64_t fileSize = 0;
+
+	// Huecos sin referenciar desde la tabla (offset -> bytes), solo del hilo escritor
+	std::map<uint64_t, uint64_t> freeExtents;
+
+	void rebuildFreeExtents();
+	// Primer hueco donde cabe 'size'; si no hay, al final ('end' avanza)
+	uint64_t allocate(uint32_t size, uint64_t& end);
+	void release(uint64_t offset, uint64_t size);
+
+public:
+	~RegionFile();
+
+	bool open(const std::string& filePath, bool create);
+
+	// Thread-safe: descomprime el chunk si est guardado y tiene expectedSize voxels (0: cualquiera)
+	bool read(int localIndex, std::vector<uint8_t>& voxels, size_t expectedSize);
+	bool contains(int localIndex);
+
+	// Solo desde el hilo escritor: guarda payloads y actualiza la tabla, con fsync
+	// de ambos. Falla si no se pudo escribir o no cabe en offsets de 32 bits.
+	bool append(const std::vector<std::pair<int, std::vector<uint8_t>>>& payloads);
+
+	uint64_t getFileSize() const { return fileSize; }
+	uint64_t getFreeBytes() const;
+
+	static int localIndex(const glm::ivec3& chunkPos);
+	static glm::ivec3 regionOf(const glm::ivec3& chunkPos);
+
+	// Payload: [uint32 tamao sin comprimir][uint8 codec][datos]
+	static void encode(const uint8_t* voxels, size_t count, std::vector<uint8_t>& out);
+	// Rechaza el payload si expectedSize no es 0 y no coincide con su tamao
+	static bool decode(const uint8_t* data, size_t size, std::vector<uint8_t>& voxels, size_t expectedSize = 0);
+};
+
+// Conjunto de regiones de un mundo con escritor asncrono en segundo plano.
+// Guardar copia los voxels y vuelve enseguida; el disco nunca bloquea el frame.
+class RegionStore {
+private:
+	struct PendingSave {
+		std::shared_ptr<std::vector<uint8_t>> voxels;
+		bool queued = false;
+		bool failed = false;  // La escritura fall: se conserva hasta reintentarla
+	};
+
+	std::string directory;
+
+	std::mutex regionsMutex;
+	std::unordered_map<uint64_t, std::unique_ptr<RegionFile>> regions;
+
+	std::mutex queueMutex;
+	std::condition_variable queueCv;
+	std::condition_variable idleCv;
+	std::vector<uint64_t> queue;
+	std::unordered_map<uint64_t, PendingSave> pending;
+	bool writing = false;
+	bool stopping = false;
+	std::thread writerThread;
+
+	std::atomic<uint64_t> chunksSaved{ 0 };
+	std::atomic<uint64_t> chunksLoaded{ 0 };
+	std::atomic<uint64_t> bytesWritten{ 0 };
+	std::atomic<uint64_t> saveErrors{ 0 };
+
+	RegionFile* getRegion(const glm::ivec3& regionPos, bool create);
+	void writerLoop();
+
+public:
+	explicit RegionStore(const std::string& worldDirectory);
+	~RegionStore();
+
+	// Falla si el chunk no est guardado o no tiene expectedSize voxels (0: cualquiera)
+	bool loadChunk(const glm::ivec3& chunkPos, std::vector<uint8_t>& voxels, size_t expectedSize);
+	void saveChunkAsync(const glm::ivec3& chunkPos, const std::vector<uint8_t>& voxels);
+
+	// Reencola los guardados fallidos y espera a que la cola se vace.
+	// Devuelve false si alguno sigue sin poder escribirse.
+	bool flush();
+
+	std::string regionPath(const glm::ivec3& regionPos) const;
+	const std::string& getDirectory() const { return directory; }
+
+	static uint64_t packKey(const glm::ivec3& pos);
+	static glm::ivec3 unpackKey(uint64_t key);
+
+	uint64_t getChunksSaved() const { return chunksSaved.load(); }
+	uint64_t getChunksLoaded() const { return chunksLoaded.load(); }
+	uint64_t getBytesWritten() const { return bytesWritten.load(); }
+	uint64_t getSaveErrors() const { return saveErrors.load(); }
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SURFACE_NETS_H
+#define SURFACE_NETS_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "GreedyMesher.h"
+#include "LodDownsampler.h"
+
+// Mallado suave por surface nets (naive) sobre la ocupacin del chunk: un vrtice
+// por celda de 2x2x2 voxels con slido y aire, en la media de los cruces de sus
+// aristas, y un quad por arista de voxel a voxel que cambia de slido a aire.
+// Todo material no nulo cuenta como slido (sin translcidos).
+//
+// Las celdas se clasifican por filas: la ocupacin de cada fila de X es un
+// uint64_t y las 4 filas que forman una fila de celdas se combinan con
+// operaciones de bits (hasta 62 voxels de ancho). Misma salida que
+// GreedyMesher (Mesh/Vertex, espacio del chunk); una instancia por hilo.
+class SurfaceNets {
+private:
+	// Ocupacin con borde de aire: bit x + 1 de la fila (y + 1, z + 1)
+	std::vector<uint64_t> rows;
+	// Materiales con borde (mismo ndice que la luz de greedyFaceMesh)
+	std::vector<uint8_t> paddedVoxels;
+	// Vrtice de cada celda (solo vlido en las que cruzan la superficie)
+	std::vector<uint32_t> cellVertex;
+	std::vector<uint8_t> coarse;
+	LodDownsampler downsampler;
+
+	// Reduce a 1/factor por eje: slido si lo es al menos la mitad del bloque,
+	// con su material mayoritario
+	void downsample(const uint8_t* voxels, const glm::ivec3& size, int factor);
+
+public:
+	// 'light' como en GreedyMesher::greedyFaceMesh (null: plena luz de cielo); en
+	// LOD > 0 no se usa. El LOD muestrea cada 2^lodLevel voxels.
+	Mesh generate(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, int lodLevel = 0);
+	// Igual, en 'mesh' (se vaca y se reutiliza su capacidad)
+	void generate(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, int lodLevel, Mesh& mesh);
+};
+
+#endif
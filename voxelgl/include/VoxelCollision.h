@@ -0,0 +1,88 @@
+#ifndef VOXEL_COLLISION_H
+#define VOXEL_COLLISION_H
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "GreedyMesher.h"
+
+class VoxelWorld;
+struct Chunk;
+
+// Caja alineada a los ejes en el espacio de las mallas (el voxel v ocupa
+// [v - 0.5, v + 0.5])
+struct AABB {
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct MoveQuery {
+	AABB box;
+	glm::vec3 delta;  // Desplazamiento deseado en este tick
+};
+
+struct MoveResult {
+	AABB box;                           // Caja tras resolver las colisiones
+	glm::vec3 delta = glm::vec3(0.0f);  // Desplazamiento aplicado
+	glm::ivec3 blocked = glm::ivec3(0); // Por eje: signo del movimiento bloqueado
+	bool onGround = false;              // Bloqueado hacia -Y
+};
+
+// Colisiones de cajas contra el mundo. Los slidos de cada chunk se reducen a
+// los cuboides de GreedyMesher::greedy3DBinary (cacheados por revisin del
+// chunk), as que cada consulta prueba unas pocas cajas en vez de voxels.
+// Los chunks sin generar bloquean por completo; fuera del mundo no hay nada.
+class VoxelCollision {
+public:
+	// Separacin que se deja al chocar, para poder deslizar por la superficie
+	static const float kContactGap;
+
+private:
+	struct ChunkColliders {
+		uint32_t revision = 0;
+		std::vector<AABB> boxes;
+	};
+
+	VoxelWorld* world;
+	std::unordered_map<uint32_t, std::unique_ptr<ChunkColliders>> cache;
+	GreedyMesher mesher;
+
+	static void buildColliders(const Chunk* chunk, int chunkSize, GreedyMesher& mesher, ChunkColliders& out);
+	// Cuboides del chunk; con 'build' los crea o refresca (solo desde un hilo).
+	// Sin generar: una caja que lo cubre entero, escrita en 'unloaded'.
+	const std::vector<AABB>* colliders(const glm::ivec3& coord, bool build, std::vector<AABB>& unloaded);
+	// Llama a visit(caja) con cada slido que toca 'bounds'
+	template<typename Visit>
+	void forEachBox(const AABB& bounds, bool build, Visit visit);
+
+	float sweep(const AABB& box, const glm::vec3& delta, bool build, int& axis);
+	MoveResult resolveMove(const AABB& box, const glm::vec3& delta, bool build);
+	// Refresca en paralelo la cach de todos los chunks que tocan 'bounds'
+	void prepare(const std::vector<AABB>& bounds);
+
+public:
+	explicit VoxelCollision(VoxelWorld* world);
+	~VoxelCollision();
+
+	// Fraccin [0, 1] de 'delta' que la caja recorre antes de tocar un slido.
+	// 'normal' recibe la cara del slido tocada (cero si no hay choque).
+	float sweep(const AABB& box, const glm::vec3& delta, glm::vec3& normal);
+	// Mueve la caja deslizando por las superficies (hasta tres choques)
+	MoveResult move(const AABB& box, const glm::vec3& delta);
+	// Lee la ocupacin de los chunks directamente: no necesita cuboides
+	bool overlaps(const AABB& box);
+	// Cajas slidas que solapan 'box'; devuelve cuntas
+	int queryBoxes(const AABB& box, std::vector<AABB>& out);
+
+	// Resuelve todas las consultas repartidas entre los workers (hilo principal;
+	// bloquea hasta terminar). results[i] corresponde a queries[i].
+	void moveBatch(const std::vector<MoveQuery>& queries, std::vector<MoveResult>& results);
+
+	// Olvida los cuboides cacheados (p. ej. tras recargar el mundo)
+	void clear() { cache.clear(); }
+	size_t getCachedChunks() const { return cache.size(); }
+};
+
+#endif
@@ -5,55 +5,411 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "GreedyMesher.h"
+#include "JobSystem.h"
+#include "MeshArena.h"
+#include "MortonLayout.h"
 
 class OpenCLHelper;
 class GLShader;
+class RegionStore;
+class EditJournal;
+class LightEngine;
+
+// Mallador de los chunks
+enum class MeshingMode {
+	Blocky,  // GreedyMesher: caras por voxel (LOD 0 por secciones), cuboides en los LOD lejanos
+	Smooth   // SurfaceNets: superficie suave en todos los LOD, sin remallado por secciones
+};
+
+// Hueco de una seccin de malla dentro de los buffers de su ChunkMesh (en vrtices
+// e ndices). Los ndices son locales a la seccin: se dibuja con base de vrtice.
+struct MeshSection {
+	int vertexOffset = 0;
+	int vertexCapacity = 0;
+	int vertexCount = 0;
+	int indexOffset = 0;
+	int indexCapacity = 0;
+	int indexCount = 0;
+	int translucentIndexCount = 0;  // Las ltimas de indexCount (ver Mesh)
+};
+
+// Malla en GPU. La comparten todos los chunks con el mismo contenido y LOD, hasta
+// que una edicin remalla solo algunas de sus secciones (entonces es del chunk).
+struct ChunkMesh {
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	GLuint ebo = 0;
+	int vertexCount = 0;
+	int indexCount = 0;
+	int translucentIndexCount = 0;
+	// Una seccin por Chunk::kSectionSize^3 en LOD 0; una sola en los LOD lejanos
+	std::vector<MeshSection> sections;
+	int vertexCapacity = 0;
+	int indexCapacity = 0;
+	// Bytes por ndice en el EBO: 2 si ninguna seccin pasa de 65535 vrtices
+	int indexSize = 4;
+	// Malla de quads sin EBO propio: el VAO usa el EBO de quads del mundo
+	bool sharedQuadIndices = false;
+
+	uint64_t cacheKey = 0;
+	uint64_t contentHash = 0;
+	int lodLevel = 0;
+	MeshingMode mode = MeshingMode::Blocky;
+	int lightValue = -1;  // Luz uniforme con la que se horne (-1: sin luz)
+	// Contenido con el que se hizo, para descartar colisiones de hash; en LOD 0 por
+	// caras, con el borde de los vecinos (null: uniforme sin borde)
+	std::shared_ptr<const std::vector<uint8_t>> voxels;
+	bool ready = false;   // Subida a GPU
+	bool failed = false;  // El mallado se cancel antes de subirla
+	JobHandle uploadJob;
+
+	~ChunkMesh();
+};
+
+enum class ChunkContent {
+	Mixed,    // voxelData completo
+	Empty,    // Todo aire: sin voxelData, sin malla
+	Uniform   // Todo uniformValue: sin voxelData, malla compartida
+};
 
 struct Chunk {
 	uint32_t id;
 	glm::ivec3 position;  // En unidades de chunk
 	int lodLevel;         // 0 = mximo detalle
-	GLuint vao = 0;
-	GLuint vbo = 0;
+	std::shared_ptr<ChunkMesh> mesh;
 	int vertexCount = 0;
+	int indexCount = 0;
 	bool needsUpdate = true;
+	// Secciones de malla con cambios desde el ltimo mallado (bit por seccin)
+	uint8_t dirtySections = kAllSections;
 	bool isVisible = true;
-	std::vector<uint8_t> voxelData;  // 32x32x32 voxels
+	bool modified = false;  // Editado desde la ltima vez que se guard
+	bool prefetched = false;  // Encolado por el prefetcher antes de estar en distancia
+	bool seen = false;        // Ya entr en vista desde que est en distancia
+	uint32_t revision = 0;    // Cambia con cada edicin (para cachs derivadas)
+	std::vector<uint8_t> voxelData;  // 32x32x32 voxels (vaco si no es Mixed)
+	ChunkLayout layout = ChunkLayout::Linear;  // Orden de voxelData
+	ChunkContent content = ChunkContent::Mixed;
+	uint8_t uniformValue = 0;
+	// Bit por ladrillo de 8x8x8 con algn voxel slido (conservador: solo se pone)
+	uint64_t brickMask = ~0ull;
+	// Ocupacin exacta: bit x de la palabra z * 32 + y si el voxel es slido. Va a la
+	// par que voxelData (vaco si no es Mixed) y responde 32 voxels por operacin.
+	std::vector<uint32_t> occupancy;
 	float distanceToCamera = 0.0f;
 
+	// Luz (LightEngine, bajo VoxelWorld::voxelMutex): cielo en el nibble alto,
+	// bloque en el bajo. Vaco: todo el chunk vale uniformLight.
+	std::vector<uint8_t> light;
+	uint8_t uniformLight = 0;
+	bool lightTouched = false;              // Ya anotado en el lote de luz en curso
+	uint32_t lightBorderMask = 0;           // Vecinos (3x3x3) cuyo borde cambi en el lote
+	uint8_t lightSections = 0;              // Secciones con luz cambiada en el lote
+	std::atomic<bool> lit{ false };         // Luz inicializada: ya se puede mallar
+	std::atomic<uint8_t> lightDirty{ 0 };   // Secciones con luz cambiada desde el ltimo mallado
+
+	// Pipeline de jobs: generar -> mallar (worker) -> subir (hilo GL)
+	std::atomic<bool> generated{ false };
+	// Cada job guarda la poca con la que se encol; si cambia, sale sin trabajar
+	std::atomic<uint32_t> jobEpoch{ 0 };
+	JobHandle generateJob;
+	JobHandle meshJob;    // Mallado en un worker
+	JobHandle uploadJob;  // Subida en el hilo GL
+
 	Chunk(glm::ivec3 pos, int lod = 0) : position(pos), lodLevel(lod) {
 		id = (pos.x << 20) | (pos.y << 10) | pos.z;
 		voxelData.resize(32 * 32 * 32, 0);
+		occupancy.resize(32 * 32, 0);
 	}
 
 	uint8_t getVoxel(int x, int y, int z) const {
 		if (x < 0 || x >= 32 || y < 0 || y >= 32 || z < 0 || z >= 32)
 			return 0;
-		return voxelData[z * 32 * 32 + y * 32 + x];
+		if (voxelData.empty()) return uniformValue;
+		return voxelData[voxelIndex(x, y, z)];
 	}
 
 	void setVoxel(int x, int y, int z, uint8_t value) {
 		if (x < 0 || x >= 32 || y < 0 || y >= 32 || z < 0 || z >= 32)
 			return;
-		voxelData[z * 32 * 32 + y * 32 + x] = value;
+		if (voxelData.empty()) {
+			if (value == uniformValue) return;
+			materialize();
+		}
+		voxelData[voxelIndex(x, y, z)] = value;
+		if (value != 0) {
+			brickMask |= 1ull << brickIndex(x, y, z);
+			occupancy[z * 32 + y] |= 1u << x;
+		} else {
+			occupancy[z * 32 + y] &= ~(1u << x);
+		}
+		revision++;
 		needsUpdate = true;
+		dirtySections |= sectionsAround(glm::ivec3(x, y, z), glm::ivec3(x, y, z));
+		modified = true;
+	}
+
+	// Posicin en voxelData del voxel (x, y, z), o del de ndice lineal 'index'
+	// (el de light y de las copias)
+	int voxelIndex(int x, int y, int z) const {
+		if (layout == ChunkLayout::Morton) return MortonLayout::index(x, y, z);
+		return (z * 32 + y) * 32 + x;
+	}
+	int voxelIndex(int index) const {
+		if (layout == ChunkLayout::Morton) return MortonLayout::index(index & 31, (index >> 5) & 31, index >> 10);
+		return index;
+	}
+
+	uint8_t getLight(int index) const {
+		return light.empty() ? uniformLight : light[index];
+	}
+
+	void setLight(int index, uint8_t value) {
+		if (light.empty()) {
+			if (value == uniformLight) return;
+			light.assign(32 * 32 * 32, uniformLight);
+		}
+		light[index] = value;
+	}
+
+	// Secciones de malla de 16^3: 2x2x2 por chunk, x ms rpido
+	static const int kSectionSize = 16;
+	static const uint8_t kAllSections = 0xFF;
+
+	// Secciones cuyas caras leen algn voxel de [lo, hi]. Un voxel de margen:
+	// la visibilidad, la AO y la luz de una cara miran a los vecinos.
+	static uint8_t sectionsAround(const glm::ivec3& lo, const glm::ivec3& hi) {
+		glm::ivec3 first = glm::max(lo - 1, glm::ivec3(0)) / kSectionSize;
+		glm::ivec3 last = glm::min(hi + 1, glm::ivec3(31)) / kSectionSize;
+		uint8_t mask = 0;
+		for (int z = first.z; z <= last.z; z++) {
+			for (int y = first.y; y <= last.y; y++) {
+				for (int x = first.x; x <= last.x; x++) mask |= 1 << ((z * 2 + y) * 2 + x);
+			}
+		}
+		return mask;
+	}
+	// Secciones pegadas al lado 'side' del chunk (-1, 0 o 1 por eje; 0: cualquiera)
+	static uint8_t sectionsFacing(const glm::ivec3& side) {
+		glm::ivec3 lo = glm::ivec3(side.x > 0, side.y > 0, side.z > 0) * 31;
+		glm::ivec3 hi = glm::ivec3(side.x >= 0, side.y >= 0, side.z >= 0) * 31;
+		return sectionsAround(lo, hi);
+	}
+
+	static int brickIndex(int x, int y, int z) {
+		return ((z >> 3) * 4 + (y >> 3)) * 4 + (x >> 3);
+	}
+	bool isBrickEmpty(int x, int y, int z) const {
+		return (brickMask & (1ull << brickIndex(x, y, z))) == 0;
+	}
+
+	// Bits [x0, x1] de una fila
+	static uint32_t spanMask(int x0, int x1) {
+		return (~0u >> (31 - x1)) & (~0u << x0);
+	}
+	uint32_t occupancyRow(int y, int z) const {
+		if (occupancy.empty()) return uniformValue != 0 ? ~0u : 0u;
+		return occupancy[z * 32 + y];
 	}
+	bool isSolid(int x, int y, int z) const {
+		if (x < 0 || x >= 32 || y < 0 || y >= 32 || z < 0 || z >= 32)
+			return false;
+		return (occupancyRow(y, z) >> x & 1u) != 0;
+	}
+	// Bits de ocupacin de la fila (y, z) ledos de voxelData
+	uint32_t solidBits(int y, int z) const {
+		uint32_t bits = 0;
+		if (layout == ChunkLayout::Morton) {
+			const uint8_t* data = voxelData.data() + (MortonLayout::spread[y] << 1 | MortonLayout::spread[z] << 2);
+			for (int x = 0; x < 32; x++) bits |= (uint32_t)(data[MortonLayout::spread[x]] != 0) << x;
+		} else {
+			const uint8_t* row = &voxelData[(z * 32 + y) * 32];
+			for (int x = 0; x < 32; x++) bits |= (uint32_t)(row[x] != 0) << x;
+		}
+		return bits;
+	}
+	// Rehace los bits [x, x + count) de la fila (y, z) tras escribir en voxelData
+	void updateOccupancy(int y, int z, int x, int count) {
+		uint32_t span = spanMask(x, x + count - 1);
+		uint32_t& word = occupancy[z * 32 + y];
+		word = (word & ~span) | (solidBits(y, z) & span);
+	}
+	// Algn slido en la caja local [lo, hi] (no vaca, dentro del chunk)
+	bool anySolid(const glm::ivec3& lo, const glm::ivec3& hi) const;
+	int solidCount() const;
+
+	enum class OccupancyOp { And, Or, AndNot, Xor };
+	// Ocupacin de 'a' op 'b' fila a fila en 'out' (32 * 32 palabras). Devuelve
+	// cuntos voxels quedan a 1.
+	static int combineOccupancy(const Chunk& a, const Chunk& b, OccupancyOp op, uint32_t* out);
+
+	// Tras generar: un chunk de un solo valor suelta su voxelData
+	void classify() {
+		uint8_t first = voxelData.empty() ? uniformValue : voxelData[0];
+		bool mixed = false;
+		for (uint8_t v : voxelData) {
+			if (v != first) {
+				mixed = true;
+				break;
+			}
+		}
+		if (mixed) {
+			// Ocupacin por filas y ladrillos a partir de ella
+			content = ChunkContent::Mixed;
+			occupancy.resize(32 * 32);
+			brickMask = 0;
+			for (int z = 0; z < 32; z++) {
+				for (int y = 0; y < 32; y++) {
+					uint32_t bits = solidBits(y, z);
+					occupancy[z * 32 + y] = bits;
+					for (int bx = 0; bx < 4; bx++) {
+						if ((bits >> (bx * 8)) & 0xFF) brickMask |= 1ull << brickIndex(bx * 8, y, z);
+					}
+				}
+			}
+			return;
+		}
+		content = first == 0 ? ChunkContent::Empty : ChunkContent::Uniform;
+		uniformValue = first;
+		brickMask = first == 0 ? 0 : ~0ull;
+		std::vector<uint8_t>().swap(voxelData);
+		std::vector<uint32_t>().swap(occupancy);
+	}
+
+	// Vuelve a la representacin completa (antes de editar)
+	void materialize() {
+		if (!voxelData.empty()) return;
+		voxelData.assign(32 * 32 * 32, uniformValue);
+		occupancy.assign(32 * 32, uniformValue != 0 ? ~0u : 0u);
+		content = ChunkContent::Mixed;
+		brickMask = uniformValue == 0 ? 0 : ~0ull;
+	}
+
+	// Copia en orden lineal
+	void copyVoxels(std::vector<uint8_t>& out) const {
+		if (voxelData.empty()) out.assign(32 * 32 * 32, uniformValue);
+		else if (layout == ChunkLayout::Linear) out = voxelData;
+		else {
+			out.resize(32 * 32 * 32);
+			MortonLayout::toLinear(voxelData.data(), out.data());
+		}
+	}
+	// Voxels en orden lineal: voxelData o su copia en 'scratch' (tambin si es uniforme)
+	const std::vector<uint8_t>& linearVoxels(std::vector<uint8_t>& scratch) const {
+		if (!voxelData.empty() && layout == ChunkLayout::Linear) return voxelData;
+		copyVoxels(scratch);
+		return scratch;
+	}
+
+	// Reordena voxelData (el resto del chunk no depende del orden)
+	void setLayout(ChunkLayout newLayout) {
+		if (newLayout == layout) return;
+		if (!voxelData.empty()) {
+			std::vector<uint8_t> converted(voxelData.size());
+			if (newLayout == ChunkLayout::Morton) MortonLayout::fromLinear(voxelData.data(), converted.data());
+			else MortonLayout::toLinear(voxelData.data(), converted.data());
+			voxelData.swap(converted);
+		}
+		layout = newLayout;
+	}
+};
+
+// Volumen de voxels copiado del mundo (x ms rpido, luego y, luego z)
+struct VoxelVolume {
+	glm::ivec3 size = glm::ivec3(0);
+	std::vector<uint8_t> voxels;
+
+	uint8_t get(int x, int y, int z) const { return voxels[(z * size.y + y) * size.x + x]; }
+};
+
+// Resultado de un raycast. 'normal' es la cara por la que entr el rayo
+// (cero si el origen ya estaba dentro de un voxel slido).
+struct RaycastHit {
+	bool hit = false;
+	glm::ivec3 voxel = glm::ivec3(0);  // Coordenadas de mundo
+	glm::ivec3 normal = glm::ivec3(0);
+	float distance = 0.0f;
+	uint8_t value = 0;
+};
+
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;  // No hace falta normalizarla
+	float maxDistance;
+};
+
+// Aciertos del prefetcher, contados cuando un chunk entra en vista
+struct PrefetchStats {
+	uint64_t requested = 0;  // Jobs especulativos encolados
+	uint64_t hits = 0;       // Prefetch con la malla lista al entrar en vista
+	uint64_t late = 0;       // Prefetch an en curso al entrar en vista
+	uint64_t misses = 0;     // Sin prefetch y sin malla al entrar en vista (pop-in)
+	uint64_t wasted = 0;     // Prefetch que sali de la trayectoria sin verse
 };
 
 class VoxelWorld {
+	friend class LightEngine;
+
 private:
 	std::unordered_map<uint32_t, std::unique_ptr<Chunk>> chunks;
 	std::unique_ptr<GreedyMesher> mesher;
 	OpenCLHelper* clHelper = nullptr;
+	std::unique_ptr<RegionStore> regionStore;
+	// Declarado despus del store: su hilo puede esperar al store al destruirse
+	std::unique_ptr<EditJournal> journal;
+	// Mallas de los jobs de mallado; antes que 'jobs': los jobs le devuelven las suyas
+	MeshArena meshArena;
+	std::unique_ptr<JobSystem> jobs;
+	// Su job usa 'jobs' y los chunks: se para antes que ambos
+	std::unique_ptr<LightEngine> light;
+	// Protege voxelData y la luz de los chunks generados, y la insercin en
+	// 'chunks', frente al job de luz. El hilo principal lo toma al editar.
+	std::mutex voxelMutex;
+	// El hilo principal espera voxelMutex: el job de luz lo suelta en su prximo tramo
+	std::atomic<bool> voxelLockWanted{ false };
+	// voxelMutex para el hilo principal, sin esperar a que acabe el lote de luz
+	std::unique_lock<std::mutex> lockVoxels();
 
-	int worldWidth, worldHeight, worldDepth;
+	int worldWidth, worldHeight, worldDepth;  // En chunks
+	uint32_t seed = 1337;
 	int chunkSize = 32;
 	int renderDistance = 8;  // En chunks
 	int maxLOD = 3;
+	MeshingMode meshingMode = MeshingMode::Blocky;
+	bool meshOptimization = true;  // Reordenar las mallas de surface nets para la cach de vrtices y el overdraw
+	ChunkLayout chunkLayout = ChunkLayout::Linear;  // Orden de voxelData en los chunks generados
+
+	// Prioridad de los jobs: distancia a la posicin prevista de la cmara
+	glm::vec3 cameraVelocity = glm::vec3(0.0f);
+	float priorityLookahead = 0.5f;  // Segundos
+	std::atomic<uint64_t> cancelledJobs{ 0 };
+
+	// Mallas por contenido: hash de voxels (o valor uniforme) y LOD -> malla en GPU
+	std::unordered_map<uint64_t, std::weak_ptr<ChunkMesh>> meshCache;
+	uint64_t meshCacheHits = 0;
+	uint64_t meshCacheMisses = 0;
+	uint64_t partialRemeshes = 0;   // Remallados de solo algunas secciones
+	uint64_t sectionRelayouts = 0;  // Subidas que no cupieron en sus huecos
+
+	// Prefetch a lo largo de la trayectoria extrapolada
+	int prefetchBudget = 16;        // Jobs especulativos nuevos por frame (0: desactivado)
+	int maxSpeculativeJobs = 64;    // Chunks especulativos en vuelo a la vez
+	float prefetchHorizon = 1.5f;   // Segundos
+	PrefetchStats prefetchStats;
+
+	// EBO de 16 bits con { 0, 1, 2, 0, 2, 3 } + 4q para kSharedQuads quads: lo usan
+	// todas las mallas de quads con secciones de hasta 4 * kSharedQuads vrtices
+	static const int kSharedQuads = 16384;
+	GLuint quadIndexBuffer = 0;
+	GLuint getQuadIndexBuffer();
 
 	// Estadsticas
 	int totalChunks = 0;
@@ -62,13 +418,50 @@ private:
 
 	// Generacin de terreno
 	void generateChunkTerrain(Chunk* chunk);
+	// Carga de disco si el chunk est guardado; si no, genera
+	void loadOrGenerateChunk(Chunk* chunk);
 	float noise3D(float x, float y, float z);
+	// Encola la generacin del chunk si an no est generado ni en curso
+	void requestGeneration(Chunk* chunk, float priority);
+	// Crea el chunk y espera (o hace) su generacin; para ediciones
+	Chunk* ensureGenerated(int cx, int cy, int cz);
+	// Aplica al mundo las ediciones que no llegaron a las regiones
+	void recoverJournal();
+	// Vuelca los chunks modificados a las regiones y rota el journal
+	void compactJournal();
+
+	// Brocha por filas: 'row' son 'count' voxels desde 'start' (mundo) a lo largo de X
+	typedef std::function<void(const glm::ivec3& start, int count, uint8_t* row)> RowBrush;
+	// Aplica la brocha a [min, max] chunk a chunk; devuelve los voxels cambiados
+	int editRegion(glm::ivec3 min, glm::ivec3 max, const RowBrush& brush);
 
 	// Gestin de chunks
-	void updateChunkMesh(Chunk* chunk);
-	void uploadChunkToGPU(Chunk* chunk, const std::vector<Vertex>& vertices);
+	Chunk* findChunk(const glm::ivec3& pos) const;
+	void scheduleChunkMesh(Chunk* chunk);
+	// Encola la generacin de los 26 vecinos que falten y vuelve a programar el
+	// mallado cuando terminen; false si ya estn todos
+	bool waitForNeighbors(Chunk* chunk);
+	// Voxels de (chunkSize + 2)^3 en orden lineal: el chunk con un voxel de borde
+	// de sus vecinos (aire fuera del mundo o sin generar)
+	void copyPaddedVoxels(const Chunk* chunk, std::vector<uint8_t>& out) const;
+	// Tras editar [lo, hi] (local) en 'chunk': remallar las secciones de los
+	// vecinos cuyo borde lee esos voxels
+	void touchNeighbors(const Chunk* chunk, const glm::ivec3& lo, const glm::ivec3& hi);
+	// Sube las secciones de 'mask' a sus huecos; si alguna no cabe, reparte de nuevo los buffers
+	void uploadMesh(ChunkMesh* target, const std::vector<Mesh>& sections, uint32_t mask);
+	void attachMesh(Chunk* chunk, const std::shared_ptr<ChunkMesh>& mesh);
 	bool shouldUseLOD(const Chunk* chunk, const glm::vec3& cameraPos) const;
 	int calculateLODLevel(const Chunk* chunk, const glm::vec3& cameraPos) const;
+	int lodForDistance(float distInChunks) const;
+
+	float jobPriority(const Chunk* chunk, const glm::vec3& cameraPos) const;
+	// Dnde estar la cmara dentro de 'seconds' (acotado a renderDistance)
+	glm::vec3 predictCameraPos(const glm::vec3& cameraPos, float seconds) const;
+	bool isChunkAhead(const Chunk* chunk, const glm::vec3& cameraPos) const;
+	bool isChunkReady(const Chunk* chunk) const;
+	void updatePrefetchStats(const glm::vec3& cameraPos);
+	// Cancela los jobs del chunk (la poca cambia); la generacin en curso termina sola
+	void cancelChunkJobs(Chunk* chunk);
 
 	// Culling
 	bool isChunkInFrustum(const Chunk* chunk, const glm::mat4& viewProj) const;
@@ -79,24 +472,104 @@ public:
 	~VoxelWorld();
 
 	void setCLHelper(OpenCLHelper* helper) { clHelper = helper; }
+	void setSeed(uint32_t value) { seed = value; }
+	void setRenderDistance(int chunks) { renderDistance = chunks; }
+	// Velocidad de la cmara en unidades/s (para priorizar hacia donde se mueve)
+	void setCameraVelocity(const glm::vec3& velocity) { cameraVelocity = velocity; }
+	// Recrea el pool de workers (antes de generar; <= 0: uno por ncleo)
+	void setWorkerCount(int count);
+	// Luz por flood fill horneada en las mallas (activa por defecto). Al activarla
+	// con chunks ya generados, se iluminan todos desde cero.
+	void setLighting(bool enabled);
+	LightEngine* getLightEngine() { return light.get(); }
+	// Cambia el mallador y remalla todos los chunks
+	void setMeshingMode(MeshingMode mode);
+	MeshingMode getMeshingMode() const { return meshingMode; }
+	// Pasada de MeshOptimizer tras mallar con surface nets (activa por defecto; afecta a
+	// las mallas nuevas). Las mallas de quads no pasan por ella.
+	void setMeshOptimization(bool enabled) { meshOptimization = enabled; }
+	bool getMeshOptimization() const { return meshOptimization; }
+	// Orden de los voxels dentro de cada chunk (lineal por defecto). Los chunks ya
+	// generados se convierten; copias, regiones y mallas siguen en orden lineal.
+	void setChunkLayout(ChunkLayout layout);
+	ChunkLayout getChunkLayout() const { return chunkLayout; }
 
-	// Generacin del mundo
+	// Generacin del mundo completo, en paralelo (bloquea hasta terminar)
 	void generateTerrain();
+	// Encola la generacin de los chunks dentro de renderDistance; no bloquea
+	int streamChunks(const glm::vec3& cameraPos);
+
+	// Persistencia en ficheros de regin (directorio del mundo)
+	void openRegionStore(const std::string& directory);
+	void saveModifiedChunks();
+	// Compacta el journal de ediciones cuando supera su umbral o tras un fallo de
+	// escritura (una vez por frame)
+	void updatePersistence();
+	RegionStore* getRegionStore() { return regionStore.get(); }
+	EditJournal* getJournal() { return journal.get(); }
 
 	// Actualizacin
 	void updateLOD(const glm::vec3& cameraPos);
+	// Marca visibles los chunks dentro de distancia y frustum; devuelve cuntos
+	int cullChunks(const glm::vec3& cameraPos, const glm::mat4& viewProj);
+	// Recalcula prioridades y cancela los jobs de chunks fuera de distancia
+	void updateJobPriorities(const glm::vec3& cameraPos);
+	// Genera y malla de forma especulativa los chunks hacia donde va la cmara
+	int prefetchAhead(const glm::vec3& cameraPos);
+	void setPrefetch(int budgetPerFrame, float horizonSeconds) {
+		prefetchBudget = budgetPerFrame;
+		prefetchHorizon = horizonSeconds;
+	}
+	const PrefetchStats& getPrefetchStats() const { return prefetchStats; }
+	// Encola el remallado de chunks visibles pendientes (budget < 0: todos)
+	int updateMeshes(int budget = -1);
+	// Subidas a GPU y dems jobs fijados al hilo GL (budget < 0: todos)
+	int processMainThreadJobs(int budget = -1);
+	// Espera a que terminen todos los jobs del mundo
+	void finishJobs();
 
 	// Renderizado
-	void render(GLShader* shader, const glm::vec3& cameraPos);
+	void render(GLShader* shader, const glm::vec3& cameraPos, const glm::mat4& viewProj);
 
 	// Utilidades
 	Chunk* getOrCreateChunk(int cx, int cy, int cz);
+	// Chunk generado en esas coordenadas o null (sin crearlo ni esperar)
+	const Chunk* findGeneratedChunk(int cx, int cy, int cz) const;
 	uint8_t getWorldVoxel(int wx, int wy, int wz);
+	void setWorldVoxel(int wx, int wy, int wz, uint8_t value);
+
+	// Ediciones en bloque: cada chunk tocado se escribe por filas, va al journal
+	// en un solo lote y se remalla una sola vez. Lmites inclusivos; devuelven
+	// cuntos voxels cambiaron.
+	int fillBox(const glm::ivec3& min, const glm::ivec3& max, uint8_t value);
+	int fillSphere(const glm::vec3& center, float radius, uint8_t value);
+	int replaceMaterial(const glm::ivec3& min, const glm::ivec3& max, uint8_t from, uint8_t to);
+	VoxelVolume copyRegion(const glm::ivec3& min, const glm::ivec3& max);
+	// skipAir: el aire del volumen no borra lo que ya hay
+	int paste(const VoxelVolume& volume, const glm::ivec3& origin, bool skipAir = true);
+	// DDA por voxels que salta chunks vacos y ladrillos de 8x8x8 vacos, en el
+	// mismo espacio que las mallas (el voxel v ocupa [v - 0.5, v + 0.5]). Los
+	// chunks sin generar cuentan como aire. No modifica el mundo.
+	RaycastHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+	// Lanza los rayos en bloques repartidos entre los workers (hilo principal;
+	// bloquea hasta terminar). hits[i] corresponde a rays[i].
+	void raycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& hits);
+	const std::unordered_map<uint32_t, std::unique_ptr<Chunk>>& getChunks() const { return chunks; }
+	GreedyMesher* getMesher() { return mesher.get(); }
+	JobSystem* getJobSystem() { return jobs.get(); }
+	int getChunkSize() const { return chunkSize; }
+	glm::ivec3 getWorldSize() const { return glm::ivec3(worldWidth, worldHeight, worldDepth); }
 
 	// Estadsticas
 	int getTotalChunks() const { return totalChunks; }
 	int getVisibleChunks() const { return visibleChunks; }
 	int getRenderedTriangles() const { return renderedTriangles; }
+	uint64_t getCancelledJobs() const { return cancelledJobs.load(); }
+	uint64_t getMeshCacheHits() const { return meshCacheHits; }
+	uint64_t getMeshCacheMisses() const { return meshCacheMisses; }
+	uint64_t getPartialRemeshes() const { return partialRemeshes; }
+	uint64_t getSectionRelayouts() const { return sectionRelayouts; }
+	MeshArena& getMeshArena() { return meshArena; }
 };
 
 #endif
\ No newline at end of file
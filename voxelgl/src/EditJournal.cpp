@@ -0,0 +1,416 @@
+#include "EditJournal.h"
+#include "RegionFile.h"
+#include "Profiler.h"
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const uint32_t EditJournal::kBatchMagic;
+const int EditJournal::kEditBytes;
+const int EditJournal::kBatchHeaderBytes;
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+	static uint32_t table[256];
+	static bool tableReady = false;
+	if (!tableReady) {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+		tableReady = true;
+	}
+
+	uint32_t crc = 0xFFFFFFFFu;
+	for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFu;
+}
+
+static bool syncFile(FILE* file) {
+	if (fflush(file) != 0) return false;
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Renombra sustituyendo el destino si existe (std::rename no lo hace en Windows)
+static bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// Hace durables los renombrados y borrados del directorio
+static bool syncDirectory(const std::string& directory) {
+#ifdef _WIN32
+	(void)directory;  // MOVEFILE_WRITE_THROUGH ya espera al disco
+	return true;
+#else
+	int fd = ::open(directory.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	bool ok = fsync(fd) == 0;
+	::close(fd);
+	return ok;
+#endif
+}
+
+EditJournal::EditJournal(const std::string& directory) : directory(directory) {
+	activePath = directory + "/edits.wal";
+	compactingPath = directory + "/edits.compacting.wal";
+	crc32(nullptr, 0);  // Inicializar la tabla antes de que arranquen hilos
+}
+
+EditJournal::~EditJournal() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	commitCv.notify_all();
+	if (committerThread.joinable()) committerThread.join();
+	if (file) fclose(file);
+}
+
+bool EditJournal::readFile(const std::string& path, std::vector<uint8_t>& data) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) return false;
+	data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool EditJournal::writeFileAtomic(const std::string& path, const std::vector<uint8_t>& data) {
+	// Un crash deja el fichero anterior o el nuevo entero, nunca uno a medias
+	std::string tempPath = path + ".tmp";
+	FILE* out = fopen(tempPath.c_str(), "wb");
+	if (!out) return false;
+
+	bool ok = data.empty() || fwrite(data.data(), 1, data.size(), out) == data.size();
+	ok = syncFile(out) && ok;
+	ok = fclose(out) == 0 && ok;
+	if (!ok || !replaceFile(tempPath, path)) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+	return syncDirectory(directory);
+}
+
+size_t EditJournal::validPrefix(const std::vector<uint8_t>& data,
+	const std::function<void(const VoxelEdit&)>& apply) {
+	size_t pos = 0;
+	while (pos + kBatchHeaderBytes <= data.size()) {
+		uint32_t header[3];
+		memcpy(header, data.data() + pos, sizeof(header));
+
+		size_t bodyBytes = (size_t)header[1] * kEditBytes;
+		if (header[0] != kBatchMagic || pos + kBatchHeaderBytes + bodyBytes > data.size()) break;
+
+		const uint8_t* body = data.data() + pos + kBatchHeaderBytes;
+		if (crc32(body, bodyBytes) != header[2]) break;
+
+		if (apply) {
+			for (uint32_t i = 0; i < header[1]; i++) {
+				VoxelEdit edit;
+				memcpy(&edit.x, body + i * kEditBytes + 0, 4);
+				memcpy(&edit.y, body + i * kEditBytes + 4, 4);
+				memcpy(&edit.z, body + i * kEditBytes + 8, 4);
+				edit.value = body[i * kEditBytes + 12];
+				apply(edit);
+			}
+		}
+		pos += kBatchHeaderBytes + bodyBytes;
+	}
+	return pos;
+}
+
+bool EditJournal::open() {
+	// Descartar una cola cortada por un crash antes de seguir aadiendo
+	std::vector<uint8_t> data;
+	if (readFile(activePath, data)) {
+		size_t valid = validPrefix(data, nullptr);
+		if (valid != data.size()) {
+			std::cerr << "Edit journal: dropping " << data.size() - valid << " torn bytes" << std::endl;
+			data.resize(valid);
+			if (!writeFileAtomic(activePath, data)) {
+				std::cerr << "Edit journal: failed to drop torn tail of " << activePath << std::endl;
+				return false;
+			}
+		}
+		activeBytes = valid;
+	}
+
+	file = fopen(activePath.c_str(), "ab");
+	if (!file) {
+		std::cerr << "Failed to open edit journal: " << activePath << std::endl;
+		return false;
+	}
+
+	committerThread = std::thread(&EditJournal::committerLoop, this);
+	return true;
+}
+
+bool EditJournal::writeBatch(const std::vector<VoxelEdit>& edits) {
+	if (edits.empty()) return true;
+	if (!file) return false;
+
+	std::vector<uint8_t> buffer(kBatchHeaderBytes + edits.size() * kEditBytes);
+	uint8_t* body = buffer.data() + kBatchHeaderBytes;
+	for (size_t i = 0; i < edits.size(); i++) {
+		memcpy(body + i * kEditBytes + 0, &edits[i].x, 4);
+		memcpy(body + i * kEditBytes + 4, &edits[i].y, 4);
+		memcpy(body + i * kEditBytes + 8, &edits[i].z, 4);
+		body[i * kEditBytes + 12] = edits[i].value;
+	}
+
+	uint32_t header[3] = { kBatchMagic, (uint32_t)edits.size(),
+		crc32(body, edits.size() * kEditBytes) };
+	memcpy(buffer.data(), header, sizeof(header));
+
+	// Una escritura secuencial y un fsync por lote (group commit)
+	bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+	ok = syncFile(file) && ok;
+	if (!ok) {
+		std::cerr << "Edit journal: failed to write " << edits.size() << " edits to " << activePath << std::endl;
+		return false;
+	}
+
+	activeBytes += buffer.size();
+	batchesWritten++;
+	editsWritten += edits.size();
+	return true;
+}
+
+uint64_t EditJournal::record(const VoxelEdit& edit) {
+	uint64_t seq;
+	bool full;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		batch.push_back(edit);
+		seq = ++recordedSeq;
+		full = batch.size() >= maxBatchEdits;
+	}
+	if (full) commitCv.notify_one();
+	return seq;
+}
+
+uint64_t EditJournal::record(const VoxelEdit* edits, size_t count) {
+	uint64_t seq;
+	bool full;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		batch.insert(batch.end(), edits, edits + count);
+		recordedSeq += count;
+		seq = recordedSeq;
+		full = batch.size() >= maxBatchEdits;
+	}
+	if (full) commitCv.notify_one();
+	return seq;
+}
+
+bool EditJournal::waitCommitted(uint64_t seq) {
+	std::unique_lock<std::mutex> lock(mutex);
+	commitCv.notify_one();
+	committedCv.wait(lock, [&] { return committedSeq >= seq || seq <= lostSeq || stopping || failed; });
+	return committedSeq >= seq && seq > lostSeq;
+}
+
+bool EditJournal::commitAll() {
+	uint64_t seq;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		seq = recordedSeq;
+	}
+	return waitCommitted(seq);
+}
+
+bool EditJournal::hasFailed() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return failed;
+}
+
+void EditJournal::committerLoop() {
+	Profiler::get().setThreadName("edit journal");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		commitCv.wait(lock, [this] { return stopping || !batch.empty() || retireStore != nullptr; });
+
+		// Esperar un poco a que se junten ms ediciones en el mismo lote
+		if (!batch.empty() && !stopping && batch.size() < maxBatchEdits) {
+			commitCv.wait_for(lock, std::chrono::milliseconds(groupCommitMs),
+				[this] { return stopping || batch.size() >= maxBatchEdits; });
+		}
+
+		if (!batch.empty() && failed) {
+			// Tras un fallo la cola del fichero puede estar cortada y el replay no
+			// llegara a lo que se aada detrs: estas ediciones no son durables
+			batch.clear();
+			lostSeq = recordedSeq;
+			committedCv.notify_all();
+		}
+
+		if (!batch.empty()) {
+			std::vector<VoxelEdit> edits;
+			edits.swap(batch);
+			uint64_t seq = recordedSeq;
+
+			lock.unlock();
+			bool written;
+			{
+				PROFILE_SCOPE("Journal: group commit");
+				std::lock_guard<std::mutex> fileLock(fileMutex);
+				written = writeBatch(edits);
+			}
+			lock.lock();
+
+			if (!written) {
+				failed = true;
+				lostSeq = seq;
+			}
+			else if (seq > committedSeq) committedSeq = seq;
+			committedCv.notify_all();
+		}
+
+		if (retireStore) {
+			RegionStore* store = retireStore;
+			retireStore = nullptr;
+
+			lock.unlock();
+			{
+				PROFILE_SCOPE("Journal: retire compacted log");
+				// Sin todos los chunks en disco el journal rotado es la nica copia
+				if (store->flush()) {
+					std::remove(compactingPath.c_str());
+					syncDirectory(directory);
+				}
+				else std::cerr << "Edit journal: region saves failed, keeping " << compactingPath << std::endl;
+			}
+			lock.lock();
+			compacting = false;
+		}
+
+		if (stopping && batch.empty()) break;
+	}
+}
+
+size_t EditJournal::replay(const std::function<void(const VoxelEdit&)>& apply) {
+	size_t applied = 0;
+	auto counting = [&](const VoxelEdit& edit) {
+		apply(edit);
+		applied++;
+	};
+
+	// El journal rotado es ms antiguo que el activo
+	std::vector<uint8_t> data;
+	if (readFile(compactingPath, data)) validPrefix(data, counting);
+	data.clear();
+
+	std::lock_guard<std::mutex> fileLock(fileMutex);
+	if (file) fflush(file);
+	if (readFile(activePath, data)) validPrefix(data, counting);
+
+	return applied;
+}
+
+bool EditJournal::needsCompaction() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return !compacting && activeBytes >= compactThresholdBytes;
+}
+
+bool EditJournal::isCompacting() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return compacting;
+}
+
+bool EditJournal::beginCompaction() {
+	std::vector<VoxelEdit> edits;
+	uint64_t seq;
+	bool wasFailed;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (compacting) return false;
+		compacting = true;
+		edits.swap(batch);
+		seq = recordedSeq;
+		wasFailed = failed;
+	}
+
+	bool written = true;
+	bool rotated;
+	bool reopened;
+	{
+		std::lock_guard<std::mutex> fileLock(fileMutex);
+		// Con el journal en fallo estas ediciones solo llegan a disco por los chunks
+		if (!wasFailed) written = writeBatch(edits);
+		// Windows no renombra ficheros abiertos: se cierra y, si la rotacin
+		// falla, se reabre el mismo sin truncarlo
+		if (file) fclose(file);
+		file = nullptr;
+
+		std::vector<uint8_t> data;
+		if (readFile(compactingPath, data)) {
+			// Qued un journal rotado sin retirar: se le aade el activo. Solo la parte
+			// vlida de cada uno, o el replay se parara en una cola cortada
+			std::vector<uint8_t> active;
+			readFile(activePath, active);
+			data.resize(validPrefix(data, nullptr));
+			data.insert(data.end(), active.begin(), active.begin() + validPrefix(active, nullptr));
+			// El activo solo se trunca cuando la mezcla ya est en disco
+			rotated = writeFileAtomic(compactingPath, data);
+		}
+		else {
+			rotated = replaceFile(activePath, compactingPath);
+			// Sin fsync del directorio el renombrado puede perderse, pero el
+			// contenido sigue bajo uno de los dos nombres y el replay lee ambos
+			if (rotated && !syncDirectory(directory))
+				std::cerr << "Edit journal: failed to sync " << directory << std::endl;
+		}
+
+		if (!rotated) std::cerr << "Edit journal: failed to rotate " << activePath << std::endl;
+		file = fopen(activePath.c_str(), rotated ? "wb" : "ab");
+		reopened = file != nullptr;
+		if (!reopened) std::cerr << "Failed to open edit journal: " << activePath << std::endl;
+		if (rotated) activeBytes = 0;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!rotated) {
+		// Se sigue con el journal anterior; las ediciones del lote ya estn en l
+		compacting = false;
+		if (wasFailed || !written) lostSeq = seq;
+		else if (seq > committedSeq) committedSeq = seq;
+		failed = wasFailed || !written || !reopened;
+		committedCv.notify_all();
+		return false;
+	}
+
+	// Journal nuevo y vaco: lo anterior est en el rotado o, si no lleg a
+	// escribirse, solo en los chunks que se guardan con esta compactacin
+	if (wasFailed || !written) lostSeq = seq;
+	if (seq > committedSeq) committedSeq = seq;
+	failed = !reopened;
+	committedCv.notify_all();
+	return true;
+}
+
+void EditJournal::finishCompactionAsync(RegionStore* store) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		retireStore = store;
+	}
+	commitCv.notify_one();
+}
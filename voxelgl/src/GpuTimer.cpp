@@ -0,0 +1,62 @@
+#include "GpuTimer.h"
+#include "Profiler.h"
+#include <iostream>
+
+GpuTimer::GpuTimer() {}
+
+GpuTimer::~GpuTimer() {
+	for (GLuint query : freeQueries) glDeleteQueries(1, &query);
+	for (const PendingQuery& pq : pending) glDeleteQueries(1, &pq.query);
+	if (hasActive) glDeleteQueries(1, &active.query);
+}
+
+void GpuTimer::begin(const char* name) {
+	if (hasActive) {
+		std::cerr << "GpuTimer: nested pass '" << name << "' ignored" << std::endl;
+		return;
+	}
+	if (!Profiler::get().isEnabled()) return;
+
+	GLuint query;
+	if (!freeQueries.empty()) {
+		query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	else {
+		glGenQueries(1, &query);
+	}
+
+	active.query = query;
+	active.name = name;
+	active.cpuStartNs = Profiler::nowNs();
+	hasActive = true;
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void GpuTimer::end() {
+	if (!hasActive) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	pending.push_back(active);
+	hasActive = false;
+}
+
+void GpuTimer::collect() {
+	// Las queries se resuelven en orden: parar en la primera no disponible
+	while (!pending.empty()) {
+		PendingQuery& pq = pending.front();
+
+		GLint available = 0;
+		glGetQueryObjectiv(pq.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+
+		GLuint64 elapsedNs = 0;
+		glGetQueryObjectui64v(pq.query, GL_QUERY_RESULT, &elapsedNs);
+
+		// Inicio aproximado: el momento en que la CPU emiti el pase
+		Profiler::get().recordGpu(pq.name, pq.cpuStartNs, (uint64_t)elapsedNs);
+
+		freeQueries.push_back(pq.query);
+		pending.pop_front();
+	}
+}
@@ -1,4 +1,6 @@
 #include "GreedyMesher.h"
+#include "Profiler.h"
+#include "MaterialTable.h"
 #include <cstring>
 #include <algorithm>
 #include <iostream>
@@ -15,123 +17,106 @@ GreedyMesher::~GreedyMesher() {
 void GreedyMesher::ensureVisitedBuffer(int size) {
 	if (size > bufferSize) {
 		delete[] visitedBuffer;
-		visitedBuffer = new bool[size];
+		visitedBuffer = new uint8_t[size];
 		bufferSize = size;
 	}
 }
 
-bool GreedyMesher::isSolid(const uint8_t* voxels, const glm::ivec3& size, const glm::ivec3& pos) {
-	if (pos.x < 0 || pos.x >= size.x ||
-		pos.y < 0 || pos.y >= size.y ||
-		pos.z < 0 || pos.z >= size.z) {
-		return false;
-	}
-
-	int idx = pos.z * size.y * size.x + pos.y * size.x + pos.x;
-	return voxels[idx] != 0;
+static inline bool spanEquals(const uint8_t* voxels, int count, uint8_t material) {
+	// Sin salida temprana: el bucle se puede vectorizar
+	int mismatches = 0;
+	for (int i = 0; i < count; i++) mismatches += voxels[i] != material;
+	return mismatches == 0;
 }
 
-bool GreedyMesher::isFaceVisible(const uint8_t* voxels, const glm::ivec3& size,
-	const glm::ivec3& pos, int face) {
-	glm::ivec3 neighbor = pos;
-
-	switch (face) {
-	case 0: neighbor.x += 1; break; // +X
-	case 1: neighbor.x -= 1; break; // -X
-	case 2: neighbor.y += 1; break; // +Y
-	case 3: neighbor.y -= 1; break; // -Y
-	case 4: neighbor.z += 1; break; // +Z
-	case 5: neighbor.z -= 1; break; // -Z
-	}
-
-	return !isSolid(voxels, size, neighbor);
+static inline bool anyVisited(const uint8_t* visited, int count) {
+	for (int i = 0; i < count; i++) if (visited[i]) return true;
+	return false;
 }
 
 std::vector<Cuboid> GreedyMesher::greedy3DBinary(const uint8_t* voxels, const glm::ivec3& size) {
 	std::vector<Cuboid> cuboids;
+	greedy3DBinary(voxels, size, cuboids);
+	return cuboids;
+}
+
+void GreedyMesher::greedy3DBinary(const uint8_t* voxels, const glm::ivec3& size, std::vector<Cuboid>& cuboids) {
+	PROFILE_SCOPE("Mesher: greedy3DBinary");
+	cuboids.clear();
 	int totalVoxels = size.x * size.y * size.z;
 
 	ensureVisitedBuffer(totalVoxels);
-	memset(visitedBuffer, 0, totalVoxels * sizeof(bool));
+	memset(visitedBuffer, 0, totalVoxels);
 
-	for (int z = 0; z < size.z; z++) {
-		for (int y = 0; y < size.y; y++) {
-			for (int x = 0; x < size.x; x++) {
-				glm::ivec3 pos(x, y, z);
-				int idx = z * size.y * size.x + y * size.x + x;
+	// Expandir en X, luego Y, luego Z
+	const int sx = size.x, sy = size.y, sz = size.z;
+	const int strideY = sx, strideZ = sx * sy;
+
+	for (int z = 0; z < sz; z++) {
+		for (int y = 0; y < sy; y++) {
+			for (int x = 0; x < sx; x++) {
+				int idx = z * strideZ + y * strideY + x;
 
 				// Saltar vaco o ya visitado
-				if (visitedBuffer[idx] || voxels[idx] == 0) continue;
+				if (voxels[idx] == 0 || visitedBuffer[idx]) continue;
 
 				uint8_t material = voxels[idx];
 				Cuboid cuboid;
-				cuboid.min = pos;
-				cuboid.max = pos;
+				cuboid.min = glm::ivec3(x, y, z);
+				cuboid.max = cuboid.min;
 				cuboid.material = material;
 
 				// Expandir en X
-				for (int dx = 1; x + dx < size.x; dx++) {
-					glm::ivec3 checkPos = pos + glm::ivec3(dx, 0, 0);
-					int checkIdx = checkPos.z * size.y * size.x + checkPos.y * size.x + checkPos.x;
-
-					if (visitedBuffer[checkIdx] || voxels[checkIdx] != material) break;
-					cuboid.max.x = x + dx;
+				int width = 1;
+				while (x + width < sx && voxels[idx + width] == material && !visitedBuffer[idx + width]) {
+					width++;
 				}
 
-				// Expandir en Y
-				bool canExpandY = true;
-				for (int dy = 1; y + dy < size.y && canExpandY; dy++) {
-					for (int dx = 0; dx <= cuboid.max.x - cuboid.min.x; dx++) {
-						glm::ivec3 checkPos = cuboid.min + glm::ivec3(dx, dy, 0);
-						int checkIdx = checkPos.z * size.y * size.x + checkPos.y * size.x + checkPos.x;
-
-						if (visitedBuffer[checkIdx] || voxels[checkIdx] != material) {
-							canExpandY = false;
-							break;
-						}
-					}
-					if (canExpandY) cuboid.max.y = y + dy;
+				// Expandir en Y: la fila siguiente entera debe coincidir
+				int height = 1;
+				while (y + height < sy) {
+					int rowIdx = idx + height * strideY;
+					if (!spanEquals(voxels + rowIdx, width, material) || anyVisited(visitedBuffer + rowIdx, width)) break;
+					height++;
 				}
 
-				// Expandir en Z
-				bool canExpandZ = true;
-				for (int dz = 1; z + dz < size.z && canExpandZ; dz++) {
-					for (int dy = 0; dy <= cuboid.max.y - cuboid.min.y; dy++) {
-						for (int dx = 0; dx <= cuboid.max.x - cuboid.min.x; dx++) {
-							glm::ivec3 checkPos = cuboid.min + glm::ivec3(dx, dy, dz);
-							int checkIdx = checkPos.z * size.y * size.x + checkPos.y * size.x + checkPos.x;
-
-							if (visitedBuffer[checkIdx] || voxels[checkIdx] != material) {
-								canExpandZ = false;
-								break;
-							}
-						}
-						if (!canExpandZ) break;
+				// Expandir en Z: todo el rectngulo de la capa siguiente
+				int depth = 1;
+				while (z + depth < sz) {
+					bool canExpand = true;
+					for (int dy = 0; dy < height && canExpand; dy++) {
+						int rowIdx = idx + depth * strideZ + dy * strideY;
+						canExpand = spanEquals(voxels + rowIdx, width, material) && !anyVisited(visitedBuffer + rowIdx, width);
 					}
-					if (canExpandZ) cuboid.max.z = z + dz;
+					if (!canExpand) break;
+					depth++;
 				}
 
 				// Marcar como visitado
-				for (int dz = cuboid.min.z; dz <= cuboid.max.z; dz++) {
-					for (int dy = cuboid.min.y; dy <= cuboid.max.y; dy++) {
-						for (int dx = cuboid.min.x; dx <= cuboid.max.x; dx++) {
-							int vIdx = dz * size.y * size.x + dy * size.x + dx;
-							visitedBuffer[vIdx] = true;
-						}
+				for (int dz = 0; dz < depth; dz++) {
+					for (int dy = 0; dy < height; dy++) {
+						memset(visitedBuffer + idx + dz * strideZ + dy * strideY, 1, width);
 					}
 				}
 
+				cuboid.max = cuboid.min + glm::ivec3(width - 1, height - 1, depth - 1);
 				cuboids.push_back(cuboid);
 			}
 		}
 	}
-
-	return cuboids;
 }
 
 Mesh GreedyMesher::cuboidsToVertices(const std::vector<Cuboid>& cuboids) {
 	Mesh mesh;
-	int id = 0;
+	cuboidsToVertices(cuboids, mesh);
+	return mesh;
+}
+
+void GreedyMesher::cuboidsToVertices(const std::vector<Cuboid>& cuboids, Mesh& mesh) {
+	PROFILE_SCOPE("Mesher: cuboidsToVertices");
+	mesh.clear();
+	mesh.quads = true;
+	mesh.vertices.reserve(cuboids.size() * 24);
 
 	for (const auto& cuboid : cuboids) {
 		glm::vec3 minPos = glm::vec3(cuboid.min) - 0.5f;
@@ -160,46 +145,31 @@ Mesh GreedyMesher::cuboidsToVertices(const std::vector<Cuboid>& cuboids) {
 			{ 0, 3, 2, 1 }  // -Z
 		};
 
-		int voxelIndices[6][4] = {
-			{0, 1, 2, 3},       // Front
-			{4, 5, 6, 7},       // Back
-			{8, 9, 10, 11},     // Right
-			{12, 13, 14, 15},   // Left
-			{16, 17, 18, 19},   // Top
-			{20, 21, 22, 23}    // Bottom
-		};
-
-		glm::vec2 uv[4] = {
-			{ 0.0f, 0.0f },
-			{ 1.0f, 0.0f },
-			{ 1.0f, 1.0f },
-			{ 0.0f, 1.0f }
+		// Ejes tangentes (u, v) de cada cara para las UVs
+		int faceAxes[6][2] = {
+			{ 2, 1 }, // +X: (z, y)
+			{ 2, 1 }, // -X
+			{ 0, 2 }, // +Y: (x, z)
+			{ 0, 2 }, // -Y
+			{ 0, 1 }, // +Z: (x, y)
+			{ 0, 1 }  // -Z
 		};
 
 		for (int face = 0; face < 6; face++) {
 			// Solo agregar caras visibles (en este caso, todas)
 			glm::vec3 normal = faceNormals[face];
-
-			// Crear dos tringulos para la cara
-			mesh.vertices.emplace_back(vertices3D[faceIndices[face][0]], normal, uv[0], material);
-			mesh.vertices.emplace_back(vertices3D[faceIndices[face][1]], normal, uv[1], material);
-			mesh.vertices.emplace_back(vertices3D[faceIndices[face][2]], normal, uv[2], material);
-			mesh.vertices.emplace_back(vertices3D[faceIndices[face][3]], normal, uv[3], material);
-
-			// Tringulo 1
-			mesh.indices.push_back(voxelIndices[face][0] + id * 24);
-			mesh.indices.push_back(voxelIndices[face][1] + id * 24);
-			mesh.indices.push_back(voxelIndices[face][2] + id * 24);
-
-			// Tringulo 2
-			mesh.indices.push_back(voxelIndices[face][0] + id * 24);
-			mesh.indices.push_back(voxelIndices[face][2] + id * 24);
-			mesh.indices.push_back(voxelIndices[face][3] + id * 24);
+			int ua = faceAxes[face][0];
+			int va = faceAxes[face][1];
+
+			// Un quad por cara (ndices implcitos, ver Mesh)
+			// UVs en unidades de voxel para que la textura se repita en quads grandes
+			for (int corner = 0; corner < 4; corner++) {
+				const glm::vec3& p = vertices3D[faceIndices[face][corner]];
+				glm::vec2 uv(p[ua] - minPos[ua], p[va] - minPos[va]);
+				mesh.vertices.emplace_back(p, normal, uv, material);
+			}
 		}
-		id++;
 	}
-
-	return mesh;
 }
 
 Mesh GreedyMesher::greedy3DBinaryToVertices(const uint8_t* voxels, const glm::ivec3& size) {
@@ -207,62 +177,252 @@ Mesh GreedyMesher::greedy3DBinaryToVertices(const uint8_t* voxels, const glm::iv
 	return cuboidsToVertices(cuboids);
 }
 
-std::vector<uint8_t> GreedyMesher::downsample(const uint8_t* voxels,
-	const glm::ivec3& size, int factor) {
-	glm::ivec3 newSize = size / factor;
-	std::vector<uint8_t> result(newSize.x * newSize.y * newSize.z, 0);
-
-	for (int z = 0; z < newSize.z; z++) {
-		for (int y = 0; y < newSize.y; y++) {
-			for (int x = 0; x < newSize.x; x++) {
-				int solidCount = 0;
-				int totalCount = 0;
-
-				for (int dz = 0; dz < factor; dz++) {
-					for (int dy = 0; dy < factor; dy++) {
-						for (int dx = 0; dx < factor; dx++) {
-							int sx = x * factor + dx;
-							int sy = y * factor + dy;
-							int sz = z * factor + dz;
-
-							if (sx < size.x && sy < size.y && sz < size.z) {
-								int idx = sz * size.y * size.x + sy * size.x + sx;
-								if (voxels[idx] > 0) solidCount++;
-								totalCount++;
-							}
-						}
+// Luz de una esquina de cara en cuartos de nivel (0..60): cielo en los bits
+// 0..5, bloque en 6..11. Promedia los voxels de aire que tocan la esquina; la
+// diagonal no cuenta si los dos laterales son slidos (no se filtra la luz).
+// ndices en el volumen con borde.
+static inline uint32_t cornerLight(const uint8_t* light, int q, int eu, int ev,
+	bool side1, bool side2, bool corner) {
+	uint8_t samples[4];
+	int count = 0;
+	samples[count++] = light[q];
+	if (!side1) samples[count++] = light[q + eu];
+	if (!side2) samples[count++] = light[q + ev];
+	if (!corner && !(side1 && side2)) samples[count++] = light[q + eu + ev];
+
+	uint32_t sky = 0, block = 0;
+	for (int i = 0; i < count; i++) {
+		sky += samples[i] >> 4;
+		block += samples[i] & 0x0F;
+	}
+	sky = (sky * 4 + count / 2) / count;
+	block = (block * 4 + count / 2) / count;
+	return sky | (block << 6);
+}
+
+void GreedyMesher::padVoxels(const uint8_t* voxels, const glm::ivec3& size) {
+	// Voxels con un borde de aire: los vecinos se leen sin comprobar lmites
+	const glm::ivec3 padded = size + glm::ivec3(2);
+	paddedVoxels.assign(padded.x * padded.y * padded.z, 0);
+	for (int z = 0; z < size.z; z++) {
+		for (int y = 0; y < size.y; y++) {
+			const uint8_t* row = &voxels[(z * size.y + y) * size.x];
+			std::memcpy(&paddedVoxels[((z + 1) * padded.y + y + 1) * padded.x + 1], row, size.x);
+		}
+	}
+}
+
+Mesh GreedyMesher::greedyFaceMesh(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light) {
+	Mesh mesh;
+	greedyFaceMesh(voxels, size, light, mesh);
+	return mesh;
+}
+
+void GreedyMesher::greedyFaceMesh(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, Mesh& mesh) {
+	PROFILE_SCOPE("Mesher: greedyFaceMesh");
+	mesh.clear();
+	padVoxels(voxels, size);
+	faceMeshRegion(paddedVoxels.data(), size, light, glm::ivec3(0), size, mesh);
+}
+
+void GreedyMesher::greedyFaceMeshSections(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light,
+	int sectionSize, uint32_t sectionMask, std::vector<Mesh>& sections) {
+	padVoxels(voxels, size);
+	greedyFaceMeshSectionsPadded(paddedVoxels.data(), size, light, sectionSize, sectionMask, sections);
+}
+
+void GreedyMesher::greedyFaceMeshSectionsPadded(const uint8_t* padded, const glm::ivec3& size, const uint8_t* light,
+	int sectionSize, uint32_t sectionMask, std::vector<Mesh>& sections) {
+	PROFILE_SCOPE("Mesher: greedyFaceMeshSections");
+	const glm::ivec3 counts = (size + sectionSize - 1) / sectionSize;
+	sections.resize(counts.x * counts.y * counts.z);
+
+	for (int i = 0; i < (int)sections.size(); i++) {
+		if (!(sectionMask & (1u << i))) continue;
+		glm::ivec3 section(i % counts.x, (i / counts.x) % counts.y, i / (counts.x * counts.y));
+		glm::ivec3 regionMin = section * sectionSize;
+		glm::ivec3 regionMax = glm::min(regionMin + sectionSize, size);
+		sections[i].clear();
+		faceMeshRegion(padded, size, light, regionMin, regionMax, sections[i]);
+	}
+}
+
+void GreedyMesher::faceMeshRegion(const uint8_t* pv, const glm::ivec3& size, const uint8_t* light,
+	const glm::ivec3& regionMin, const glm::ivec3& regionMax, Mesh& mesh) {
+	const glm::ivec3 padded = size + glm::ivec3(2);
+	const int paddedStride[3] = { 1, padded.x, padded.x * padded.y };
+	const MaterialTable& table = MaterialTable::get();
+	bool opaque[256];
+	for (int m = 0; m < 256; m++) opaque[m] = table.isOpaque((uint8_t)m);
+	mesh.quads = true;
+	translucentVertices.clear();
+
+	for (int face = 0; face < 6; face++) {
+		const int d = face / 2;
+		const int s = (face % 2 == 0) ? 1 : -1;
+		// Ejes tangentes con u x v = +d: las esquinas 0..3 giran en sentido antihorario
+		const int u = (d + 1) % 3;
+		const int v = (d + 2) % 3;
+		const int du = regionMax[u] - regionMin[u];
+		const int dv = regionMax[v] - regionMin[v];
+		const int u0 = regionMin[u], v0 = regionMin[v];
+		const int front = s * paddedStride[d];
+		// Esquinas: (-u,-v), (+u,-v), (+u,+v), (-u,+v)
+		const int cornerU[4] = { -paddedStride[u], paddedStride[u], paddedStride[u], -paddedStride[u] };
+		const int cornerV[4] = { -paddedStride[v], -paddedStride[v], paddedStride[v], paddedStride[v] };
+		faceMask.assign(du * dv, 0);
+
+		for (int layer = regionMin[d]; layer < regionMax[d]; layer++) {
+			// Clave por celda: material (bits 0..7) y, por esquina, 14 bits: luz (12) y
+			// oclusin ambiental (2). Dos celdas solo se fusionan si su clave es idntica.
+			for (int b = 0; b < dv; b++) {
+				int pi = (layer + 1) * paddedStride[d] + (v0 + b + 1) * paddedStride[v] + (u0 + 1) * paddedStride[u];
+				uint64_t* maskRow = &faceMask[b * du];
+
+				for (int a = 0; a < du; a++, pi += paddedStride[u]) {
+					uint8_t material = pv[pi];
+					int q = pi + front;
+					if (material == 0 || !table.isFaceVisible(material, pv[q])) {
+						maskRow[a] = 0;
+						continue;
+					}
+
+					uint64_t key = material;
+					for (int c = 0; c < 4; c++) {
+						const int eu = cornerU[c], ev = cornerV[c];
+						// Solo lo opaco ocluye
+						bool side1 = opaque[pv[q + eu]];
+						bool side2 = opaque[pv[q + ev]];
+						bool corner = opaque[pv[q + eu + ev]];
+						// AO clsica de 3 vecinos: 3 = abierta, 0 = dos laterales slidos
+						uint64_t ao = (side1 && side2) ? 0 : 3 - (side1 + side2 + corner);
+						uint64_t cl = light ? cornerLight(light, q, eu, ev, side1, side2, corner) : 60;
+						key |= (cl | (ao << 12)) << (8 + 14 * c);
 					}
+					maskRow[a] = key;
 				}
+			}
+
+			// Fusin 2D: ancho primero, luego filas completas con la misma clave
+			for (int b = 0; b < dv; b++) {
+				for (int a = 0; a < du; ) {
+					uint64_t key = faceMask[b * du + a];
+					if (key == 0) { a++; continue; }
+
+					int w = 1;
+					while (a + w < du && faceMask[b * du + a + w] == key) w++;
+
+					int h = 1;
+					for (; b + h < dv; h++) {
+						const uint64_t* row = &faceMask[(b + h) * du + a];
+						int k = 0;
+						while (k < w && row[k] == key) k++;
+						if (k < w) break;
+					}
+
+					for (int j = 0; j < h; j++) {
+						std::fill_n(&faceMask[(b + j) * du + a], w, 0);
+					}
+
+					uint32_t material = (uint32_t)(key & 0xFF);
+					glm::vec3 normal = faceNormals[face];
+					uint32_t corners[4];
+					int brightness[4];
+					for (int c = 0; c < 4; c++) {
+						corners[c] = (uint32_t)(key >> (8 + 14 * c)) & 0x3FFF;
+						// AO primero; a igual AO, la luz
+						brightness[c] = (int)(corners[c] >> 12) * 256 + (int)(corners[c] & 0x3F) + (int)((corners[c] >> 6) & 0x3F);
+					}
+
+					// La diagonal une las dos esquinas ms claras: as la esquina oscura
+					// queda en un solo tringulo y el degradado no depende del giro del
+					// quad. Con los ndices fijos { 0, 1, 2, 0, 2, 3 } la diagonal y el
+					// giro (caras -dir invertidas) se eligen por el orden de las esquinas.
+					static const int frontOrder[2][4] = { { 0, 1, 2, 3 }, { 1, 2, 3, 0 } };
+					static const int backOrder[2][4] = { { 0, 3, 2, 1 }, { 1, 0, 3, 2 } };
+					int flip = (brightness[1] + brightness[3] > brightness[0] + brightness[2]) ? 1 : 0;
+					const int* order = (s > 0) ? frontOrder[flip] : backOrder[flip];
+					std::vector<Vertex>& target = table.isTranslucent((uint8_t)material) ? translucentVertices : mesh.vertices;
+
+					for (int i = 0; i < 4; i++) {
+						const int c = order[i];
+						float cu = (c == 1 || c == 2) ? (float)w : 0.0f;
+						float cv = (c >= 2) ? (float)h : 0.0f;
+						glm::vec3 pos;
+						pos[d] = layer + 0.5f * s;
+						pos[u] = u0 + a - 0.5f + cu;
+						pos[v] = v0 + b - 0.5f + cv;
+
+						uint32_t sky = (corners[c] & 0x3F) * 255 / 60;
+						uint32_t block = ((corners[c] >> 6) & 0x3F) * 255 / 60;
+						uint32_t ao = (corners[c] >> 12) * 85;
+						target.emplace_back(pos, normal, glm::vec2(cu, cv), material, sky | (block << 8) | (ao << 16));
+					}
 
-				// Si ms del 50% son slidos, hacer voxel slido
-				int idx = z * newSize.y * newSize.x + y * newSize.x + x;
-				if (totalCount > 0 && solidCount * 2 > totalCount) {
-					result[idx] = 1;  // Material base para LOD
+					a += w;
 				}
 			}
 		}
 	}
 
-	return result;
+	// Translcidas al final: un solo buffer, dos rangos de dibujo
+	mesh.translucentIndexCount = (uint32_t)(translucentVertices.size() / 4 * 6);
+	mesh.vertices.insert(mesh.vertices.end(), translucentVertices.begin(), translucentVertices.end());
+}
+
+bool GreedyMesher::downsample(const uint8_t* voxels, const glm::ivec3& size, int factor, std::vector<uint8_t>& result) {
+	int level = 0;
+	while ((2 << level) <= factor) level++;
+	if (level == 0) {
+		result.resize(size.x * size.y * size.z);
+		for (size_t i = 0; i < result.size(); i++) result[i] = voxels[i] > 0 ? 1 : 0;
+		return true;
+	}
+	downsampler.build(voxels, size, level);
+	if (downsampler.getLevels() < level) {
+		result.clear();
+		return false;
+	}
+
+	// Si ms del 50% son slidos, hacer voxel slido (material base para LOD)
+	glm::ivec3 newSize = downsampler.getSize(level);
+	const uint16_t* counts = downsampler.getCounts(level);
+	int half = factor * factor * factor / 2;
+	result.resize(newSize.x * newSize.y * newSize.z);
+	for (size_t i = 0; i < result.size(); i++) result[i] = counts[i] > half ? 1 : 0;
+	return true;
 }
 
 Mesh GreedyMesher::generateLODMesh(const uint8_t* voxels,
 	const glm::ivec3& size, int lodLevel) {
+	Mesh mesh;
+	generateLODMesh(voxels, size, lodLevel, mesh);
+	return mesh;
+}
+
+void GreedyMesher::generateLODMesh(const uint8_t* voxels, const glm::ivec3& size, int lodLevel, Mesh& mesh) {
 	if (lodLevel == 0) {
-		return greedy3DBinaryToVertices(voxels, size);
+		greedyFaceMesh(voxels, size, nullptr, mesh);
+		return;
 	}
 
+	PROFILE_SCOPE("Mesher: LOD");
 	int factor = 1 << lodLevel;
-	auto downsampled = downsample(voxels, size, factor);
+	if (!downsample(voxels, size, factor, lodVoxels)) {
+		// Chunk demasiado pequeo para este nivel
+		mesh.clear();
+		mesh.quads = true;
+		return;
+	}
 	glm::ivec3 newSize = size / factor;
 
-	auto cuboids = greedy3DBinary(downsampled.data(), newSize);
+	greedy3DBinary(lodVoxels.data(), newSize, lodCuboids);
 
 	// Escalar cuboides de vuelta
-	for (auto& cuboid : cuboids) {
+	for (auto& cuboid : lodCuboids) {
 		cuboid.min *= factor;
 		cuboid.max = (cuboid.max + glm::ivec3(1)) * factor - glm::ivec3(1);
 	}
 
-	return cuboidsToVertices(cuboids);
+	cuboidsToVertices(lodCuboids, mesh);
 }
\ No newline at end of file
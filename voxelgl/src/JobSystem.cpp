@@ -0,0 +1,219 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+// ndice del worker del hilo actual (-1 fuera de los workers)
+static thread_local int currentWorker = -1;
+
+static bool laterJob(const JobHandle& a, const JobHandle& b) {
+	return a->priority > b->priority;
+}
+
+JobSystem::JobSystem(int workerCount) {
+	if (workerCount <= 0) {
+		int cores = (int)std::thread::hardware_concurrency();
+		workerCount = std::max(1, cores - 1);
+	}
+
+	for (int i = 0; i < workerCount; i++)
+		queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+	for (int i = 0; i < workerCount; i++)
+		workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCv.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+void JobSystem::push(WorkerQueue& queue, const JobHandle& job) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	job->priority = job->requestedPriority.load(std::memory_order_relaxed);
+	queue.heap.push_back(job);
+	std::push_heap(queue.heap.begin(), queue.heap.end(), laterJob);
+}
+
+JobHandle JobSystem::pop(WorkerQueue& queue) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.heap.empty()) return nullptr;
+
+	std::pop_heap(queue.heap.begin(), queue.heap.end(), laterJob);
+	JobHandle job = queue.heap.back();
+	queue.heap.pop_back();
+	return job;
+}
+
+JobHandle JobSystem::steal(int thief) {
+	int count = (int)queues.size();
+	int start = thief >= 0 ? thief + 1 : (int)(nextQueue.load() % count);
+
+	for (int i = 0; i < count; i++) {
+		int victim = (start + i) % count;
+		if (victim == thief) continue;
+
+		JobHandle job = pop(*queues[victim]);
+		if (job) {
+			jobsStolen++;
+			queuedJobs--;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+JobHandle JobSystem::create(std::function<void()> task, float priority, JobAffinity affinity) {
+	JobHandle job = std::make_shared<Job>();
+	job->task = std::move(task);
+	job->priority = priority;
+	job->requestedPriority = priority;
+	job->affinity = affinity;
+	return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& prerequisite) {
+	if (!prerequisite) return;
+
+	std::lock_guard<std::mutex> lock(prerequisite->mutex);
+	if (prerequisite->finished) return;
+	job->pendingCount++;
+	prerequisite->continuations.push_back(job);
+}
+
+void JobSystem::setPriority(const JobHandle& job, float priority) {
+	if (!job || job->finished) return;
+	job->requestedPriority.store(priority, std::memory_order_relaxed);
+	prioritiesDirty = true;
+}
+
+void JobSystem::reheap(WorkerQueue& queue) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	for (const JobHandle& job : queue.heap)
+		job->priority = job->requestedPriority.load(std::memory_order_relaxed);
+	std::make_heap(queue.heap.begin(), queue.heap.end(), laterJob);
+}
+
+void JobSystem::refreshPriorities() {
+	if (!prioritiesDirty.exchange(false)) return;
+	PROFILE_SCOPE("Jobs: refresh priorities");
+
+	// Reordenar cada cola entera es O(n) y solo bloquea esa cola
+	for (auto& queue : queues) reheap(*queue);
+	reheap(mainQueue);
+}
+
+void JobSystem::submit(const JobHandle& job) {
+	activeJobs++;
+	if (--job->pendingCount == 0) schedule(job);
+}
+
+JobHandle JobSystem::run(std::function<void()> task, float priority, JobAffinity affinity) {
+	JobHandle job = create(std::move(task), priority, affinity);
+	submit(job);
+	return job;
+}
+
+void JobSystem::schedule(const JobHandle& job) {
+	if (job->affinity == JobAffinity::MainThread) {
+		push(mainQueue, job);
+		return;
+	}
+
+	// Un worker encola en su propia cola (localidad); el resto reparte
+	int index = currentWorker >= 0 ? currentWorker : (int)(nextQueue++ % queues.size());
+	push(*queues[index], job);
+	queuedJobs++;
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCv.notify_one();
+}
+
+void JobSystem::execute(const JobHandle& job) {
+	job->task();
+	job->task = nullptr;  // Liberar lo capturado cuanto antes
+
+	std::vector<JobHandle> ready;
+	{
+		std::lock_guard<std::mutex> lock(job->mutex);
+		job->finished = true;
+		ready.swap(job->continuations);
+	}
+	for (const JobHandle& next : ready) {
+		if (--next->pendingCount == 0) schedule(next);
+	}
+
+	jobsExecuted++;
+	{
+		std::lock_guard<std::mutex> lock(doneMutex);
+		activeJobs--;
+	}
+	doneCv.notify_all();
+}
+
+void JobSystem::workerLoop(int index) {
+	currentWorker = index;
+	Profiler::get().setThreadName("worker " + std::to_string(index));
+
+	while (true) {
+		JobHandle job = pop(*queues[index]);
+		if (job) queuedJobs--;
+		else job = steal(index);
+
+		if (job) {
+			execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCv.wait(lock, [this] { return stopping || queuedJobs.load() > 0; });
+		if (stopping) break;
+	}
+}
+
+int JobSystem::runMainThreadJobs(int budget) {
+	PROFILE_SCOPE("Jobs: main thread");
+
+	int executed = 0;
+	while (budget < 0 || executed < budget) {
+		JobHandle job = pop(mainQueue);
+		if (!job) break;
+		execute(job);
+		executed++;
+	}
+	return executed;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+	while (!isFinished(job)) {
+		// Ayudar: jobs del hilo principal y luego los de cualquier worker
+		JobHandle next = pop(mainQueue);
+		if (!next) next = steal(-1);
+		if (next) {
+			execute(next);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(doneMutex);
+		doneCv.wait_for(lock, std::chrono::milliseconds(1));
+	}
+}
+
+void JobSystem::waitIdle() {
+	while (activeJobs.load() > 0) {
+		JobHandle next = pop(mainQueue);
+		if (!next) next = steal(-1);
+		if (next) {
+			execute(next);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(doneMutex);
+		doneCv.wait_for(lock, std::chrono::milliseconds(1));
+	}
+}
@@ -0,0 +1,556 @@
+#include "LightEngine.h"
+#include "VoxelWorld.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+const int LightEngine::kMaxLevel;
+const int LightEngine::kNodesPerBatch;
+const int LightEngine::kNodesPerSlice;
+
+static const glm::ivec3 kDirections[6] = {
+	glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+	glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+	glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+};
+static const int kDown = 3;
+
+static inline int channel(uint8_t value, bool sky) {
+	return sky ? value >> 4 : value & 0x0F;
+}
+
+static inline uint8_t withChannel(uint8_t value, bool sky, int level) {
+	return sky ? (uint8_t)((value & 0x0F) | (level << 4)) : (uint8_t)((value & 0xF0) | level);
+}
+
+// El cielo pleno baja sin atenuarse; el resto pierde un nivel por voxel
+static inline int spreadLevel(int level, bool sky, int dir) {
+	return (sky && dir == kDown && level == LightEngine::kMaxLevel) ? level : level - 1;
+}
+
+LightEngine::LightEngine(VoxelWorld* owner) : world(owner) {
+	chunkSize = world->getChunkSize();
+	worldVoxels = world->getWorldSize() * chunkSize;
+}
+
+LightEngine::~LightEngine() {
+}
+
+void LightEngine::requestChunk(Chunk* chunk) {
+	if (stopping) return;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		pendingChunks.push_back(chunk);
+	}
+	scheduleJob();
+}
+
+void LightEngine::notifyEdit(const glm::ivec3& pos) {
+	if (stopping) return;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		pendingEdits.push_back(pos);
+	}
+	scheduleJob();
+}
+
+void LightEngine::notifyEdits(std::vector<LightEditMask>& masks) {
+	if (stopping || masks.empty()) return;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (LightEditMask& mask : masks) pendingMasks.push_back(std::move(mask));
+	}
+	masks.clear();
+	scheduleJob();
+}
+
+void LightEngine::scheduleJob() {
+	// Un solo job de luz a la vez: las colas no se comparten entre hilos
+	bool expected = false;
+	if (!jobQueued.compare_exchange_strong(expected, true)) return;
+	world->getJobSystem()->run([this] { runBatch(); }, -0.5f);
+}
+
+bool LightEngine::hasPendingInput() {
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return !pendingChunks.empty() || !pendingEdits.empty() || !pendingMasks.empty();
+}
+
+bool LightEngine::isIdle() {
+	return !jobQueued.load() && !hasPendingInput();
+}
+
+LightStats LightEngine::getStats() const {
+	LightStats stats;
+	stats.chunksLit = chunksLit.load();
+	stats.editsApplied = editsApplied.load();
+	stats.nodesProcessed = nodesProcessed.load();
+	stats.batches = batches.load();
+	return stats;
+}
+
+void LightEngine::runBatch() {
+	if (stopping) {
+		jobQueued.store(false);
+		return;
+	}
+	PROFILE_SCOPE("Light: batch");
+
+	std::vector<Chunk*> chunksIn;
+	std::vector<glm::ivec3> editsIn;
+	std::vector<LightEditMask> masksIn;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		chunksIn.swap(pendingChunks);
+		editsIn.swap(pendingEdits);
+		masksIn.swap(pendingMasks);
+	}
+
+	bool more;
+	{
+		std::unique_lock<std::mutex> lock(world->voxelMutex);
+		cachedCoord = glm::ivec3(-1);
+		cachedChunk = nullptr;
+
+		for (Chunk* chunk : chunksIn) {
+			initChunk(chunk);
+			yieldVoxels(lock);
+		}
+		for (const glm::ivec3& pos : editsIn) {
+			applyEdit(pos);
+			yieldVoxels(lock);
+		}
+		for (const LightEditMask& mask : masksIn) {
+			applyMask(mask);
+			yieldVoxels(lock);
+		}
+
+		// Los borrados van antes que las adiciones: no se re-propaga luz obsoleta
+		int budget = kNodesPerBatch;
+		while (budget > 0) {
+			int slice = std::min(budget, kNodesPerSlice);
+			int left = slice;
+			if (!skyRemove.empty()) propagateRemove(skyRemove, skyAdd, true, left);
+			else if (!blockRemove.empty()) propagateRemove(blockRemove, blockAdd, false, left);
+			else if (!skyAdd.empty()) propagateAdd(skyAdd, true, left);
+			else if (!blockAdd.empty()) propagateAdd(blockAdd, false, left);
+			else break;
+			budget -= slice - left;
+			yieldVoxels(lock);
+		}
+		nodesProcessed += kNodesPerBatch - budget;
+		batches++;
+
+		flushTouched();
+
+		more = !skyRemove.empty() || !blockRemove.empty() || !skyAdd.empty() || !blockAdd.empty();
+	}
+
+	jobQueued.store(false);
+	if (!stopping && (more || hasPendingInput())) scheduleJob();
+}
+
+void LightEngine::yieldVoxels(std::unique_lock<std::mutex>& lock) {
+	if (!world->voxelLockWanted.load()) return;
+	lock.unlock();
+	// El hilo principal baja la bandera en cuanto tiene el mutex
+	while (world->voxelLockWanted.load()) std::this_thread::yield();
+	lock.lock();
+	// Pudo generarse o iluminarse un chunk que la cach daba por ausente
+	cachedCoord = glm::ivec3(-1);
+	cachedChunk = nullptr;
+}
+
+Chunk* LightEngine::findChunk(const glm::ivec3& coord) {
+	glm::ivec3 size = world->getWorldSize();
+	if (coord.x < 0 || coord.x >= size.x || coord.y < 0 || coord.y >= size.y || coord.z < 0 || coord.z >= size.z)
+		return nullptr;
+
+	uint32_t id = (coord.x << 20) | (coord.y << 10) | coord.z;
+	auto it = world->chunks.find(id);
+	if (it == world->chunks.end() || !it->second->generated.load(std::memory_order_acquire)) return nullptr;
+	return it->second.get();
+}
+
+Chunk* LightEngine::locate(const glm::ivec3& pos, int& index) {
+	if (pos.x < 0 || pos.x >= worldVoxels.x || pos.y < 0 || pos.y >= worldVoxels.y ||
+		pos.z < 0 || pos.z >= worldVoxels.z) {
+		return nullptr;
+	}
+
+	glm::ivec3 coord(pos.x / chunkSize, pos.y / chunkSize, pos.z / chunkSize);
+	if (coord != cachedCoord) {
+		cachedCoord = coord;
+		cachedChunk = findChunk(coord);
+	}
+	// La propagacin no entra en chunks an sin luz: se iluminan enteros al iniciarlos
+	if (!cachedChunk || !cachedChunk->lit.load(std::memory_order_relaxed)) return nullptr;
+
+	glm::ivec3 local = pos - coord * chunkSize;
+	index = (local.z * chunkSize + local.y) * chunkSize + local.x;
+	return cachedChunk;
+}
+
+uint8_t LightEngine::voxelAt(const Chunk* chunk, int index) const {
+	return chunk->voxelData.empty() ? chunk->uniformValue : chunk->voxelData[chunk->voxelIndex(index)];
+}
+
+Chunk* LightEngine::step(Chunk* chunk, const glm::ivec3& local, int index, const glm::ivec3& pos,
+	int dir, int& outIndex) {
+	const int axis = dir / 2;
+	const int delta = (dir % 2 == 0) ? 1 : -1;
+	const int next = local[axis] + delta;
+	if (next >= 0 && next < chunkSize) {
+		const int stride = axis == 0 ? 1 : (axis == 1 ? chunkSize : chunkSize * chunkSize);
+		outIndex = index + delta * stride;
+		return chunk;
+	}
+	return locate(pos + kDirections[dir], outIndex);
+}
+
+void LightEngine::touchChunk(Chunk* chunk, uint8_t sections) {
+	chunk->lightSections |= sections;
+	if (chunk->lightTouched) return;
+	chunk->lightTouched = true;
+	touched.push_back(chunk);
+}
+
+void LightEngine::touch(Chunk* chunk, const glm::ivec3& local) {
+	touchChunk(chunk, Chunk::sectionsAround(local, local));
+
+	// En el borde, la malla del vecino (y de los diagonales) tambin lee este voxel
+	const int last = chunkSize - 1;
+	if (local.x > 0 && local.x < last && local.y > 0 && local.y < last && local.z > 0 && local.z < last) return;
+
+	int lo[3], hi[3];
+	for (int axis = 0; axis < 3; axis++) {
+		lo[axis] = local[axis] == 0 ? -1 : 0;
+		hi[axis] = local[axis] == last ? 1 : 0;
+	}
+	for (int dz = lo[2]; dz <= hi[2]; dz++) {
+		for (int dy = lo[1]; dy <= hi[1]; dy++) {
+			for (int dx = lo[0]; dx <= hi[0]; dx++) {
+				chunk->lightBorderMask |= 1u << ((dz + 1) * 9 + (dy + 1) * 3 + dx + 1);
+			}
+		}
+	}
+}
+
+void LightEngine::flushTouched() {
+	// Los vecinos se buscan una vez por chunk, no por voxel de borde
+	size_t count = touched.size();
+	for (size_t i = 0; i < count; i++) {
+		Chunk* chunk = touched[i];
+		uint32_t mask = chunk->lightBorderMask;
+		chunk->lightBorderMask = 0;
+		for (int n = 0; n < 27; n++) {
+			if (n == 13 || !(mask & (1u << n))) continue;
+			glm::ivec3 offset(n % 3 - 1, (n / 3) % 3 - 1, n / 9 - 1);
+			Chunk* neighbor = findChunk(chunk->position + offset);
+			if (neighbor) touchChunk(neighbor, Chunk::sectionsFacing(-offset));
+		}
+	}
+
+	for (Chunk* chunk : touched) {
+		chunk->lightTouched = false;
+		chunk->lightBorderMask = 0;
+		chunk->lightDirty.fetch_or(chunk->lightSections);
+		chunk->lightSections = 0;
+	}
+	touched.clear();
+}
+
+int LightEngine::sourceLevel(const glm::ivec3& pos, uint8_t material, bool sky) const {
+	if (sky) return (!isOpaque(material) && pos.y == worldVoxels.y - 1) ? kMaxLevel : 0;
+	return emission(material);
+}
+
+void LightEngine::initChunk(Chunk* chunk) {
+	if (chunk->lit) return;
+	PROFILE_SCOPE("Light: init chunk");
+	const int cs = chunkSize;
+	const glm::ivec3 origin = chunk->position * cs;
+
+	chunk->light.clear();
+	chunk->uniformLight = 0;
+	chunk->lit.store(true);
+	chunksLit++;
+
+	// Macizo y opaco: la luz no entra ni sale (los emisores s alumbran fuera; el
+	// cristal o el agua dejan pasar la de los vecinos)
+	if (chunk->content == ChunkContent::Uniform && emission(chunk->uniformValue) == 0 &&
+		isOpaque(chunk->uniformValue))
+		return;
+
+	// Columna de aire bajo el cielo: cielo pleno sin BFS. Los chunks vacos y
+	// oscuros de debajo (iluminados antes que este) pasan igual a cielo pleno.
+	std::vector<Chunk*> column;
+	Chunk* above = findChunk(chunk->position + glm::ivec3(0, 1, 0));
+	bool topChunk = chunk->position.y == world->getWorldSize().y - 1;
+	bool openAbove = topChunk || (above && above->lit && above->content == ChunkContent::Empty &&
+		above->light.empty() && above->uniformLight == 0xF0);
+
+	if (chunk->content == ChunkContent::Empty && openAbove) {
+		for (Chunk* c = chunk; c; ) {
+			c->light.clear();
+			c->uniformLight = 0xF0;
+			column.push_back(c);
+			Chunk* below = findChunk(c->position - glm::ivec3(0, 1, 0));
+			bool darkEmpty = below && below->lit && below->content == ChunkContent::Empty &&
+				below->light.empty() && below->uniformLight == 0;
+			c = darkEmpty ? below : nullptr;
+		}
+	}
+	else {
+		column.push_back(chunk);
+
+		// Fuentes propias: el techo del mundo y los emisores
+		for (int i = 0; i < cs * cs * cs; i++) {
+			uint8_t material = voxelAt(chunk, i);
+			int x = i % cs, y = (i / cs) % cs, z = i / (cs * cs);
+			glm::ivec3 pos = origin + glm::ivec3(x, y, z);
+			int sky = sourceLevel(pos, material, true);
+			int block = sourceLevel(pos, material, false);
+			if (sky == 0 && block == 0) continue;
+			chunk->setLight(i, (uint8_t)((sky << 4) | block));
+			if (sky > 0) skyAdd.push_back({ pos.x, pos.y, pos.z, (uint8_t)sky });
+			if (block > 0) blockAdd.push_back({ pos.x, pos.y, pos.z, (uint8_t)block });
+		}
+	}
+
+	// Intercambio con los vecinos ya iluminados, en ambos sentidos
+	for (Chunk* c : column) {
+		for (int c26 = 0; c26 < 27; c26++) {
+			glm::ivec3 offset(c26 % 3 - 1, (c26 / 3) % 3 - 1, c26 / 9 - 1);
+			Chunk* neighbor = findChunk(c->position + offset);
+			// Cambia la luz de todo el chunk: el vecino remalla su borde
+			if (neighbor && neighbor != c && neighbor->lit) touchChunk(neighbor, Chunk::sectionsFacing(-offset));
+		}
+		touchChunk(c, Chunk::kAllSections);
+
+		for (int dir = 0; dir < 6; dir++) {
+			glm::ivec3 d = kDirections[dir];
+			Chunk* neighbor = findChunk(c->position + d);
+			if (!neighbor || !neighbor->lit) continue;
+
+			// Sin nada que ganar en ningn sentido: cara saltada
+			if (c->light.empty() && neighbor->light.empty()) {
+				uint8_t a = c->uniformLight, b = neighbor->uniformLight;
+				bool gain = false;
+				for (int k = 0; k < 2 && !gain; k++) {
+					bool sky = k == 0;
+					int toB = spreadLevel(channel(a, sky), sky, dir);
+					int toA = spreadLevel(channel(b, sky), sky, dir ^ 1);
+					gain = toB > channel(b, sky) || toA > channel(a, sky);
+				}
+				if (!gain) continue;
+			}
+
+			// Voxels de la cara compartida: p en c, q en el vecino
+			int axis = dir / 2;
+			int u = (axis + 1) % 3, v = (axis + 2) % 3;
+			for (int b = 0; b < cs; b++) {
+				for (int a = 0; a < cs; a++) {
+					glm::ivec3 lp(0), lq(0);
+					lp[axis] = (d[axis] > 0) ? cs - 1 : 0;
+					lq[axis] = (d[axis] > 0) ? 0 : cs - 1;
+					lp[u] = lq[u] = a;
+					lp[v] = lq[v] = b;
+					int ip = (lp.z * cs + lp.y) * cs + lp.x;
+					int iq = (lq.z * cs + lq.y) * cs + lq.x;
+					glm::ivec3 pp = c->position * cs + lp;
+					glm::ivec3 pq = neighbor->position * cs + lq;
+					uint8_t lightP = c->getLight(ip), lightQ = neighbor->getLight(iq);
+					bool openP = !isOpaque(voxelAt(c, ip));
+					bool openQ = !isOpaque(voxelAt(neighbor, iq));
+
+					for (int k = 0; k < 2; k++) {
+						bool sky = k == 0;
+						std::deque<LightNode>& queue = sky ? skyAdd : blockAdd;
+						int levelP = channel(lightP, sky), levelQ = channel(lightQ, sky);
+						if (openQ && spreadLevel(levelP, sky, dir) > levelQ)
+							queue.push_back({ pp.x, pp.y, pp.z, (uint8_t)levelP });
+						if (openP && spreadLevel(levelQ, sky, dir ^ 1) > levelP)
+							queue.push_back({ pq.x, pq.y, pq.z, (uint8_t)levelQ });
+					}
+				}
+			}
+		}
+	}
+}
+
+void LightEngine::applyEdit(const glm::ivec3& pos) {
+	int index;
+	// Chunk sin luz: se iluminar entero con el voxel ya cambiado
+	Chunk* chunk = locate(pos, index);
+	if (!chunk) return;
+	editsApplied++;
+
+	glm::ivec3 local = pos - chunk->position * chunkSize;
+	uint8_t material = voxelAt(chunk, index);
+	for (int k = 0; k < 2; k++) {
+		bool sky = k == 0;
+		std::deque<LightNode>& removeQueue = sky ? skyRemove : blockRemove;
+		std::deque<LightNode>& addQueue = sky ? skyAdd : blockAdd;
+
+		int old = channel(chunk->getLight(index), sky);
+		if (old > 0) {
+			chunk->setLight(index, withChannel(chunk->getLight(index), sky, 0));
+			touch(chunk, local);
+			removeQueue.push_back({ pos.x, pos.y, pos.z, (uint8_t)old });
+		}
+
+		int source = sourceLevel(pos, material, sky);
+		if (source > 0) {
+			chunk->setLight(index, withChannel(chunk->getLight(index), sky, source));
+			touch(chunk, local);
+			addQueue.push_back({ pos.x, pos.y, pos.z, (uint8_t)source });
+		}
+
+		// Hueco nuevo: vuelve a entrar la luz de los vecinos
+		if (!isOpaque(material)) {
+			for (int dir = 0; dir < 6; dir++) {
+				int ni;
+				Chunk* neighbor = step(chunk, local, index, pos, dir, ni);
+				if (!neighbor) continue;
+				int level = channel(neighbor->getLight(ni), sky);
+				glm::ivec3 np = pos + kDirections[dir];
+				if (level > 0) addQueue.push_back({ np.x, np.y, np.z, (uint8_t)level });
+			}
+		}
+	}
+}
+
+void LightEngine::applyMask(const LightEditMask& mask) {
+	for (int z = mask.lo.z; z <= mask.hi.z; z++) {
+		for (int y = mask.lo.y; y <= mask.hi.y; y++) {
+			uint32_t bits = mask.rows[z * chunkSize + y];
+			for (int x = mask.lo.x; x <= mask.hi.x && (bits >> x) != 0; x++) {
+				if (bits & (1u << x)) applyEdit(mask.origin + glm::ivec3(x, y, z));
+			}
+		}
+	}
+}
+
+void LightEngine::propagateRemove(std::deque<LightNode>& removeQueue, std::deque<LightNode>& addQueue,
+	bool sky, int& budget) {
+	while (!removeQueue.empty() && budget > 0) {
+		LightNode node = removeQueue.front();
+		removeQueue.pop_front();
+		budget--;
+		glm::ivec3 pos(node.x, node.y, node.z);
+
+		int index;
+		Chunk* chunk = locate(pos, index);
+		if (!chunk) continue;
+		glm::ivec3 local = pos - chunk->position * chunkSize;
+
+		for (int dir = 0; dir < 6; dir++) {
+			int ni;
+			Chunk* neighbor = step(chunk, local, index, pos, dir, ni);
+			if (!neighbor) continue;
+
+			uint8_t value = neighbor->getLight(ni);
+			int level = channel(value, sky);
+			if (level == 0) continue;
+
+			glm::ivec3 np = pos + kDirections[dir];
+			// Dependa del voxel borrado: se apaga y sigue el borrado
+			if (level < node.level || (level == node.level && spreadLevel(node.level, sky, dir) == level)) {
+				neighbor->setLight(ni, withChannel(value, sky, 0));
+				touch(neighbor, np - neighbor->position * chunkSize);
+				removeQueue.push_back({ np.x, np.y, np.z, (uint8_t)level });
+
+				int source = sourceLevel(np, voxelAt(neighbor, ni), sky);
+				if (source > 0) {
+					neighbor->setLight(ni, withChannel(neighbor->getLight(ni), sky, source));
+					addQueue.push_back({ np.x, np.y, np.z, (uint8_t)source });
+				}
+			}
+			else {
+				// Otra fuente lo alimenta: vuelve a rellenar lo borrado
+				addQueue.push_back({ np.x, np.y, np.z, (uint8_t)level });
+			}
+		}
+	}
+}
+
+void LightEngine::propagateAdd(std::deque<LightNode>& addQueue, bool sky, int& budget) {
+	while (!addQueue.empty() && budget > 0) {
+		LightNode node = addQueue.front();
+		addQueue.pop_front();
+		budget--;
+		glm::ivec3 pos(node.x, node.y, node.z);
+
+		int index;
+		Chunk* chunk = locate(pos, index);
+		// Nodo obsoleto: un borrado posterior cambi su nivel
+		if (!chunk || channel(chunk->getLight(index), sky) != node.level) continue;
+		glm::ivec3 local = pos - chunk->position * chunkSize;
+
+		for (int dir = 0; dir < 6; dir++) {
+			int level = spreadLevel(node.level, sky, dir);
+			if (level <= 0) continue;
+
+			int ni;
+			Chunk* neighbor = step(chunk, local, index, pos, dir, ni);
+			if (!neighbor || isOpaque(voxelAt(neighbor, ni))) continue;
+
+			uint8_t value = neighbor->getLight(ni);
+			if (level <= channel(value, sky)) continue;
+			neighbor->setLight(ni, withChannel(value, sky, level));
+			glm::ivec3 np = pos + kDirections[dir];
+			touch(neighbor, np - neighbor->position * chunkSize);
+			addQueue.push_back({ np.x, np.y, np.z, (uint8_t)level });
+		}
+	}
+}
+
+void LightEngine::copyPadded(const Chunk* chunk, std::vector<uint8_t>& out) {
+	const int cs = chunkSize;
+	const int ps = cs + 2;
+	out.resize(ps * ps * ps);
+
+	// Los 27 chunks alrededor (null: sin luz)
+	const Chunk* around[27];
+	for (int i = 0; i < 27; i++) {
+		glm::ivec3 offset(i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1);
+		const Chunk* c = (offset == glm::ivec3(0)) ? chunk : findChunk(chunk->position + offset);
+		around[i] = (c && c->lit.load()) ? c : nullptr;
+	}
+
+	auto region = [cs](int v) { return v < 0 ? 0 : (v >= cs ? 2 : 1); };
+	auto wrap = [cs](int v) { return v < 0 ? v + cs : (v >= cs ? v - cs : v); };
+	auto clampLocal = [cs](int v) { return std::min(std::max(v, 0), cs - 1); };
+	int worldTop = worldVoxels.y;
+
+	for (int z = -1; z <= cs; z++) {
+		for (int y = -1; y <= cs; y++) {
+			uint8_t* row = &out[((z + 1) * ps + y + 1) * ps];
+			for (int x = -1; x <= cs; x++) {
+				// Interior de la fila: copia directa
+				if (x == 0 && region(y) == 1 && region(z) == 1) {
+					int base = (z * cs + y) * cs;
+					if (chunk->light.empty()) std::memset(row + 1, chunk->uniformLight, cs);
+					else std::memcpy(row + 1, &chunk->light[base], cs);
+					x = cs - 1;
+					continue;
+				}
+
+				const Chunk* c = around[(region(z) * 3 + region(y)) * 3 + region(x)];
+				uint8_t value;
+				if (c) {
+					value = c->getLight((wrap(z) * cs + wrap(y)) * cs + wrap(x));
+				}
+				else if (chunk->position.y * cs + y >= worldTop) {
+					value = 0xF0;
+				}
+				else {
+					value = chunk->getLight((clampLocal(z) * cs + clampLocal(y)) * cs + clampLocal(x));
+				}
+				row[x + 1] = value;
+			}
+		}
+	}
+}
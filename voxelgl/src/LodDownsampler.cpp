@@ -0,0 +1,284 @@
+#include "LodDownsampler.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LOD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LOD_AVX2
+#else
+// Solo estas funciones usan AVX2; el resto del binario no lo exige
+#define LOD_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LOD_NEON
+#include <arm_neon.h>
+#endif
+
+const int LodDownsampler::kMaxLevels;
+
+// Voxel i del bloque: dx + 2 * dy + 4 * dz. Los vectoriales siguen el mismo orden.
+static void reduceBlock(const uint8_t* v, uint16_t& count, uint8_t& material) {
+	int solid = 0, bestVotes = 0;
+	uint8_t best = 0;
+	for (int i = 0; i < 8; i++) {
+		if (v[i] == 0) continue;
+		solid++;
+		int votes = 0;
+		for (int j = 0; j < 8; j++) votes += v[j] == v[i];
+		if (votes > bestVotes) {
+			bestVotes = votes;
+			best = v[i];
+		}
+	}
+	count = (uint16_t)solid;
+	material = best;
+}
+
+// Bloques [x0, x1) de la fila (y, z) del nivel 1
+static void reduceRowScalar(const uint8_t* voxels, const glm::ivec3& size, int y, int z, int x0, int x1,
+	uint16_t* counts, uint8_t* materials) {
+	const int sx = size.x, plane = size.x * size.y;
+	const glm::ivec3 grid = size / 2;
+	const uint8_t* row = voxels + (2 * z * size.y + 2 * y) * sx;
+	int out = (z * grid.y + y) * grid.x;
+	uint8_t block[8];
+	for (int x = x0; x < x1; x++) {
+		const uint8_t* p = row + 2 * x;
+		block[0] = p[0];
+		block[1] = p[1];
+		block[2] = p[sx];
+		block[3] = p[sx + 1];
+		block[4] = p[plane];
+		block[5] = p[plane + 1];
+		block[6] = p[plane + sx];
+		block[7] = p[plane + sx + 1];
+		reduceBlock(block, counts[out + x], materials[out + x]);
+	}
+}
+
+#ifdef LOD_X86
+static bool cpuHasAvx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	// El sistema debe guardar los registros YMM (OSXSAVE y XCR0)
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+// 32 voxels seguidos: los de x par a 'even' y los de x impar a 'odd'
+LOD_AVX2 static inline void splitPairs(const uint8_t* p, __m128i& even, __m128i& odd) {
+	__m128i lo = _mm_loadu_si128((const __m128i*)p);
+	__m128i hi = _mm_loadu_si128((const __m128i*)(p + 16));
+	__m128i low = _mm_set1_epi16(0x00FF);
+	even = _mm_packus_epi16(_mm_and_si128(lo, low), _mm_and_si128(hi, low));
+	odd = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+// Dos tramos de 16 bloques a la vez: 'a' en la mitad baja de cada registro y 'b' en la alta
+LOD_AVX2 static void reduceUnitsAvx2(const uint8_t* a, const uint8_t* b, int sx, int plane,
+	uint16_t* countsA, uint8_t* materialsA, uint16_t* countsB, uint8_t* materialsB) {
+	const int offsets[4] = { 0, sx, plane, plane + sx };
+	__m256i v[8];
+	for (int r = 0; r < 4; r++) {
+		__m128i evenA, oddA, evenB, oddB;
+		splitPairs(a + offsets[r], evenA, oddA);
+		splitPairs(b + offsets[r], evenB, oddB);
+		v[2 * r] = _mm256_inserti128_si256(_mm256_castsi128_si256(evenA), evenB, 1);
+		v[2 * r + 1] = _mm256_inserti128_si256(_mm256_castsi128_si256(oddA), oddB, 1);
+	}
+
+	// Votos de cada voxel: l mismo y cada igual del bloque (la comparacin da -1)
+	__m256i votes[8];
+	for (int i = 0; i < 8; i++) votes[i] = _mm256_set1_epi8(1);
+	for (int i = 0; i < 8; i++) {
+		for (int j = i + 1; j < 8; j++) {
+			__m256i eq = _mm256_cmpeq_epi8(v[i], v[j]);
+			votes[i] = _mm256_sub_epi8(votes[i], eq);
+			votes[j] = _mm256_sub_epi8(votes[j], eq);
+		}
+	}
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi8(-1);
+	__m256i count = zero, best = zero, bestVotes = zero;
+	for (int i = 0; i < 8; i++) {
+		__m256i solid = _mm256_andnot_si256(_mm256_cmpeq_epi8(v[i], zero), ones);
+		count = _mm256_sub_epi8(count, solid);
+		// El aire no vota; a igualdad se queda el primero
+		__m256i candidate = _mm256_and_si256(votes[i], solid);
+		__m256i take = _mm256_cmpgt_epi8(candidate, bestVotes);
+		best = _mm256_blendv_epi8(best, v[i], take);
+		bestVotes = _mm256_max_epi8(candidate, bestVotes);
+	}
+
+	_mm_storeu_si128((__m128i*)materialsA, _mm256_castsi256_si128(best));
+	_mm_storeu_si128((__m128i*)materialsB, _mm256_extracti128_si256(best, 1));
+	_mm256_storeu_si256((__m256i*)countsA, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(count)));
+	_mm256_storeu_si256((__m256i*)countsB, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(count, 1)));
+}
+#endif
+
+#ifdef LOD_NEON
+// Un tramo de 16 bloques; vld2q_u8 ya separa x par e impar
+static void reduceUnitNeon(const uint8_t* p, int sx, int plane, uint16_t* counts, uint8_t* materials) {
+	const int offsets[4] = { 0, sx, plane, plane + sx };
+	uint8x16_t v[8];
+	for (int r = 0; r < 4; r++) {
+		uint8x16x2_t pairs = vld2q_u8(p + offsets[r]);
+		v[2 * r] = pairs.val[0];
+		v[2 * r + 1] = pairs.val[1];
+	}
+
+	uint8x16_t votes[8];
+	for (int i = 0; i < 8; i++) votes[i] = vdupq_n_u8(1);
+	for (int i = 0; i < 8; i++) {
+		for (int j = i + 1; j < 8; j++) {
+			uint8x16_t eq = vceqq_u8(v[i], v[j]);
+			votes[i] = vsubq_u8(votes[i], eq);
+			votes[j] = vsubq_u8(votes[j], eq);
+		}
+	}
+
+	uint8x16_t count = vdupq_n_u8(0), best = vdupq_n_u8(0), bestVotes = vdupq_n_u8(0);
+	for (int i = 0; i < 8; i++) {
+		uint8x16_t solid = vtstq_u8(v[i], v[i]);
+		count = vsubq_u8(count, solid);
+		uint8x16_t candidate = vandq_u8(votes[i], solid);
+		uint8x16_t take = vcgtq_u8(candidate, bestVotes);
+		best = vbslq_u8(take, v[i], best);
+		bestVotes = vmaxq_u8(candidate, bestVotes);
+	}
+
+	vst1q_u8(materials, best);
+	vst1q_u16(counts, vmovl_u8(vget_low_u8(count)));
+	vst1q_u16(counts + 8, vmovl_u8(vget_high_u8(count)));
+}
+#endif
+
+int LodDownsampler::vectorWidth() {
+#if defined(LOD_X86)
+	static const bool avx2 = cpuHasAvx2();
+	return avx2 ? 32 : 1;
+#elif defined(LOD_NEON)
+	return 16;
+#else
+	return 1;
+#endif
+}
+
+void LodDownsampler::reduceVoxelsScalar(const uint8_t* voxels, const glm::ivec3& size, uint16_t* counts, uint8_t* materials) {
+	const glm::ivec3 grid = size / 2;
+	for (int z = 0; z < grid.z; z++) {
+		for (int y = 0; y < grid.y; y++) reduceRowScalar(voxels, size, y, z, 0, grid.x, counts, materials);
+	}
+}
+
+void LodDownsampler::reduceVoxels(const uint8_t* voxels, const glm::ivec3& size, uint16_t* counts, uint8_t* materials) {
+	const glm::ivec3 grid = size / 2;
+#if defined(LOD_X86) || defined(LOD_NEON)
+	// Tramos de 16 bloques de una fila; con grid.x mltiplo de 16 la salida de
+	// cada tramo es contigua y van uno detrs de otro
+	if (grid.x % 16 == 0 && vectorWidth() > 1) {
+		const int sx = size.x, plane = size.x * size.y;
+		const int unitsPerRow = grid.x / 16;
+		const int units = unitsPerRow * grid.y * grid.z;
+		auto source = [&](int unit) {
+			int row = unit / unitsPerRow;
+			int x = (unit % unitsPerRow) * 16;
+			return voxels + (2 * (row / grid.y) * size.y + 2 * (row % grid.y)) * sx + 2 * x;
+		};
+#ifdef LOD_X86
+		int unit = 0;
+		for (; unit + 1 < units; unit += 2) {
+			reduceUnitsAvx2(source(unit), source(unit + 1), sx, plane,
+				counts + unit * 16, materials + unit * 16, counts + (unit + 1) * 16, materials + (unit + 1) * 16);
+		}
+		if (unit < units) {
+			int row = unit / unitsPerRow;
+			int x = (unit % unitsPerRow) * 16;
+			reduceRowScalar(voxels, size, row % grid.y, row / grid.y, x, x + 16, counts, materials);
+		}
+#else
+		for (int unit = 0; unit < units; unit++) {
+			reduceUnitNeon(source(unit), sx, plane, counts + unit * 16, materials + unit * 16);
+		}
+#endif
+		return;
+	}
+#endif
+	reduceVoxelsScalar(voxels, size, counts, materials);
+}
+
+void LodDownsampler::reduceLevel(const uint16_t* counts, const uint8_t* materials, const glm::ivec3& size,
+	uint16_t* outCounts, uint8_t* outMaterials) {
+	const glm::ivec3 grid = size / 2;
+	const int sx = size.x, plane = size.x * size.y;
+	const int offsets[8] = { 0, 1, sx, sx + 1, plane, plane + 1, plane + sx, plane + sx + 1 };
+
+	for (int z = 0; z < grid.z; z++) {
+		for (int y = 0; y < grid.y; y++) {
+			int in = (2 * z * size.y + 2 * y) * sx;
+			int out = (z * grid.y + y) * grid.x;
+			for (int x = 0; x < grid.x; x++) {
+				int base = in + 2 * x;
+				int total = 0;
+				uint8_t first = 0;
+				bool mixed = false;
+				for (int i = 0; i < 8; i++) {
+					int c = counts[base + offsets[i]];
+					if (c == 0) continue;
+					total += c;
+					uint8_t m = materials[base + offsets[i]];
+					if (first == 0) first = m;
+					else if (m != first) mixed = true;
+				}
+				outCounts[out + x] = (uint16_t)total;
+				outMaterials[out + x] = first;
+				// Lo normal: un solo material entre los hijos slidos
+				if (!mixed) continue;
+
+				int bestVotes = 0;
+				uint8_t best = 0;
+				for (int i = 0; i < 8; i++) {
+					if (counts[base + offsets[i]] == 0) continue;
+					// Cada hijo vota su material con tantos votos como slidos tiene
+					uint8_t m = materials[base + offsets[i]];
+					int votes = 0;
+					for (int j = 0; j < 8; j++) {
+						if (materials[base + offsets[j]] == m) votes += counts[base + offsets[j]];
+					}
+					if (votes > bestVotes) {
+						bestVotes = votes;
+						best = m;
+					}
+				}
+				outMaterials[out + x] = best;
+			}
+		}
+	}
+}
+
+void LodDownsampler::build(const uint8_t* voxels, const glm::ivec3& size, int levelCount) {
+	levels = 0;
+	sizes[0] = size;
+	for (int k = 1; k <= std::min(levelCount, kMaxLevels); k++) {
+		glm::ivec3 s = sizes[k - 1] / 2;
+		if (s.x == 0 || s.y == 0 || s.z == 0) break;
+		sizes[k] = s;
+		size_t n = (size_t)s.x * s.y * s.z;
+		counts[k].resize(n);
+		materials[k].resize(n);
+		if (k == 1) reduceVoxels(voxels, size, counts[1].data(), materials[1].data());
+		else reduceLevel(counts[k - 1].data(), materials[k - 1].data(), sizes[k - 1], counts[k].data(), materials[k].data());
+		levels = k;
+	}
+}
@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(const std::string& filePath) {
+	close();
+	path = filePath;
+
+#ifdef _WIN32
+	// Compartido para escritura: el escritor de regiones sigue aadiendo datos
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+	fileHandle = handle;
+#else
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+#endif
+
+	return remap();
+}
+
+void MappedFile::unmap() {
+#ifdef _WIN32
+	if (mapped) UnmapViewOfFile(mapped);
+	if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+	mappingHandle = nullptr;
+#else
+	if (mapped) munmap((void*)mapped, mappedSize);
+#endif
+	mapped = nullptr;
+	mappedSize = 0;
+}
+
+bool MappedFile::remap() {
+	unmap();
+
+#ifdef _WIN32
+	if (!fileHandle) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx((HANDLE)fileHandle, &fileSize) || fileSize.QuadPart == 0) return false;
+
+	HANDLE mapping = CreateFileMappingA((HANDLE)fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) return false;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	mappingHandle = mapping;
+	mapped = (const uint8_t*)view;
+	mappedSize = (size_t)fileSize.QuadPart;
+#else
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) return false;
+
+	void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (view == MAP_FAILED) {
+		std::cerr << "mmap failed: " << path << std::endl;
+		return false;
+	}
+
+	mapped = (const uint8_t*)view;
+	mappedSize = (size_t)st.st_size;
+#endif
+
+	return true;
+}
+
+void MappedFile::close() {
+	unmap();
+
+#ifdef _WIN32
+	if (fileHandle) CloseHandle((HANDLE)fileHandle);
+	fileHandle = nullptr;
+#else
+	if (fd >= 0) ::close(fd);
+	fd = -1;
+#endif
+}
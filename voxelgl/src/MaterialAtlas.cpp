@@ -0,0 +1,165 @@
+#include "MaterialAtlas.h"
+#include <algorithm>
+#include <iostream>
+
+MaterialAtlas::MaterialAtlas() {}
+
+MaterialAtlas::~MaterialAtlas() {
+	if (textureID != 0) {
+		glDeleteTextures(1, &textureID);
+	}
+}
+
+bool MaterialAtlas::create(int size, int maxMaterials) {
+	if (size <= 0 || (size & (size - 1)) != 0 || maxMaterials <= 0) {
+		std::cerr << "MaterialAtlas: invalid size " << size << std::endl;
+		return false;
+	}
+
+	tileSize = size;
+	layerCount = maxMaterials;
+	mipLevels = 1;
+	while ((size >> mipLevels) > 0) mipLevels++;
+
+	readyLevel.assign(layerCount, -1);
+	lastLevelPixels.assign(layerCount, std::vector<uint8_t>());
+	pendingLayers.clear();
+	maxLevelSet = -1;
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	// Reservar todos los niveles (GL 4.0: sin glTexStorage3D)
+	for (int level = 0; level < mipLevels; level++) {
+		int levelSize = std::max(1, tileSize >> level);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, layerCount,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	// UVs en unidades de voxel: la textura se repite a lo largo del quad
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+	maxLevelSet = 0;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return true;
+}
+
+void MaterialAtlas::uploadLevel(int layer, int level, const uint8_t* rgba) {
+	int levelSize = std::max(1, tileSize >> level);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelSize, levelSize, 1,
+		GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void MaterialAtlas::setMaterialTexture(uint32_t material, const uint8_t* rgba) {
+	if (textureID == 0 || (int)material >= layerCount) return;
+
+	int layer = (int)material;
+	uploadLevel(layer, 0, rgba);
+
+	lastLevelPixels[layer].assign(rgba, rgba + tileSize * tileSize * 4);
+	readyLevel[layer] = 0;
+
+	if (mipLevels > 1 &&
+		std::find(pendingLayers.begin(), pendingLayers.end(), layer) == pendingLayers.end()) {
+		pendingLayers.push_back(layer);
+	}
+}
+
+void MaterialAtlas::setMaterialColor(uint32_t material, const glm::vec3& color, float alpha, float holes) {
+	std::vector<uint8_t> pixels(tileSize * tileSize * 4);
+
+	for (int y = 0; y < tileSize; y++) {
+		for (int x = 0; x < tileSize; x++) {
+			// Hash entero barato para variar el tono por texel
+			uint32_t h = (uint32_t)(x * 73856093) ^ (uint32_t)(y * 19349663) ^ (material * 83492791u);
+			h = (h ^ (h >> 13)) * 1274126177u;
+			float shade = 0.85f + 0.15f * (float)(h & 0xFF) / 255.0f;
+
+			glm::vec3 c = glm::clamp(color * shade, 0.0f, 1.0f);
+			int idx = (y * tileSize + x) * 4;
+			pixels[idx + 0] = (uint8_t)(c.r * 255.0f);
+			pixels[idx + 1] = (uint8_t)(c.g * 255.0f);
+			pixels[idx + 2] = (uint8_t)(c.b * 255.0f);
+			bool hole = (float)((h >> 8) & 0xFF) / 255.0f < holes;
+			pixels[idx + 3] = hole ? 0 : (uint8_t)(glm::clamp(alpha, 0.0f, 1.0f) * 255.0f);
+		}
+	}
+
+	setMaterialTexture(material, pixels.data());
+}
+
+void MaterialAtlas::update(int budget) {
+	while (budget > 0 && !pendingLayers.empty()) {
+		int layer = pendingLayers.front();
+		int srcLevel = readyLevel[layer];
+		int srcSize = std::max(1, tileSize >> srcLevel);
+		int dstSize = std::max(1, srcSize >> 1);
+
+		// Filtro de caja 2x2 sobre el nivel anterior
+		const std::vector<uint8_t>& src = lastLevelPixels[layer];
+		std::vector<uint8_t> dst(dstSize * dstSize * 4);
+		for (int y = 0; y < dstSize; y++) {
+			for (int x = 0; x < dstSize; x++) {
+				int sx = x * 2, sy = y * 2;
+				int sx1 = std::min(sx + 1, srcSize - 1);
+				int sy1 = std::min(sy + 1, srcSize - 1);
+				for (int c = 0; c < 4; c++) {
+					int sum = src[(sy * srcSize + sx) * 4 + c] +
+						src[(sy * srcSize + sx1) * 4 + c] +
+						src[(sy1 * srcSize + sx) * 4 + c] +
+						src[(sy1 * srcSize + sx1) * 4 + c];
+					dst[(y * dstSize + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+				}
+			}
+		}
+
+		uploadLevel(layer, srcLevel + 1, dst.data());
+		lastLevelPixels[layer].swap(dst);
+		readyLevel[layer] = srcLevel + 1;
+
+		if (readyLevel[layer] >= mipLevels - 1) {
+			pendingLayers.pop_front();
+			lastLevelPixels[layer].clear();
+			lastLevelPixels[layer].shrink_to_fit();
+		}
+		else {
+			// Round-robin: cada capa avanza un nivel por turno
+			pendingLayers.pop_front();
+			pendingLayers.push_back(layer);
+		}
+		budget--;
+	}
+
+	updateMaxLevel();
+}
+
+void MaterialAtlas::updateMaxLevel() {
+	// Solo exponer niveles que todas las capas usadas ya tienen
+	int level = mipLevels - 1;
+	bool anyLayer = false;
+	for (int layer = 0; layer < layerCount; layer++) {
+		if (readyLevel[layer] < 0) continue;
+		level = std::min(level, readyLevel[layer]);
+		anyLayer = true;
+	}
+	if (!anyLayer) level = 0;
+
+	if (level != maxLevelSet) {
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		maxLevelSet = level;
+	}
+}
+
+void MaterialAtlas::bind(GLuint unit) const {
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+}
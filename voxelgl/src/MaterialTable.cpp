@@ -0,0 +1,24 @@
+#include "MaterialTable.h"
+
+const uint8_t MaterialTable::kAir;
+const uint8_t MaterialTable::kGrass;
+const uint8_t MaterialTable::kDirt;
+const uint8_t MaterialTable::kStone;
+const uint8_t MaterialTable::kLamp;
+const uint8_t MaterialTable::kGlass;
+const uint8_t MaterialTable::kLeaves;
+const uint8_t MaterialTable::kWater;
+
+MaterialTable::MaterialTable() {
+	// Sin registrar: opaco, como cualquier material de terreno
+	properties[kAir].kind = MaterialKind::Air;
+	properties[kLamp].emission = 15;
+	properties[kGlass].kind = MaterialKind::Translucent;
+	properties[kLeaves].kind = MaterialKind::Cutout;
+	properties[kWater].kind = MaterialKind::Translucent;
+}
+
+MaterialTable& MaterialTable::get() {
+	static MaterialTable instance;
+	return instance;
+}
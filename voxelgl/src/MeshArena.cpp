@@ -0,0 +1,52 @@
+#include "MeshArena.h"
+
+MeshArena::MeshArena(size_t maxRetainedBytes, size_t maxMeshBytes)
+	: maxRetainedBytes(maxRetainedBytes), maxMeshBytes(maxMeshBytes) {
+}
+
+size_t MeshArena::capacityBytes(const Mesh& mesh) {
+	return mesh.vertices.capacity() * sizeof(Vertex) + mesh.indices.capacity() * sizeof(uint32_t);
+}
+
+void MeshArena::acquire(std::vector<Mesh>& meshes, size_t count) {
+	meshes.resize(count);
+	std::lock_guard<std::mutex> lock(mutex);
+	for (Mesh& mesh : meshes) {
+		if (freeMeshes.empty()) {
+			created++;
+			mesh.clear();
+			continue;
+		}
+		retainedBytes -= capacityBytes(freeMeshes.back());
+		mesh = std::move(freeMeshes.back());
+		freeMeshes.pop_back();
+		reused++;
+	}
+}
+
+void MeshArena::release(std::vector<Mesh>& meshes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (Mesh& mesh : meshes) {
+		size_t bytes = capacityBytes(mesh);
+		if (bytes == 0 || bytes > maxMeshBytes || retainedBytes + bytes > maxRetainedBytes) continue;
+		mesh.clear();
+		retainedBytes += bytes;
+		freeMeshes.push_back(std::move(mesh));
+	}
+	meshes.clear();
+}
+
+size_t MeshArena::getRetainedBytes() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return retainedBytes;
+}
+
+uint64_t MeshArena::getReused() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return reused;
+}
+
+uint64_t MeshArena::getCreated() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return created;
+}
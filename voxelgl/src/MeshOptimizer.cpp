@@ -0,0 +1,217 @@
+#include "MeshOptimizer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <numeric>
+
+const int MeshOptimizer::kCacheSize;
+
+float MeshOptimizer::acmr(const uint32_t* indices, size_t count, size_t vertexCount, int cacheSize) {
+	if (count < 3) return 0.0f;
+	// FIFO: un vrtice est en cach si entr hace menos de cacheSize fallos
+	std::vector<uint32_t> stamp(vertexCount, 0);
+	uint32_t time = (uint32_t)cacheSize + 1;
+	size_t misses = 0;
+	for (size_t i = 0; i < count; i++) {
+		uint32_t v = indices[i];
+		if (time - stamp[v] > (uint32_t)cacheSize) {
+			stamp[v] = time++;
+			misses++;
+		}
+	}
+	return (float)misses / (float)(count / 3);
+}
+
+float MeshOptimizer::cacheMissRatio(const uint32_t* indices, size_t count, size_t vertexCount) {
+	if (count < 3) return 0.0f;
+	cacheStamp.assign(vertexCount, 0);
+	uint32_t time = kCacheSize + 1;
+	size_t misses = 0;
+	for (size_t i = 0; i < count; i++) {
+		uint32_t v = indices[i];
+		if (time - cacheStamp[v] > (uint32_t)kCacheSize) {
+			cacheStamp[v] = time++;
+			misses++;
+		}
+	}
+	return (float)misses / (float)(count / 3);
+}
+
+// Tipsify (Sander, Nehab y Barczak 2007): recorre abanicos alrededor de un vrtice
+// y salta al vecino que seguir en cach tras emitir los tringulos que le quedan.
+void MeshOptimizer::tipsify(uint32_t* indices, size_t count, size_t vertexCount) {
+	const size_t triangleCount = count / 3;
+	const uint32_t cacheSize = kCacheSize;
+
+	adjacencyOffset.assign(vertexCount + 1, 0);
+	for (size_t i = 0; i < count; i++) adjacencyOffset[indices[i] + 1]++;
+	std::partial_sum(adjacencyOffset.begin(), adjacencyOffset.end(), adjacencyOffset.begin());
+	live.assign(adjacencyOffset.begin() + 1, adjacencyOffset.end());
+	for (size_t v = 0; v < vertexCount; v++) live[v] -= adjacencyOffset[v];
+	adjacency.resize(count);
+	{
+		std::vector<uint32_t>& fill = remap;
+		fill.assign(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < count; i++) adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	cacheStamp.assign(vertexCount, 0);
+	emitted.assign(triangleCount, 0);
+	deadEnd.clear();
+	output.clear();
+	output.reserve(count);
+
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	int64_t fan = 0;
+	while (cursor < vertexCount && live[cursor] == 0) cursor++;
+	fan = cursor < vertexCount ? (int64_t)cursor : -1;
+
+	while (fan >= 0) {
+		candidates.clear();
+		for (uint32_t a = adjacencyOffset[fan]; a < adjacencyOffset[fan + 1]; a++) {
+			uint32_t t = adjacency[a];
+			if (emitted[t]) continue;
+			emitted[t] = 1;
+			for (int k = 0; k < 3; k++) {
+				uint32_t v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cacheStamp[v] > cacheSize) cacheStamp[v] = time++;
+			}
+		}
+
+		// Siguiente abanico: el candidato vivo que ms tiempo lleve en cach sin
+		// salirse de ella al emitir lo que le queda
+		fan = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t v : candidates) {
+			if (live[v] == 0) continue;
+			int64_t priority = 0;
+			if (time - cacheStamp[v] + 2 * live[v] <= cacheSize) priority = time - cacheStamp[v];
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				fan = v;
+			}
+		}
+		if (fan >= 0) continue;
+
+		// Callejn sin salida: vrtices recientes y despus el primero con vida
+		while (!deadEnd.empty()) {
+			uint32_t v = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[v] > 0) {
+				fan = v;
+				break;
+			}
+		}
+		if (fan >= 0) continue;
+		while (cursor < vertexCount && live[cursor] == 0) cursor++;
+		if (cursor < vertexCount) fan = cursor;
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+// Primero los que miran hacia fuera; a igualdad, en su orden (std::sort no reserva
+// memoria temporal, std::stable_sort s)
+static bool byOutwardFacing(const MeshOptimizer::Cluster& a, const MeshOptimizer::Cluster& b) {
+	return a.sortKey > b.sortKey || (a.sortKey == b.sortKey && a.begin < b.begin);
+}
+
+// Grupos: tramos que empiezan en un tringulo con sus 3 vrtices fuera de la cach.
+// Se dibujan primero los que miran hacia fuera de la malla, que suelen tapar al resto.
+void MeshOptimizer::sortForOverdraw(const std::vector<Vertex>& vertices, uint32_t* indices, size_t count) {
+	clusters.clear();
+	glm::vec3 meshCentroid(0.0f);
+	for (size_t i = 0; i < count; i++) meshCentroid += vertices[indices[i]].position;
+	meshCentroid /= (float)count;
+
+	cacheStamp.assign(vertices.size(), 0);
+	uint32_t time = kCacheSize + 1;
+	for (size_t t = 0; t < count; t += 3) {
+		int misses = 0;
+		for (int k = 0; k < 3; k++) {
+			uint32_t v = indices[t + k];
+			if (time - cacheStamp[v] > (uint32_t)kCacheSize) {
+				cacheStamp[v] = time++;
+				misses++;
+			}
+		}
+		if (misses == 3 || clusters.empty()) clusters.push_back({ (uint32_t)t, (uint32_t)t, 0.0f });
+		clusters.back().end = (uint32_t)t + 3;
+	}
+	if (clusters.size() < 2) return;
+
+	for (Cluster& cluster : clusters) {
+		glm::vec3 centroid(0.0f), normal(0.0f);
+		for (uint32_t t = cluster.begin; t < cluster.end; t += 3) {
+			const glm::vec3& p0 = vertices[indices[t]].position;
+			const glm::vec3& p1 = vertices[indices[t + 1]].position;
+			const glm::vec3& p2 = vertices[indices[t + 2]].position;
+			centroid += p0 + p1 + p2;
+			normal += glm::cross(p1 - p0, p2 - p0);
+		}
+		centroid /= (float)(cluster.end - cluster.begin);
+		float length = glm::length(normal);
+		cluster.sortKey = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+	}
+	std::sort(clusters.begin(), clusters.end(), byOutwardFacing);
+
+	output.clear();
+	for (const Cluster& cluster : clusters) {
+		output.insert(output.end(), indices + cluster.begin, indices + cluster.end);
+	}
+	// Cortar en ms sitios puede empeorar la cach: solo se acepta hasta un 5%
+	if (cacheMissRatio(output.data(), count, vertices.size()) <= cacheMissRatio(indices, count, vertices.size()) * 1.05f) {
+		std::copy(output.begin(), output.end(), indices);
+	}
+}
+
+// Vrtices por orden de primer uso, para que la lectura del VBO sea secuencial
+void MeshOptimizer::remapVertices(Mesh& mesh) {
+	const uint32_t unused = 0xFFFFFFFFu;
+	remap.assign(mesh.vertices.size(), unused);
+	sortedVertices.clear();
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == unused) {
+			remap[index] = (uint32_t)sortedVertices.size();
+			sortedVertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	mesh.vertices.assign(sortedVertices.begin(), sortedVertices.end());
+}
+
+void MeshOptimizer::optimize(Mesh& mesh) {
+	PROFILE_SCOPE("Mesher: optimize");
+	if (mesh.quads || mesh.indices.size() < 6) return;
+
+	const size_t vertexCount = mesh.vertices.size();
+	const size_t opaqueCount = mesh.indices.size() - mesh.translucentIndexCount;
+	const size_t ranges[2][2] = { { 0, opaqueCount }, { opaqueCount, mesh.indices.size() } };
+	for (const auto& range : ranges) {
+		uint32_t* indices = mesh.indices.data() + range[0];
+		size_t count = range[1] - range[0];
+		if (count < 6) continue;
+
+		// Cota inferior: cada vrtice usado se transforma al menos una vez
+		remap.assign(vertexCount, 0);
+		size_t used = 0;
+		for (size_t i = 0; i < count; i++) {
+			used += remap[indices[i]] == 0;
+			remap[indices[i]] = 1;
+		}
+		float before = cacheMissRatio(indices, count, vertexCount);
+		if (before > (float)used / (float)(count / 3)) {
+			original.assign(indices, indices + count);
+			tipsify(indices, count, vertexCount);
+			if (cacheMissRatio(indices, count, vertexCount) > before) {
+				std::copy(original.begin(), original.end(), indices);
+			}
+		}
+		sortForOverdraw(mesh.vertices, indices, count);
+	}
+	remapVertices(mesh);
+}
@@ -0,0 +1,43 @@
+#include "MortonLayout.h"
+#include <cstring>
+
+const uint16_t MortonLayout::spread[32] = {
+	0x0000, 0x0001, 0x0008, 0x0009, 0x0040, 0x0041, 0x0048, 0x0049,
+	0x0200, 0x0201, 0x0208, 0x0209, 0x0240, 0x0241, 0x0248, 0x0249,
+	0x1000, 0x1001, 0x1008, 0x1009, 0x1040, 0x1041, 0x1048, 0x1049,
+	0x1200, 0x1201, 0x1208, 0x1209, 0x1240, 0x1241, 0x1248, 0x1249
+};
+
+// Un bloque 2x2x2 son 8 bytes seguidos en Morton y 4 pares de bytes en lineal:
+// (y, z), (y + 1, z), (y, z + 1), (y + 1, z + 1)
+void MortonLayout::fromLinear(const uint8_t* linear, uint8_t* morton) {
+	for (int z = 0; z < 32; z += 2) {
+		for (int y = 0; y < 32; y += 2) {
+			const uint8_t* row = linear + (z * 32 + y) * 32;
+			int base = spread[y] << 1 | spread[z] << 2;
+			for (int x = 0; x < 32; x += 2) {
+				uint8_t* block = morton + (base | spread[x]);
+				std::memcpy(block, row + x, 2);
+				std::memcpy(block + 2, row + 32 + x, 2);
+				std::memcpy(block + 4, row + 1024 + x, 2);
+				std::memcpy(block + 6, row + 1056 + x, 2);
+			}
+		}
+	}
+}
+
+void MortonLayout::toLinear(const uint8_t* morton, uint8_t* linear) {
+	for (int z = 0; z < 32; z += 2) {
+		for (int y = 0; y < 32; y += 2) {
+			uint8_t* row = linear + (z * 32 + y) * 32;
+			int base = spread[y] << 1 | spread[z] << 2;
+			for (int x = 0; x < 32; x += 2) {
+				const uint8_t* block = morton + (base | spread[x]);
+				std::memcpy(row + x, block, 2);
+				std::memcpy(row + 32 + x, block + 2, 2);
+				std::memcpy(row + 1024 + x, block + 4, 2);
+				std::memcpy(row + 1056 + x, block + 6, 2);
+			}
+		}
+	}
+}
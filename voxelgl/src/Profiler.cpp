@@ -0,0 +1,176 @@
+#include "Profiler.h"
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+const int Profiler::kEventsPerThread;
+const int Profiler::kFrameHistory;
+const uint32_t Profiler::kGpuTrack;
+
+Profiler::Profiler() {
+	epochNs = nowNs();
+	frameStartNs = 0;
+	for (int i = 0; i < kFrameHistory; i++) frameTimes[i] = 0.0f;
+
+	gpuBuffer.threadId = kGpuTrack;
+	gpuBuffer.threadName = "GPU";
+	gpuBuffer.events.resize(kEventsPerThread);
+}
+
+Profiler::~Profiler() {
+	// Los buffers sobreviven a sus hilos: se liberan aqu
+	for (ThreadBuffer* buffer : threads) delete buffer;
+}
+
+Profiler& Profiler::get() {
+	static Profiler instance;
+	return instance;
+}
+
+uint64_t Profiler::nowNs() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer() {
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (buffer) return buffer;
+
+	buffer = new ThreadBuffer();
+	buffer->events.resize(kEventsPerThread);
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	buffer->threadId = (uint32_t)threads.size() + 1;
+	buffer->threadName = "thread " + std::to_string(buffer->threadId);
+	threads.push_back(buffer);
+	return buffer;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+	ThreadBuffer* buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(registryMutex);
+	buffer->threadName = name;
+}
+
+void Profiler::push(ThreadBuffer* buffer, const char* name, uint64_t startNs, uint64_t durationNs) {
+	// Solo escribe el hilo dueo; el ndice atmico publica el evento
+	uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+	ProfileEvent& ev = buffer->events[index % kEventsPerThread];
+	ev.name = name;
+	ev.startNs = startNs;
+	ev.durationNs = durationNs;
+	buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs) {
+	if (!isEnabled()) return;
+	push(threadBuffer(), name, startNs, endNs - startNs);
+}
+
+void Profiler::recordGpu(const char* name, uint64_t startNs, uint64_t durationNs) {
+	if (!isEnabled()) return;
+	push(&gpuBuffer, name, startNs, durationNs);
+}
+
+void Profiler::beginFrame() {
+	frameStartNs = nowNs();
+}
+
+void Profiler::endFrame() {
+	if (frameStartNs == 0) return;
+	uint64_t end = nowNs();
+	record("Frame", frameStartNs, end);
+
+	frameTimes[frameHead] = (float)((end - frameStartNs) / 1.0e6);
+	frameHead = (frameHead + 1) % kFrameHistory;
+	frameCount = std::min(frameCount + 1, kFrameHistory);
+	frameStartNs = 0;
+}
+
+FrameStats Profiler::getFrameStats() const {
+	FrameStats stats;
+	if (frameCount == 0) return stats;
+
+	std::vector<float> sorted(frameTimes, frameTimes + frameCount);
+	std::sort(sorted.begin(), sorted.end());
+
+	float sum = 0.0f;
+	for (float t : sorted) sum += t;
+
+	auto percentile = [&](float p) {
+		int idx = (int)(p * (sorted.size() - 1) + 0.5f);
+		return sorted[idx];
+	};
+
+	stats.samples = frameCount;
+	stats.avgMs = sum / frameCount;
+	stats.p50Ms = percentile(0.50f);
+	stats.p95Ms = percentile(0.95f);
+	stats.p99Ms = percentile(0.99f);
+	stats.maxMs = sorted.back();
+	return stats;
+}
+
+static void writeJsonString(std::ofstream& out, const std::string& value) {
+	out << '"';
+	for (char c : value) {
+		if (c == '"' || c == '\\') out << '\\';
+		out << c;
+	}
+	out << '"';
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) {
+	std::ofstream out(path);
+	if (!out.is_open()) {
+		std::cerr << "Failed to open trace file: " << path << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	std::vector<ThreadBuffer*> all(threads);
+	all.push_back(&gpuBuffer);
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+
+	for (ThreadBuffer* buffer : all) {
+		// Metadatos: nombre del track
+		if (!first) out << ",\n";
+		first = false;
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+			<< ",\"args\":{\"name\":";
+		writeJsonString(out, buffer->threadName);
+		out << "}}";
+
+		uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+		uint64_t begin = end > (uint64_t)kEventsPerThread ? end - kEventsPerThread : 0;
+
+		for (uint64_t i = begin; i < end; i++) {
+			const ProfileEvent& ev = buffer->events[i % kEventsPerThread];
+			double ts = (double)(ev.startNs - epochNs) / 1000.0;
+			double dur = (double)ev.durationNs / 1000.0;
+
+			out << ",\n{\"name\":";
+			writeJsonString(out, ev.name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+		}
+	}
+
+	out << "\n]}\n";
+	std::cout << "Trace exported: " << path << std::endl;
+	return true;
+}
+
+void Profiler::clear() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (ThreadBuffer* buffer : threads) buffer->writeIndex.store(0, std::memory_order_release);
+	gpuBuffer.writeIndex.store(0, std::memory_order_release);
+	frameCount = 0;
+	frameHead = 0;
+}
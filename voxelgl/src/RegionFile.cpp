@@ -0,0 +1,524 @@
+#include "RegionFile.h"
+#include "Profiler.h"
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+#include <sstream>
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void makeDirectory(const std::string& path) {
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+static bool seekFile(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// fflush + fsync: al volver los datos estn en disco, no solo en la cach
+static bool syncFile(FILE* file) {
+	if (fflush(file) != 0) return false;
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+static bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 35 && p < end; shift += 7) {
+		uint8_t b = *p++;
+		value |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) return true;
+	}
+	return false;
+}
+
+// ---------------------------------------------------------------------------
+// RegionFile
+
+const int RegionFile::kRegionSize;
+const int RegionFile::kEntries;
+const uint32_t RegionFile::kMagic;
+const uint32_t RegionFile::kVersion;
+const int RegionFile::kTableOffset;
+const int RegionFile::kHeaderSize;
+
+int RegionFile::localIndex(const glm::ivec3& chunkPos) {
+	glm::ivec3 local = chunkPos & glm::ivec3(kRegionSize - 1);
+	return (local.z * kRegionSize + local.y) * kRegionSize + local.x;
+}
+
+glm::ivec3 RegionFile::regionOf(const glm::ivec3& chunkPos) {
+	// Desplazamiento aritmtico: redondea hacia abajo tambin en negativos
+	return glm::ivec3(chunkPos.x >> 5, chunkPos.y >> 5, chunkPos.z >> 5);
+}
+
+void RegionFile::encode(const uint8_t* voxels, size_t count, std::vector<uint8_t>& out) {
+	out.clear();
+	out.resize(5);
+	uint32_t rawSize = (uint32_t)count;
+	memcpy(out.data(), &rawSize, 4);
+
+	// RLE: (valor, longitud varint). Los chunks son casi siempre tramos largos
+	size_t i = 0;
+	while (i < count) {
+		uint8_t value = voxels[i];
+		size_t run = 1;
+		while (i + run < count && voxels[i + run] == value) run++;
+		out.push_back(value);
+		writeVarint(out, (uint32_t)run);
+		i += run;
+	}
+
+	if (out.size() - 5 >= count) {
+		// El RLE no compensa (ruido): guardar en crudo
+		out.resize(5 + count);
+		memcpy(out.data() + 5, voxels, count);
+		out[4] = CodecRaw;
+	}
+	else {
+		out[4] = CodecRLE;
+	}
+}
+
+bool RegionFile::decode(const uint8_t* data, size_t size, std::vector<uint8_t>& voxels, size_t expectedSize) {
+	if (size < 5) return false;
+
+	uint32_t rawSize;
+	memcpy(&rawSize, data, 4);
+	uint8_t codec = data[4];
+	// Un payload vaco o de otro tamao dejara el chunk sin voxels
+	if (expectedSize != 0 && rawSize != expectedSize) return false;
+	voxels.resize(rawSize);
+
+	const uint8_t* p = data + 5;
+	const uint8_t* end = data + size;
+
+	if (codec == CodecRaw) {
+		if ((size_t)(end - p) != rawSize) return false;
+		memcpy(voxels.data(), p, rawSize);
+		return true;
+	}
+	if (codec != CodecRLE) return false;
+
+	size_t written = 0;
+	while (p < end) {
+		uint8_t value = *p++;
+		uint32_t run;
+		if (!readVarint(p, end, run) || written + run > rawSize) return false;
+		memset(voxels.data() + written, value, run);
+		written += run;
+	}
+	return written == rawSize;
+}
+
+RegionFile::~RegionFile() {
+	if (writer) fclose(writer);
+}
+
+bool RegionFile::open(const std::string& filePath, bool create) {
+	path = filePath;
+
+	std::ifstream probe(path, std::ios::binary);
+	bool exists = probe.good();
+	probe.close();
+
+	if (!exists) {
+		if (!create) return false;
+
+		// Cabecera nueva con la tabla vaca. Se escribe aparte y se renombra: una
+		// creacin fallida no deja una regin a medias que ya no se podra abrir
+		std::string tempPath = path + ".tmp";
+		FILE* out = fopen(tempPath.c_str(), "wb");
+		bool created = out != nullptr;
+		if (out) {
+			uint32_t header[4] = { kMagic, kVersion, (uint32_t)kRegionSize, 0 };
+			std::vector<RegionEntry> empty(kEntries, RegionEntry{ 0, 0 });
+			created = fwrite(header, sizeof(header), 1, out) == 1 &&
+				fwrite(empty.data(), sizeof(RegionEntry), empty.size(), out) == empty.size() &&
+				syncFile(out);
+			created = fclose(out) == 0 && created;
+		}
+		if (!created || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+			std::cerr << "Failed to create region file: " << path << std::endl;
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	if (!map.open(path) || map.size() < (size_t)kHeaderSize) {
+		std::cerr << "Invalid region file: " << path << std::endl;
+		return false;
+	}
+
+	uint32_t header[4];
+	memcpy(header, map.data(), sizeof(header));
+	if (header[0] != kMagic || header[1] != kVersion || header[2] != (uint32_t)kRegionSize) {
+		std::cerr << "Unsupported region file: " << path << std::endl;
+		return false;
+	}
+
+	table.resize(kEntries);
+	memcpy(table.data(), map.data() + kTableOffset, kEntries * sizeof(RegionEntry));
+	fileSize = map.size();
+	rebuildFreeExtents();
+
+	writer = fopen(path.c_str(), "r+b");
+	if (!writer) {
+		std::cerr << "Failed to open region file for writing: " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool RegionFile::contains(int index) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return table[index].size != 0;
+}
+
+bool RegionFile::read(int index, std::vector<uint8_t>& voxels, size_t expectedSize) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	RegionEntry entry = table[index];
+	if (entry.size == 0) return false;
+
+	// El fichero creci desde el ltimo mapeo
+	if ((size_t)entry.offset + entry.size > map.size() && !map.remap()) return false;
+	if ((size_t)entry.offset + entry.size > map.size()) return false;
+
+	if (decode(map.data() + entry.offset, entry.size, voxels, expectedSize)) return true;
+	std::cerr << "Invalid chunk payload in region file: " << path << std::endl;
+	return false;
+}
+
+void RegionFile::rebuildFreeExtents() {
+	// Lo que queda entre payloads referenciados (versiones antiguas ya sustituidas)
+	std::vector<RegionEntry> used;
+	for (const RegionEntry& entry : table) {
+		if (entry.size != 0) used.push_back(entry);
+	}
+	std::sort(used.begin(), used.end(), [](const RegionEntry& a, const RegionEntry& b) { return a.offset < b.offset; });
+
+	freeExtents.clear();
+	uint64_t cursor = kHeaderSize;
+	for (const RegionEntry& entry : used) {
+		if (entry.offset > cursor) freeExtents[cursor] = entry.offset - cursor;
+		cursor = std::max(cursor, (uint64_t)entry.offset + entry.size);
+	}
+	if (fileSize > cursor) freeExtents[cursor] = fileSize - cursor;
+}
+
+uint64_t RegionFile::allocate(uint32_t size, uint64_t& end) {
+	for (auto it = freeExtents.begin(); it != freeExtents.end(); ++it) {
+		if (it->second < size) continue;
+		uint64_t offset = it->first;
+		uint64_t rest = it->second - size;
+		freeExtents.erase(it);
+		if (rest > 0) freeExtents[offset + size] = rest;
+		return offset;
+	}
+	uint64_t offset = end;
+	end += size;
+	return offset;
+}
+
+void RegionFile::release(uint64_t offset, uint64_t size) {
+	if (size == 0) return;
+
+	// Unir con los huecos vecinos
+	auto next = freeExtents.lower_bound(offset);
+	if (next != freeExtents.end() && offset + size == next->first) {
+		size += next->second;
+		next = freeExtents.erase(next);
+	}
+	if (next != freeExtents.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+	freeExtents[offset] = size;
+}
+
+uint64_t RegionFile::getFreeBytes() const {
+	uint64_t bytes = 0;
+	for (const auto& extent : freeExtents) bytes += extent.second;
+	return bytes;
+}
+
+bool RegionFile::append(const std::vector<std::pair<int, std::vector<uint8_t>>>& payloads) {
+	std::vector<RegionEntry> entries;
+	entries.reserve(payloads.size());
+
+	// 1. Sitio para cada payload: huecos libres o el final, nunca encima de uno referenciado
+	uint64_t end = fileSize;
+	bool fits = true;
+	for (const auto& payload : payloads) {
+		uint32_t size = (uint32_t)payload.second.size();
+		uint64_t offset = allocate(size, end);
+		if (offset + size > UINT32_MAX) fits = false;
+		entries.push_back(RegionEntry{ (uint32_t)offset, size });
+	}
+	if (!fits) {
+		std::cerr << "Region file exceeds 32-bit offsets: " << path << std::endl;
+		for (const RegionEntry& entry : entries) {
+			if (entry.offset < fileSize) release(entry.offset, entry.size);
+		}
+		return false;
+	}
+
+	// Payloads en disco antes de que la tabla los apunte
+	bool ok = true;
+	for (size_t i = 0; i < payloads.size() && ok; i++) {
+		ok = seekFile(writer, entries[i].offset) &&
+			fwrite(payloads[i].second.data(), 1, entries[i].size, writer) == entries[i].size;
+	}
+	ok = ok && syncFile(writer);
+
+	// 2. Solo despus se apuntan las entradas: un corte a medias deja la versin anterior
+	for (size_t i = 0; i < payloads.size() && ok; i++) {
+		ok = seekFile(writer, kTableOffset + payloads[i].first * sizeof(RegionEntry)) &&
+			fwrite(&entries[i], sizeof(RegionEntry), 1, writer) == 1;
+	}
+	ok = ok && syncFile(writer);
+
+	if (!ok) {
+		std::cerr << "Failed to write region file: " << path << std::endl;
+		clearerr(writer);
+		// La tabla en disco puede apuntar ya a parte de los payloads nuevos: ni
+		// ellos ni los anteriores se reutilizan hasta reabrir (rebuildFreeExtents)
+		fileSize = std::max(fileSize, end);
+		return false;
+	}
+
+	std::vector<RegionEntry> replaced;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < payloads.size(); i++) {
+			replaced.push_back(table[payloads[i].first]);
+			table[payloads[i].first] = entries[i];
+		}
+		fileSize = end;
+	}
+
+	// Las versiones sustituidas ya no las referencia la tabla: su sitio queda libre
+	for (const RegionEntry& entry : replaced) release(entry.offset, entry.size);
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// RegionStore
+
+RegionStore::RegionStore(const std::string& worldDirectory) : directory(worldDirectory) {
+	makeDirectory(directory);
+	writerThread = std::thread(&RegionStore::writerLoop, this);
+}
+
+RegionStore::~RegionStore() {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueCv.notify_all();
+	if (writerThread.joinable()) writerThread.join();
+
+	size_t lost = 0;
+	for (const auto& entry : pending) lost += entry.second.failed ? 1 : 0;
+	if (lost > 0) std::cerr << "Region store: " << lost << " chunks could not be saved" << std::endl;
+}
+
+uint64_t RegionStore::packKey(const glm::ivec3& pos) {
+	// 21 bits con signo por eje
+	return ((uint64_t)(pos.x & 0x1FFFFF) << 42) | ((uint64_t)(pos.y & 0x1FFFFF) << 21) | (uint64_t)(pos.z & 0x1FFFFF);
+}
+
+glm::ivec3 RegionStore::unpackKey(uint64_t key) {
+	auto field = [](uint64_t v) {
+		int value = (int)(v & 0x1FFFFF);
+		return value >= 0x100000 ? value - 0x200000 : value;
+	};
+	return glm::ivec3(field(key >> 42), field(key >> 21), field(key));
+}
+
+std::string RegionStore::regionPath(const glm::ivec3& regionPos) const {
+	std::ostringstream name;
+	name << directory << "/r." << regionPos.x << "." << regionPos.y << "." << regionPos.z << ".vxr";
+	return name.str();
+}
+
+RegionFile* RegionStore::getRegion(const glm::ivec3& regionPos, bool create) {
+	std::lock_guard<std::mutex> lock(regionsMutex);
+
+	uint64_t key = packKey(regionPos);
+	auto it = regions.find(key);
+	if (it != regions.end()) return it->second.get();
+
+	std::unique_ptr<RegionFile> region(new RegionFile());
+	if (!region->open(regionPath(regionPos), create)) return nullptr;
+
+	RegionFile* result = region.get();
+	regions[key] = std::move(region);
+	return result;
+}
+
+bool RegionStore::loadChunk(const glm::ivec3& chunkPos, std::vector<uint8_t>& voxels, size_t expectedSize) {
+	uint64_t key = packKey(chunkPos);
+
+	// Un guardado an en cola tiene los datos ms recientes
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		auto it = pending.find(key);
+		if (it != pending.end()) {
+			if (expectedSize != 0 && it->second.voxels->size() != expectedSize) return false;
+			voxels = *it->second.voxels;
+			chunksLoaded++;
+			return true;
+		}
+	}
+
+	RegionFile* region = getRegion(RegionFile::regionOf(chunkPos), false);
+	if (!region) return false;
+
+	PROFILE_SCOPE("Region: load chunk");
+	if (!region->read(RegionFile::localIndex(chunkPos), voxels, expectedSize)) return false;
+
+	chunksLoaded++;
+	return true;
+}
+
+void RegionStore::saveChunkAsync(const glm::ivec3& chunkPos, const std::vector<uint8_t>& voxels) {
+	std::shared_ptr<std::vector<uint8_t>> copy = std::make_shared<std::vector<uint8_t>>(voxels);
+	uint64_t key = packKey(chunkPos);
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		PendingSave& save = pending[key];
+		save.voxels = copy;
+		save.failed = false;
+		if (!save.queued) {
+			save.queued = true;
+			queue.push_back(key);
+		}
+	}
+	queueCv.notify_one();
+}
+
+bool RegionStore::flush() {
+	std::unique_lock<std::mutex> lock(queueMutex);
+
+	// Un reintento para los guardados que fallaron (siguen en 'pending')
+	for (auto& entry : pending) {
+		if (entry.second.failed && !entry.second.queued) {
+			entry.second.failed = false;
+			entry.second.queued = true;
+			queue.push_back(entry.first);
+		}
+	}
+	queueCv.notify_one();
+
+	idleCv.wait(lock, [this] { return queue.empty() && !writing; });
+	for (const auto& entry : pending) {
+		if (entry.second.failed) return false;
+	}
+	return true;
+}
+
+void RegionStore::writerLoop() {
+	Profiler::get().setThreadName("region writer");
+
+	while (true) {
+		std::vector<uint64_t> batch;
+		std::vector<std::shared_ptr<std::vector<uint8_t>>> snapshots;
+
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCv.wait(lock, [this] { return !queue.empty() || stopping; });
+			if (queue.empty() && stopping) break;
+
+			batch.swap(queue);
+			for (uint64_t key : batch) {
+				PendingSave& save = pending[key];
+				save.queued = false;
+				snapshots.push_back(save.voxels);
+			}
+			writing = true;
+		}
+
+		PROFILE_SCOPE("Region: write batch");
+
+		// Agrupar por regin: una escritura secuencial y un flush por fichero
+		std::unordered_map<uint64_t, std::vector<std::pair<int, std::vector<uint8_t>>>> byRegion;
+		for (size_t i = 0; i < batch.size(); i++) {
+			glm::ivec3 chunkPos = unpackKey(batch[i]);
+			std::vector<uint8_t> payload;
+			RegionFile::encode(snapshots[i]->data(), snapshots[i]->size(), payload);
+
+			byRegion[packKey(RegionFile::regionOf(chunkPos))].push_back(
+				std::make_pair(RegionFile::localIndex(chunkPos), std::move(payload)));
+		}
+
+		std::vector<bool> failed(batch.size(), false);
+		for (auto& entry : byRegion) {
+			RegionFile* region = getRegion(unpackKey(entry.first), true);
+
+			uint64_t bytes = 0;
+			for (const auto& payload : entry.second) bytes += payload.second.size();
+
+			if (region && region->append(entry.second)) {
+				chunksSaved += entry.second.size();
+				bytesWritten += bytes;
+				continue;
+			}
+
+			std::cerr << "Region store: failed to save " << entry.second.size() << " chunks to "
+				<< regionPath(unpackKey(entry.first)) << std::endl;
+			saveErrors += entry.second.size();
+			for (size_t i = 0; i < batch.size(); i++) {
+				if (packKey(RegionFile::regionOf(unpackKey(batch[i]))) == entry.first) failed[i] = true;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			// Quitar de pendientes solo si no lleg un guardado ms nuevo. Los fallidos
+			// se quedan: loadChunk sigue viendo los datos y flush() los reintenta.
+			for (size_t i = 0; i < batch.size(); i++) {
+				auto it = pending.find(batch[i]);
+				if (it == pending.end() || it->second.voxels != snapshots[i] || it->second.queued) continue;
+				if (failed[i]) it->second.failed = true;
+				else pending.erase(it);
+			}
+			writing = false;
+		}
+		idleCv.notify_all();
+	}
+}
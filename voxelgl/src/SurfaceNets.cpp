@@ -0,0 +1,237 @@
+#include "SurfaceNets.h"
+#include "Profiler.h"
+#include <iostream>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int countTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (int)index;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+// Por configuracin de las 8 esquinas de una celda (bit i: esquina x = i & 1,
+// y = (i >> 1) & 1, z = i >> 2 slida): posicin del vrtice en la celda (media
+// de los puntos medios de las aristas que cruzan) y normal (de slido a aire).
+struct CellConfig {
+	glm::vec3 offset;
+	glm::vec3 normal;
+};
+
+struct CellTable {
+	CellConfig configs[256];
+};
+
+static CellTable buildCellTable() {
+	CellTable table;
+	static const int edges[12][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },  // X
+		{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },  // Y
+		{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }   // Z
+	};
+	for (int config = 0; config < 256; config++) {
+		glm::vec3 sum(0.0f), gradient(0.0f);
+		int crossings = 0;
+		for (int e = 0; e < 12; e++) {
+			int a = edges[e][0], b = edges[e][1];
+			if (((config >> a) & 1) == ((config >> b) & 1)) continue;
+			glm::vec3 pa(a & 1, (a >> 1) & 1, a >> 2);
+			glm::vec3 pb(b & 1, (b >> 1) & 1, b >> 2);
+			sum += (pa + pb) * 0.5f;
+			crossings++;
+		}
+		for (int i = 0; i < 8; i++) {
+			glm::vec3 corner(i & 1, (i >> 1) & 1, i >> 2);
+			if ((config >> i) & 1) gradient -= corner * 2.0f - 1.0f;
+		}
+		table.configs[config].offset = crossings ? sum / (float)crossings : glm::vec3(0.5f);
+		table.configs[config].normal = glm::length(gradient) > 0.0f ? glm::normalize(gradient) : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+	return table;
+}
+
+// La primera llamada la construye (inicializacin esttica segura entre hilos)
+static const CellConfig* cellConfigs() {
+	static const CellTable table = buildCellTable();
+	return table.configs;
+}
+
+void SurfaceNets::downsample(const uint8_t* voxels, const glm::ivec3& size, int factor) {
+	int level = 0;
+	while ((2 << level) <= factor) level++;
+	downsampler.build(voxels, size, level);
+	if (downsampler.getLevels() < level) {
+		coarse.clear();
+		return;
+	}
+
+	glm::ivec3 grid = downsampler.getSize(level);
+	const uint16_t* counts = downsampler.getCounts(level);
+	const uint8_t* materials = downsampler.getMaterials(level);
+	int half = factor * factor * factor / 2;
+	coarse.resize(grid.x * grid.y * grid.z);
+	for (size_t i = 0; i < coarse.size(); i++) coarse[i] = counts[i] >= half ? materials[i] : 0;
+}
+
+Mesh SurfaceNets::generate(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, int lodLevel) {
+	Mesh mesh;
+	generate(voxels, size, light, lodLevel, mesh);
+	return mesh;
+}
+
+void SurfaceNets::generate(const uint8_t* voxels, const glm::ivec3& size, const uint8_t* light, int lodLevel, Mesh& mesh) {
+	PROFILE_SCOPE("Mesher: surface nets");
+	mesh.clear();
+
+	const int factor = 1 << lodLevel;
+	glm::ivec3 grid = size;
+	const uint8_t* source = voxels;
+	if (lodLevel > 0) {
+		downsample(voxels, size, factor);
+		grid = size / factor;
+		source = coarse.data();
+		light = nullptr;
+	}
+
+	const glm::ivec3 padded = grid + glm::ivec3(2);
+	const glm::ivec3 cells = grid + glm::ivec3(1);
+	if (padded.x > 64) {
+		std::cerr << "SurfaceNets: chunk rows wider than 62 voxels are not supported" << std::endl;
+		return;
+	}
+
+	// Ocupacin por filas y materiales, con un borde de aire
+	rows.assign(padded.y * padded.z, 0);
+	paddedVoxels.assign(padded.x * padded.y * padded.z, 0);
+	for (int z = 0; z < grid.z; z++) {
+		for (int y = 0; y < grid.y; y++) {
+			const uint8_t* row = &source[(z * grid.y + y) * grid.x];
+			uint8_t* out = &paddedVoxels[((z + 1) * padded.y + y + 1) * padded.x + 1];
+			uint64_t bits = 0;
+			for (int x = 0; x < grid.x; x++) {
+				out[x] = row[x];
+				bits |= (uint64_t)(row[x] != 0) << (x + 1);
+			}
+			rows[(z + 1) * padded.y + y + 1] = bits;
+		}
+	}
+
+	const CellConfig* configs = cellConfigs();
+	const uint64_t cellBits = (1ull << cells.x) - 1;
+	const int paddedStride[3] = { 1, padded.x, padded.x * padded.y };
+	const glm::vec3 scale((float)factor);
+	const glm::vec3 bias = glm::vec3(-1.0f) * (float)factor + glm::vec3((factor - 1) * 0.5f);
+	cellVertex.resize(cells.x * cells.y * cells.z);
+
+	// Vrtices: 64 celdas a la vez. Una celda cruza la superficie si alguna de sus
+	// esquinas es slida y no lo son todas.
+	for (int cz = 0; cz < cells.z; cz++) {
+		for (int cy = 0; cy < cells.y; cy++) {
+			const uint64_t r[4] = {
+				rows[cz * padded.y + cy], rows[cz * padded.y + cy + 1],
+				rows[(cz + 1) * padded.y + cy], rows[(cz + 1) * padded.y + cy + 1]
+			};
+			uint64_t any = r[0] | r[1] | r[2] | r[3];
+			uint64_t all = r[0] & r[1] & r[2] & r[3];
+			uint64_t mixed = (any | (any >> 1)) & ~(all & (all >> 1)) & cellBits;
+
+			while (mixed) {
+				int cx = countTrailingZeros(mixed);
+				mixed &= mixed - 1;
+
+				int config = 0;
+				for (int i = 0; i < 8; i++) {
+					config |= (int)((r[i >> 1] >> (cx + (i & 1))) & 1) << i;
+				}
+				const CellConfig& cell = configs[config];
+
+				// Material y luz: primera esquina slida; media de las de aire
+				int base = (cz * padded.y + cy) * padded.x + cx;
+				uint32_t material = 0;
+				uint32_t sky = 0, block = 0, airCount = 0;
+				for (int i = 0; i < 8; i++) {
+					int index = base + (i & 1) * paddedStride[0] + ((i >> 1) & 1) * paddedStride[1] + (i >> 2) * paddedStride[2];
+					if ((config >> i) & 1) {
+						if (material == 0) material = paddedVoxels[index];
+					}
+					else if (light) {
+						sky += light[index] >> 4;
+						block += light[index] & 0x0F;
+						airCount++;
+					}
+				}
+				uint32_t lightValue = kFullSkyLight | (255u << 16);
+				if (airCount > 0) {
+					sky = sky * 255 / (15 * airCount);
+					block = block * 255 / (15 * airCount);
+					lightValue = sky | (block << 8) | (255u << 16);
+				}
+
+				glm::vec3 pos = (glm::vec3(cx, cy, cz) + cell.offset) * scale + bias;
+				glm::vec3 n = glm::abs(cell.normal);
+				// Proyeccin plana en el eje dominante de la normal
+				glm::vec2 uv = (n.x >= n.y && n.x >= n.z) ? glm::vec2(pos.z, pos.y)
+					: (n.y >= n.z) ? glm::vec2(pos.x, pos.z) : glm::vec2(pos.x, pos.y);
+
+				cellVertex[(cz * cells.y + cy) * cells.x + cx] = (uint32_t)mesh.vertices.size();
+				mesh.vertices.emplace_back(pos, cell.normal, uv, material, lightValue);
+			}
+		}
+	}
+
+	// Quads: por cada arista entre voxels vecinos con slido a un lado y aire al
+	// otro, las 4 celdas que la rodean. La normal va de slido a aire.
+	auto cellAt = [&](int x, int y, int z) { return cellVertex[(z * cells.y + y) * cells.x + x]; };
+	auto emitQuad = [&](uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint64_t positive) {
+		if (positive) {
+			mesh.indices.insert(mesh.indices.end(), { c0, c1, c2, c0, c2, c3 });
+		}
+		else {
+			mesh.indices.insert(mesh.indices.end(), { c0, c2, c1, c0, c3, c2 });
+		}
+	};
+
+	// Aristas en X: (x, x + 1) dentro de la fila. Celdas en (y, z) - {0, 1}
+	for (int z = 1; z <= grid.z; z++) {
+		for (int y = 1; y <= grid.y; y++) {
+			const uint64_t row = rows[z * padded.y + y];
+			uint64_t cross = (row ^ (row >> 1)) & cellBits;
+			while (cross) {
+				int x = countTrailingZeros(cross);
+				cross &= cross - 1;
+				emitQuad(cellAt(x, y - 1, z - 1), cellAt(x, y, z - 1), cellAt(x, y, z), cellAt(x, y - 1, z), (row >> x) & 1);
+			}
+		}
+	}
+
+	// Aristas en Y: fila contra la de encima (desde el borde). Celdas en (z, x) - {0, 1}
+	for (int z = 1; z <= grid.z; z++) {
+		for (int y = 0; y <= grid.y; y++) {
+			const uint64_t row = rows[z * padded.y + y];
+			uint64_t cross = row ^ rows[z * padded.y + y + 1];
+			while (cross) {
+				int x = countTrailingZeros(cross);
+				cross &= cross - 1;
+				emitQuad(cellAt(x - 1, y, z - 1), cellAt(x - 1, y, z), cellAt(x, y, z), cellAt(x, y, z - 1), (row >> x) & 1);
+			}
+		}
+	}
+
+	// Aristas en Z: fila contra la de delante (desde el borde). Celdas en (x, y) - {0, 1}
+	for (int z = 0; z <= grid.z; z++) {
+		for (int y = 1; y <= grid.y; y++) {
+			const uint64_t row = rows[z * padded.y + y];
+			uint64_t cross = row ^ rows[(z + 1) * padded.y + y];
+			while (cross) {
+				int x = countTrailingZeros(cross);
+				cross &= cross - 1;
+				emitQuad(cellAt(x - 1, y - 1, z), cellAt(x, y - 1, z), cellAt(x, y, z), cellAt(x - 1, y, z), (row >> x) & 1);
+			}
+		}
+	}
+}
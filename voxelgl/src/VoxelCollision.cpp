@@ -0,0 +1,292 @@
+#include "VoxelCollision.h"
+#include "VoxelWorld.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const float VoxelCollision::kContactGap = 0.001f;
+
+static uint32_t chunkId(const glm::ivec3& coord) {
+	return (coord.x << 20) | (coord.y << 10) | coord.z;
+}
+
+static bool boxesTouch(const AABB& a, const AABB& b) {
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+		a.min.y <= b.max.y && a.max.y >= b.min.y &&
+		a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// Solape estricto: dos cajas que solo se tocan no colisionan
+static bool boxesOverlap(const AABB& a, const AABB& b) {
+	return a.min.x < b.max.x && a.max.x > b.min.x &&
+		a.min.y < b.max.y && a.max.y > b.min.y &&
+		a.min.z < b.max.z && a.max.z > b.min.z;
+}
+
+static AABB sweptBounds(const AABB& box, const glm::vec3& delta) {
+	AABB bounds;
+	bounds.min = glm::min(box.min, box.min + delta);
+	bounds.max = glm::max(box.max, box.max + delta);
+	return bounds;
+}
+
+VoxelCollision::VoxelCollision(VoxelWorld* voxelWorld) : world(voxelWorld) {}
+
+VoxelCollision::~VoxelCollision() {}
+
+void VoxelCollision::buildColliders(const Chunk* chunk, int chunkSize, GreedyMesher& mesher, ChunkColliders& out) {
+	out.revision = chunk->revision;
+	out.boxes.clear();
+	if (chunk->content == ChunkContent::Empty) return;
+
+	glm::vec3 chunkMin = glm::vec3(chunk->position * chunkSize);
+	if (chunk->content == ChunkContent::Uniform) {
+		out.boxes.push_back({ chunkMin - 0.5f, chunkMin + (float)chunkSize - 0.5f });
+		return;
+	}
+
+	std::vector<uint8_t> linear;
+	std::vector<Cuboid> cuboids = mesher.greedy3DBinary(chunk->linearVoxels(linear).data(), glm::ivec3(chunkSize));
+	out.boxes.reserve(cuboids.size());
+	for (const Cuboid& c : cuboids) {
+		out.boxes.push_back({ chunkMin + glm::vec3(c.min) - 0.5f, chunkMin + glm::vec3(c.max) + 0.5f });
+	}
+}
+
+const std::vector<AABB>* VoxelCollision::colliders(const glm::ivec3& coord, bool build, std::vector<AABB>& unloaded) {
+	glm::ivec3 worldSize = world->getWorldSize();
+	if (coord.x < 0 || coord.x >= worldSize.x || coord.y < 0 || coord.y >= worldSize.y ||
+		coord.z < 0 || coord.z >= worldSize.z) return nullptr;
+
+	int chunkSize = world->getChunkSize();
+	const Chunk* chunk = world->findGeneratedChunk(coord.x, coord.y, coord.z);
+	auto it = chunk ? cache.find(chunkId(coord)) : cache.end();
+	bool fresh = it != cache.end() && it->second->revision == chunk->revision;
+
+	if (chunk && !fresh && build) {
+		PROFILE_SCOPE("Collision: build colliders");
+		std::unique_ptr<ChunkColliders>& entry = cache[chunkId(coord)];
+		if (!entry) entry.reset(new ChunkColliders());
+		buildColliders(chunk, chunkSize, mesher, *entry);
+		return &entry->boxes;
+	}
+	if (fresh) return &it->second->boxes;
+
+	// Sin generar (o sin preparar en un batch): bloquea entero
+	glm::vec3 chunkMin = glm::vec3(coord * chunkSize);
+	unloaded.assign(1, AABB{ chunkMin - 0.5f, chunkMin + (float)chunkSize - 0.5f });
+	return &unloaded;
+}
+
+template<typename Visit>
+void VoxelCollision::forEachBox(const AABB& bounds, bool build, Visit visit) {
+	int chunkSize = world->getChunkSize();
+	// Voxels que toca la caja -> chunks (divisin con redondeo hacia abajo)
+	glm::ivec3 first = glm::ivec3(glm::floor((bounds.min + 0.5f) / (float)chunkSize));
+	glm::ivec3 last = glm::ivec3(glm::floor((bounds.max + 0.5f) / (float)chunkSize));
+	std::vector<AABB> unloaded;
+
+	for (int cz = first.z; cz <= last.z; cz++) {
+		for (int cy = first.y; cy <= last.y; cy++) {
+			for (int cx = first.x; cx <= last.x; cx++) {
+				const std::vector<AABB>* boxes = colliders(glm::ivec3(cx, cy, cz), build, unloaded);
+				if (!boxes) continue;
+				for (const AABB& box : *boxes) {
+					if (boxesTouch(bounds, box)) visit(box);
+				}
+			}
+		}
+	}
+}
+
+float VoxelCollision::sweep(const AABB& box, const glm::vec3& delta, bool build, int& axis) {
+	const float inf = std::numeric_limits<float>::infinity();
+	float tFirst = 1.0f;
+	axis = -1;
+
+	forEachBox(sweptBounds(box, delta), build, [&](const AABB& solid) {
+		float tEntry = -inf, tExit = inf;
+		int entryAxis = -1;
+		for (int a = 0; a < 3; a++) {
+			if (delta[a] == 0.0f) {
+				// Sin movimiento en el eje: o ya solapan en l o nunca chocan
+				if (box.max[a] <= solid.min[a] || box.min[a] >= solid.max[a]) return;
+				continue;
+			}
+			float inv = 1.0f / delta[a];
+			float t0 = delta[a] > 0.0f ? (solid.min[a] - box.max[a]) * inv : (solid.max[a] - box.min[a]) * inv;
+			float t1 = delta[a] > 0.0f ? (solid.max[a] - box.min[a]) * inv : (solid.min[a] - box.max[a]) * inv;
+			if (t0 > tEntry) {
+				tEntry = t0;
+				entryAxis = a;
+			}
+			tExit = std::min(tExit, t1);
+		}
+		if (entryAxis < 0 || tEntry >= tExit || tExit <= 0.0f) return;
+
+		if (tEntry < 0.0f) {
+			// Penetracin por redondeo dentro del margen de contacto: choca ya.
+			// Ms profunda: empez dentro y se le deja salir.
+			if (-tEntry * std::fabs(delta[entryAxis]) > kContactGap) return;
+			tEntry = 0.0f;
+		}
+		if (tEntry < tFirst) {
+			tFirst = tEntry;
+			axis = entryAxis;
+		}
+	});
+	return tFirst;
+}
+
+MoveResult VoxelCollision::resolveMove(const AABB& box, const glm::vec3& delta, bool build) {
+	MoveResult result;
+	result.box = box;
+	glm::vec3 remaining = delta;
+
+	// Cada choque anula un eje: como mucho tres barridos
+	for (int i = 0; i < 3; i++) {
+		if (remaining == glm::vec3(0.0f)) break;
+
+		int axis;
+		float t = sweep(result.box, remaining, build, axis);
+		if (axis < 0) {
+			result.box.min += remaining;
+			result.box.max += remaining;
+			result.delta += remaining;
+			break;
+		}
+
+		// Parar kContactGap antes del slido para poder deslizar sobre l
+		float tMove = std::max(0.0f, t - kContactGap / std::fabs(remaining[axis]));
+		glm::vec3 step = remaining * tMove;
+		result.box.min += step;
+		result.box.max += step;
+		result.delta += step;
+
+		result.blocked[axis] = remaining[axis] > 0.0f ? 1 : -1;
+		remaining -= step;
+		remaining[axis] = 0.0f;
+	}
+
+	result.onGround = result.blocked.y < 0;
+	return result;
+}
+
+float VoxelCollision::sweep(const AABB& box, const glm::vec3& delta, glm::vec3& normal) {
+	int axis;
+	float t = sweep(box, delta, true, axis);
+	normal = glm::vec3(0.0f);
+	if (axis >= 0) normal[axis] = delta[axis] > 0.0f ? -1.0f : 1.0f;
+	return t;
+}
+
+MoveResult VoxelCollision::move(const AABB& box, const glm::vec3& delta) {
+	return resolveMove(box, delta, true);
+}
+
+bool VoxelCollision::overlaps(const AABB& box) {
+	// Voxels que solapan estrictamente la caja (v ocupa [v - 0.5, v + 0.5])
+	int chunkSize = world->getChunkSize();
+	glm::ivec3 worldMax = world->getWorldSize() * chunkSize - 1;
+	glm::ivec3 first = glm::max(glm::ivec3(glm::floor(box.min - 0.5f)) + 1, glm::ivec3(0));
+	glm::ivec3 last = glm::min(glm::ivec3(glm::ceil(box.max + 0.5f)) - 1, worldMax);
+	if (glm::any(glm::lessThan(last, first))) return false;
+
+	glm::ivec3 firstChunk = first / chunkSize;
+	glm::ivec3 lastChunk = last / chunkSize;
+	for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+		for (int cy = firstChunk.y; cy <= lastChunk.y; cy++) {
+			for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+				const Chunk* chunk = world->findGeneratedChunk(cx, cy, cz);
+				// Sin generar: bloquea entero
+				if (!chunk) return true;
+				glm::ivec3 chunkMin = glm::ivec3(cx, cy, cz) * chunkSize;
+				glm::ivec3 lo = glm::max(first, chunkMin) - chunkMin;
+				glm::ivec3 hi = glm::min(last, chunkMin + chunkSize - 1) - chunkMin;
+				if (chunk->anySolid(lo, hi)) return true;
+			}
+		}
+	}
+	return false;
+}
+
+int VoxelCollision::queryBoxes(const AABB& box, std::vector<AABB>& out) {
+	int count = 0;
+	forEachBox(box, true, [&](const AABB& solid) {
+		if (!boxesOverlap(box, solid)) return;
+		out.push_back(solid);
+		count++;
+	});
+	return count;
+}
+
+void VoxelCollision::prepare(const std::vector<AABB>& bounds) {
+	PROFILE_SCOPE("Collision: prepare");
+	int chunkSize = world->getChunkSize();
+	glm::ivec3 worldSize = world->getWorldSize();
+
+	// Chunks que tocan alguna consulta, sin repetir
+	std::vector<uint32_t> ids;
+	for (const AABB& b : bounds) {
+		glm::ivec3 first = glm::max(glm::ivec3(glm::floor((b.min + 0.5f) / (float)chunkSize)), glm::ivec3(0));
+		glm::ivec3 last = glm::min(glm::ivec3(glm::floor((b.max + 0.5f) / (float)chunkSize)), worldSize - 1);
+		for (int cz = first.z; cz <= last.z; cz++)
+			for (int cy = first.y; cy <= last.y; cy++)
+				for (int cx = first.x; cx <= last.x; cx++)
+					ids.push_back(chunkId(glm::ivec3(cx, cy, cz)));
+	}
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+	std::vector<const Chunk*> stale;
+	for (uint32_t id : ids) {
+		const Chunk* chunk = world->findGeneratedChunk(id >> 20, (id >> 10) & 0x3FF, id & 0x3FF);
+		if (!chunk) continue;
+		auto it = cache.find(id);
+		if (it == cache.end() || it->second->revision != chunk->revision) stale.push_back(chunk);
+	}
+	if (stale.empty()) return;
+
+	// Los cuboides de cada chunk se sacan en paralelo; la cach se toca despus
+	JobSystem* jobs = world->getJobSystem();
+	std::vector<std::unique_ptr<ChunkColliders>> built(stale.size());
+	std::vector<JobHandle> batch;
+	for (size_t i = 0; i < stale.size(); i++) {
+		batch.push_back(jobs->run([&stale, &built, chunkSize, i] {
+			thread_local GreedyMesher localMesher;
+			built[i].reset(new ChunkColliders());
+			buildColliders(stale[i], chunkSize, localMesher, *built[i]);
+		}, -1.0f));
+	}
+	for (const JobHandle& job : batch) jobs->wait(job);
+
+	for (size_t i = 0; i < stale.size(); i++) {
+		cache[chunkId(stale[i]->position)] = std::move(built[i]);
+	}
+}
+
+void VoxelCollision::moveBatch(const std::vector<MoveQuery>& queries, std::vector<MoveResult>& results) {
+	PROFILE_SCOPE("Collision: move batch");
+	results.resize(queries.size());
+
+	std::vector<AABB> bounds(queries.size());
+	for (size_t i = 0; i < queries.size(); i++) bounds[i] = sweptBounds(queries[i].box, queries[i].delta);
+	prepare(bounds);
+
+	// Con la cach preparada los workers solo leen
+	const size_t kQueriesPerJob = 128;
+	JobSystem* jobs = world->getJobSystem();
+	std::vector<JobHandle> batch;
+	batch.reserve(queries.size() / kQueriesPerJob + 1);
+
+	for (size_t begin = 0; begin < queries.size(); begin += kQueriesPerJob) {
+		size_t end = std::min(begin + kQueriesPerJob, queries.size());
+		batch.push_back(jobs->run([this, &queries, &results, begin, end] {
+			for (size_t i = begin; i < end; i++)
+				results[i] = resolveMove(queries[i].box, queries[i].delta, false);
+		}, -1.0f));
+	}
+	for (const JobHandle& job : batch) jobs->wait(job);
+}
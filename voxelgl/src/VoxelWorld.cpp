@@ -0,0 +1,1720 @@
+#include "VoxelWorld.h"
+#include "GLShader.h"
+#include "Profiler.h"
+#include "RegionFile.h"
+#include "EditJournal.h"
+#include "JobSystem.h"
+#include "LightEngine.h"
+#include "SurfaceNets.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <bitset>
+
+const int Chunk::kSectionSize;
+const uint8_t Chunk::kAllSections;
+
+static int popCount(uint32_t bits) {
+	return (int)std::bitset<32>(bits).count();
+}
+
+bool Chunk::anySolid(const glm::ivec3& lo, const glm::ivec3& hi) const {
+	if (occupancy.empty()) return uniformValue != 0;
+	uint32_t span = spanMask(lo.x, hi.x);
+	for (int z = lo.z; z <= hi.z; z++) {
+		const uint32_t* rows = &occupancy[z * 32];
+		for (int y = lo.y; y <= hi.y; y++) {
+			if (rows[y] & span) return true;
+		}
+	}
+	return false;
+}
+
+int Chunk::solidCount() const {
+	if (occupancy.empty()) return uniformValue != 0 ? 32 * 32 * 32 : 0;
+	int count = 0;
+	for (uint32_t row : occupancy) count += popCount(row);
+	return count;
+}
+
+int Chunk::combineOccupancy(const Chunk& a, const Chunk& b, OccupancyOp op, uint32_t* out) {
+	int count = 0;
+	for (int i = 0; i < 32 * 32; i++) {
+		uint32_t ra = a.occupancyRow(i & 31, i >> 5);
+		uint32_t rb = b.occupancyRow(i & 31, i >> 5);
+		uint32_t r;
+		switch (op) {
+		case OccupancyOp::And: r = ra & rb; break;
+		case OccupancyOp::Or: r = ra | rb; break;
+		case OccupancyOp::AndNot: r = ra & ~rb; break;
+		default: r = ra ^ rb; break;
+		}
+		out[i] = r;
+		count += popCount(r);
+	}
+	return count;
+}
+
+// Hash entero -> [0, 1) para el ruido de valor
+static float hashNoise(int x, int y, int z, uint32_t seed) {
+	uint32_t h = seed;
+	h ^= (uint32_t)x * 0x8da6b343u;
+	h ^= (uint32_t)y * 0xd8163841u;
+	h ^= (uint32_t)z * 0xcb1ab31fu;
+	h = (h ^ (h >> 16)) * 0x7feb352du;
+	h = (h ^ (h >> 15)) * 0x846ca68bu;
+	h ^= h >> 16;
+	return (h & 0xFFFFFF) / 16777216.0f;
+}
+
+// Hash del contenido de un chunk, por palabras de 64 bits
+static uint64_t hashVoxels(const std::vector<uint8_t>& voxels) {
+	uint64_t h = 0xcbf29ce484222325ull;
+	size_t words = voxels.size() / 8;
+	const uint8_t* data = voxels.data();
+	for (size_t i = 0; i < words; i++) {
+		uint64_t w;
+		memcpy(&w, data + i * 8, 8);
+		h = (h ^ w) * 0x100000001b3ull;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+static uint64_t hashUniform(uint8_t value) {
+	// Distinto de cualquier hashVoxels en la prctica; el valor va en los bits bajos
+	return 0x9E3779B97F4A7C00ull | value;
+}
+
+static float smoothStep(float t) {
+	return t * t * (3.0f - 2.0f * t);
+}
+
+VoxelWorld::VoxelWorld(int width, int height, int depth)
+	: worldWidth(width), worldHeight(height), worldDepth(depth) {
+	mesher = std::unique_ptr<GreedyMesher>(new GreedyMesher());
+	jobs = std::unique_ptr<JobSystem>(new JobSystem());
+	light = std::unique_ptr<LightEngine>(new LightEngine(this));
+}
+
+VoxelWorld::~VoxelWorld() {
+	// Ningn job puede seguir usando chunks ni el store
+	if (light) light->stop();
+	jobs->waitIdle();
+	jobs.reset();
+
+	// Las ediciones pendientes se escriben antes de cerrar las regiones
+	if (journal && journal->beginCompaction()) {
+		compactJournal();
+	}
+	else {
+		saveModifiedChunks();
+	}
+	if (regionStore) regionStore->flush();
+
+	// Las mallas compartidas se liberan con el ltimo chunk (con el contexto GL vivo)
+	chunks.clear();
+#ifndef VOXELGL_HEADLESS
+	if (quadIndexBuffer) glDeleteBuffers(1, &quadIndexBuffer);
+#endif
+}
+
+float VoxelWorld::noise3D(float x, float y, float z) {
+	int x0 = (int)std::floor(x), y0 = (int)std::floor(y), z0 = (int)std::floor(z);
+	float fx = smoothStep(x - x0), fy = smoothStep(y - y0), fz = smoothStep(z - z0);
+
+	// Interpolacin trilineal entre las 8 esquinas de la celda
+	float c000 = hashNoise(x0, y0, z0, seed), c100 = hashNoise(x0 + 1, y0, z0, seed);
+	float c010 = hashNoise(x0, y0 + 1, z0, seed), c110 = hashNoise(x0 + 1, y0 + 1, z0, seed);
+	float c001 = hashNoise(x0, y0, z0 + 1, seed), c101 = hashNoise(x0 + 1, y0, z0 + 1, seed);
+	float c011 = hashNoise(x0, y0 + 1, z0 + 1, seed), c111 = hashNoise(x0 + 1, y0 + 1, z0 + 1, seed);
+
+	float x00 = c000 + (c100 - c000) * fx, x10 = c010 + (c110 - c010) * fx;
+	float x01 = c001 + (c101 - c001) * fx, x11 = c011 + (c111 - c011) * fx;
+	float y0v = x00 + (x10 - x00) * fy, y1v = x01 + (x11 - x01) * fy;
+	return y0v + (y1v - y0v) * fz;
+}
+
+void VoxelWorld::generateChunkTerrain(Chunk* chunk) {
+	PROFILE_SCOPE("World: generate chunk");
+
+	glm::ivec3 origin = chunk->position * chunkSize;
+	float worldTop = (float)(worldHeight * chunkSize);
+
+	for (int z = 0; z < chunkSize; z++) {
+		for (int x = 0; x < chunkSize; x++) {
+			float wx = (float)(origin.x + x);
+			float wz = (float)(origin.z + z);
+
+			// Altura: fbm 2D de 4 octavas
+			float h = 0.0f, amp = 1.0f, freq = 1.0f / 64.0f, norm = 0.0f;
+			for (int octave = 0; octave < 4; octave++) {
+				h += noise3D(wx * freq, 0.0f, wz * freq) * amp;
+				norm += amp;
+				amp *= 0.5f;
+				freq *= 2.0f;
+			}
+			int height = (int)(worldTop * (0.25f + 0.4f * h / norm));
+
+			for (int y = 0; y < chunkSize; y++) {
+				int wy = origin.y + y;
+				if (wy > height) continue;
+
+				uint8_t material;
+				if (wy == height) material = 1;          // Hierba
+				else if (wy > height - 4) material = 2;  // Tierra
+				else material = 3;                       // Piedra
+
+				// Cuevas por debajo de la superficie
+				if (wy < height - 4 &&
+					noise3D(wx / 16.0f, wy / 12.0f, wz / 16.0f) > 0.72f) {
+					continue;
+				}
+
+				chunk->voxelData[z * 32 * 32 + y * 32 + x] = material;
+			}
+		}
+	}
+}
+
+void VoxelWorld::setWorkerCount(int count) {
+	jobs->waitIdle();
+	jobs = std::unique_ptr<JobSystem>(new JobSystem(count));
+}
+
+void VoxelWorld::setLighting(bool enabled) {
+	if (enabled == (light != nullptr)) return;
+	jobs->waitIdle();
+	if (!enabled) {
+		light.reset();
+		return;
+	}
+
+	// Mundo ya generado: se ilumina entero desde cero
+	light = std::unique_ptr<LightEngine>(new LightEngine(this));
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		if (!chunk->generated) continue;
+		chunk->lit = false;
+		light->requestChunk(chunk);
+	}
+}
+
+void VoxelWorld::setChunkLayout(ChunkLayout layout) {
+	if (layout == chunkLayout) return;
+	jobs->waitIdle();
+	std::lock_guard<std::mutex> lock(voxelMutex);
+	chunkLayout = layout;
+	for (auto& entry : chunks) {
+		if (entry.second->generated) entry.second->setLayout(layout);
+	}
+}
+
+void VoxelWorld::setMeshingMode(MeshingMode mode) {
+	if (mode == meshingMode) return;
+	meshingMode = mode;
+	for (auto& entry : chunks) {
+		entry.second->needsUpdate = true;
+		entry.second->dirtySections = Chunk::kAllSections;
+	}
+}
+
+void VoxelWorld::generateTerrain() {
+	PROFILE_SCOPE("World: generate terrain");
+
+	for (int cz = 0; cz < worldDepth; cz++) {
+		for (int cy = 0; cy < worldHeight; cy++) {
+			for (int cx = 0; cx < worldWidth; cx++) {
+				Chunk* chunk = getOrCreateChunk(cx, cy, cz);
+				if (chunk) requestGeneration(chunk, (float)cy);
+			}
+		}
+	}
+	jobs->waitIdle();
+
+	std::cout << "Terrain generated: " << totalChunks << " chunks" << std::endl;
+}
+
+int VoxelWorld::streamChunks(const glm::vec3& cameraPos) {
+	PROFILE_SCOPE("World: stream chunks");
+
+	glm::ivec3 center = glm::ivec3(glm::floor(cameraPos / (float)chunkSize));
+	float maxDist = (float)(renderDistance * chunkSize);
+	int requested = 0;
+
+	for (int cz = center.z - renderDistance; cz <= center.z + renderDistance; cz++) {
+		for (int cy = center.y - renderDistance; cy <= center.y + renderDistance; cy++) {
+			for (int cx = center.x - renderDistance; cx <= center.x + renderDistance; cx++) {
+				glm::vec3 chunkCenter = glm::vec3(cx, cy, cz) * (float)chunkSize + glm::vec3(chunkSize * 0.5f);
+				float dist = glm::length(chunkCenter - cameraPos);
+				if (dist > maxDist) continue;
+
+				Chunk* chunk = getOrCreateChunk(cx, cy, cz);
+				if (!chunk || chunk->generated || !JobSystem::isFinished(chunk->generateJob)) continue;
+				requestGeneration(chunk, jobPriority(chunk, cameraPos));
+				requested++;
+			}
+		}
+	}
+	return requested;
+}
+
+void VoxelWorld::requestGeneration(Chunk* chunk, float priority) {
+	// Un job cancelado que an no ha salido sigue siendo dueo de voxelData
+	if (chunk->generated || !JobSystem::isFinished(chunk->generateJob)) return;
+
+	uint32_t epoch = chunk->jobEpoch.load();
+	chunk->generateJob = jobs->run([this, chunk, epoch] {
+		if (chunk->jobEpoch.load() != epoch) {
+			cancelledJobs++;
+			return;
+		}
+		PROFILE_SCOPE("World: generate chunk");
+		loadOrGenerateChunk(chunk);
+	}, priority);
+}
+
+Chunk* VoxelWorld::ensureGenerated(int cx, int cy, int cz) {
+	Chunk* chunk = getOrCreateChunk(cx, cy, cz);
+	if (!chunk || chunk->generated) return chunk;
+
+	if (chunk->generateJob) jobs->wait(chunk->generateJob);
+	// El job pudo salir cancelado
+	if (!chunk->generated) loadOrGenerateChunk(chunk);
+	return chunk;
+}
+
+void VoxelWorld::loadOrGenerateChunk(Chunk* chunk) {
+	// needsUpdate ya viene a true de la construccin: el job no lo toca
+	if (!regionStore || !regionStore->loadChunk(chunk->position, chunk->voxelData, chunkSize * chunkSize * chunkSize))
+		generateChunkTerrain(chunk);
+	chunk->classify();
+	// Se genera y se carga en orden lineal; un chunk uniforme ya no tiene qu convertir
+	chunk->setLayout(chunkLayout);
+
+	// Publica voxelData para el hilo principal y los jobs de malla
+	chunk->generated.store(true, std::memory_order_release);
+	if (light) light->requestChunk(chunk);
+}
+
+void VoxelWorld::openRegionStore(const std::string& directory) {
+	regionStore = std::unique_ptr<RegionStore>(new RegionStore(directory));
+
+	journal = std::unique_ptr<EditJournal>(new EditJournal(directory));
+	if (!journal->open()) {
+		journal.reset();
+		return;
+	}
+	recoverJournal();
+}
+
+void VoxelWorld::recoverJournal() {
+	// Los chunks tocados se cargan ya para aplicarles las ediciones antes
+	// de que el streaming los genere desde las regiones
+	size_t replayed = journal->replay([this](const VoxelEdit& edit) {
+		int cx = (edit.x >= 0 ? edit.x : edit.x - chunkSize + 1) / chunkSize;
+		int cy = (edit.y >= 0 ? edit.y : edit.y - chunkSize + 1) / chunkSize;
+		int cz = (edit.z >= 0 ? edit.z : edit.z - chunkSize + 1) / chunkSize;
+		Chunk* chunk = ensureGenerated(cx, cy, cz);
+		if (!chunk) return;
+		std::unique_lock<std::mutex> lock = lockVoxels();
+		glm::ivec3 local(edit.x - cx * chunkSize, edit.y - cy * chunkSize, edit.z - cz * chunkSize);
+		chunk->setVoxel(local.x, local.y, local.z, edit.value);
+		touchNeighbors(chunk, local, local);
+		if (light) light->notifyEdit(glm::ivec3(edit.x, edit.y, edit.z));
+	});
+
+	if (replayed > 0) {
+		std::cout << "Edit journal replayed: " << replayed << " edits" << std::endl;
+		if (journal->beginCompaction()) compactJournal();
+	}
+}
+
+void VoxelWorld::compactJournal() {
+	PROFILE_SCOPE("World: compact journal");
+
+	// El journal ya est rotado: todo lo que contiene est en los chunks modificados
+	saveModifiedChunks();
+	journal->finishCompactionAsync(regionStore.get());
+}
+
+void VoxelWorld::updatePersistence() {
+	if (!journal) return;
+	// Con el journal en fallo las ediciones solo estn en los chunks: rotar abre
+	// uno nuevo y la compactacin guarda esos chunks en las regiones
+	if ((journal->needsCompaction() || journal->hasFailed()) && journal->beginCompaction()) {
+		compactJournal();
+	}
+}
+
+void VoxelWorld::saveModifiedChunks() {
+	if (!regionStore) return;
+
+	// Solo se copia a la cola; la escritura ocurre en el hilo de regiones
+	std::vector<uint8_t> linear;
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		if (!chunk->modified) continue;
+		regionStore->saveChunkAsync(chunk->position, chunk->linearVoxels(linear));
+		chunk->modified = false;
+	}
+}
+
+Chunk* VoxelWorld::getOrCreateChunk(int cx, int cy, int cz) {
+	if (cx < 0 || cx >= worldWidth || cy < 0 || cy >= worldHeight || cz < 0 || cz >= worldDepth)
+		return nullptr;
+
+	glm::ivec3 pos(cx, cy, cz);
+	uint32_t id = (pos.x << 20) | (pos.y << 10) | pos.z;
+
+	auto it = chunks.find(id);
+	if (it != chunks.end()) return it->second.get();
+
+	Chunk* chunk = new Chunk(pos);
+	{
+		// El job de luz busca en el mapa mientras el hilo principal inserta
+		std::unique_lock<std::mutex> lock = lockVoxels();
+		chunks[id] = std::unique_ptr<Chunk>(chunk);
+	}
+	totalChunks++;
+	return chunk;
+}
+
+std::unique_lock<std::mutex> VoxelWorld::lockVoxels() {
+	voxelLockWanted.store(true);
+	std::unique_lock<std::mutex> lock(voxelMutex);
+	voxelLockWanted.store(false);
+	return lock;
+}
+
+Chunk* VoxelWorld::findChunk(const glm::ivec3& pos) const {
+	if (pos.x < 0 || pos.x >= worldWidth || pos.y < 0 || pos.y >= worldHeight || pos.z < 0 || pos.z >= worldDepth)
+		return nullptr;
+
+	uint32_t id = (pos.x << 20) | (pos.y << 10) | pos.z;
+	auto it = chunks.find(id);
+	return it != chunks.end() ? it->second.get() : nullptr;
+}
+
+void VoxelWorld::touchNeighbors(const Chunk* chunk, const glm::ivec3& lo, const glm::ivec3& hi) {
+	for (int i = 0; i < 27; i++) {
+		glm::ivec3 offset(i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1);
+		if (offset == glm::ivec3(0)) continue;
+
+		// Solo los lados que toca la caja editada
+		bool touches = true;
+		for (int axis = 0; axis < 3; axis++) {
+			if (offset[axis] < 0 && lo[axis] > 0) touches = false;
+			if (offset[axis] > 0 && hi[axis] < chunkSize - 1) touches = false;
+		}
+		if (!touches) continue;
+
+		Chunk* neighbor = findChunk(chunk->position + offset);
+		if (!neighbor || !neighbor->generated) continue;
+		// En coordenadas del vecino la caja queda fuera, a un voxel de su borde
+		neighbor->needsUpdate = true;
+		neighbor->dirtySections |= Chunk::sectionsAround(lo - offset * chunkSize, hi - offset * chunkSize);
+	}
+}
+
+uint8_t VoxelWorld::getWorldVoxel(int wx, int wy, int wz) {
+	// Divisin con redondeo hacia abajo para coordenadas negativas
+	int cx = (wx >= 0 ? wx : wx - chunkSize + 1) / chunkSize;
+	int cy = (wy >= 0 ? wy : wy - chunkSize + 1) / chunkSize;
+	int cz = (wz >= 0 ? wz : wz - chunkSize + 1) / chunkSize;
+
+	if (cx < 0 || cx >= worldWidth || cy < 0 || cy >= worldHeight || cz < 0 || cz >= worldDepth)
+		return 0;
+
+	uint32_t id = (cx << 20) | (cy << 10) | cz;
+	auto it = chunks.find(id);
+	// Un chunk an en generacin se lee como aire (sin bloquear)
+	if (it == chunks.end() || !it->second->generated) return 0;
+
+	return it->second->getVoxel(wx - cx * chunkSize, wy - cy * chunkSize, wz - cz * chunkSize);
+}
+
+void VoxelWorld::setWorldVoxel(int wx, int wy, int wz, uint8_t value) {
+	int cx = (wx >= 0 ? wx : wx - chunkSize + 1) / chunkSize;
+	int cy = (wy >= 0 ? wy : wy - chunkSize + 1) / chunkSize;
+	int cz = (wz >= 0 ? wz : wz - chunkSize + 1) / chunkSize;
+
+	Chunk* chunk = ensureGenerated(cx, cy, cz);
+	if (!chunk) return;
+
+	std::unique_lock<std::mutex> lock = lockVoxels();
+	// Primero al journal: la edicin es durable sin reescribir el chunk entero
+	if (journal) journal->record({ wx, wy, wz, value });
+	glm::ivec3 local(wx - cx * chunkSize, wy - cy * chunkSize, wz - cz * chunkSize);
+	chunk->setVoxel(local.x, local.y, local.z, value);
+	touchNeighbors(chunk, local, local);
+	if (light) light->notifyEdit(glm::ivec3(wx, wy, wz));
+}
+
+int VoxelWorld::editRegion(glm::ivec3 min, glm::ivec3 max, const RowBrush& brush) {
+	PROFILE_SCOPE("World: bulk edit");
+
+	glm::ivec3 worldMax = glm::ivec3(worldWidth, worldHeight, worldDepth) * chunkSize - 1;
+	min = glm::max(min, glm::ivec3(0));
+	max = glm::min(max, worldMax);
+	if (min.x > max.x || min.y > max.y || min.z > max.z) return 0;
+
+	glm::ivec3 firstChunk = min / chunkSize;
+	glm::ivec3 lastChunk = max / chunkSize;
+	std::vector<uint8_t> before(chunkSize), scratch(chunkSize);
+	std::vector<VoxelEdit> edits;
+	std::vector<LightEditMask> lightMasks;
+	int changedTotal = 0;
+
+	for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+		for (int cy = firstChunk.y; cy <= lastChunk.y; cy++) {
+			for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+				Chunk* chunk = ensureGenerated(cx, cy, cz);
+				if (!chunk) continue;
+				std::unique_lock<std::mutex> lock = lockVoxels();
+
+				glm::ivec3 chunkMin = glm::ivec3(cx, cy, cz) * chunkSize;
+				glm::ivec3 lo = glm::max(min, chunkMin) - chunkMin;
+				glm::ivec3 hi = glm::min(max, chunkMin + chunkSize - 1) - chunkMin;
+				bool wasCompact = chunk->voxelData.empty();
+				bool covers = lo == glm::ivec3(0) && hi == glm::ivec3(chunkSize - 1);
+				int count = hi.x - lo.x + 1;
+
+				// Compacto: probar la brocha en una fila de su valor antes de expandirlo
+				if (wasCompact) {
+					bool changes = false;
+					for (int z = lo.z; z <= hi.z && !changes; z++) {
+						for (int y = lo.y; y <= hi.y && !changes; y++) {
+							std::memset(scratch.data(), chunk->uniformValue, count);
+							brush(chunkMin + glm::ivec3(lo.x, y, z), count, scratch.data());
+							for (int i = 0; i < count; i++) {
+								if (scratch[i] != chunk->uniformValue) changes = true;
+							}
+						}
+					}
+					if (!changes) continue;
+				}
+
+				chunk->materialize();
+				edits.clear();
+				// Voxels cambiados por fila para la luz: una mscara por chunk
+				LightEditMask mask;
+				if (light) mask.rows.assign(chunkSize * chunkSize, 0);
+				// En Morton la fila no es contigua: la brocha trabaja sobre una copia
+				bool linear = chunk->layout == ChunkLayout::Linear;
+				for (int z = lo.z; z <= hi.z; z++) {
+					for (int y = lo.y; y <= hi.y; y++) {
+						uint8_t* row = linear ? &chunk->voxelData[(z * chunkSize + y) * chunkSize + lo.x] : scratch.data();
+						if (!linear) {
+							for (int i = 0; i < count; i++) row[i] = chunk->voxelData[chunk->voxelIndex(lo.x + i, y, z)];
+						}
+						std::memcpy(before.data(), row, count);
+						glm::ivec3 start = chunkMin + glm::ivec3(lo.x, y, z);
+						brush(start, count, row);
+
+						uint32_t changedBits = 0;
+						for (int i = 0; i < count; i++) {
+							if (row[i] == before[i]) continue;
+							if (!linear) chunk->voxelData[chunk->voxelIndex(lo.x + i, y, z)] = row[i];
+							edits.push_back({ start.x + i, start.y, start.z, row[i] });
+							changedBits |= 1u << (lo.x + i);
+							if (row[i] != 0) chunk->brickMask |= 1ull << Chunk::brickIndex(lo.x + i, y, z);
+						}
+						if (light) mask.rows[z * chunkSize + y] = changedBits;
+						chunk->updateOccupancy(y, z, lo.x, count);
+					}
+				}
+
+				// Un chunk compacto o cubierto entero puede volver a ser uniforme
+				if (wasCompact || covers) chunk->classify();
+				if (edits.empty()) continue;
+
+				if (journal) journal->record(edits.data(), edits.size());
+				if (light) {
+					mask.origin = chunkMin;
+					mask.lo = lo;
+					mask.hi = hi;
+					lightMasks.push_back(std::move(mask));
+				}
+				chunk->revision++;
+				chunk->modified = true;
+				chunk->needsUpdate = true;
+				chunk->dirtySections |= Chunk::sectionsAround(lo, hi);
+				touchNeighbors(chunk, lo, hi);
+				changedTotal += (int)edits.size();
+			}
+		}
+	}
+	// El job de luz no compite por voxelMutex con los chunks que faltaban
+	if (light) light->notifyEdits(lightMasks);
+	return changedTotal;
+}
+
+int VoxelWorld::fillBox(const glm::ivec3& min, const glm::ivec3& max, uint8_t value) {
+	return editRegion(min, max, [value](const glm::ivec3&, int count, uint8_t* row) {
+		std::memset(row, value, count);
+	});
+}
+
+int VoxelWorld::fillSphere(const glm::vec3& center, float radius, uint8_t value) {
+	// Voxel v centrado en v, como en las mallas
+	glm::ivec3 min = glm::ivec3(glm::ceil(center - radius));
+	glm::ivec3 max = glm::ivec3(glm::floor(center + radius));
+	float radius2 = radius * radius;
+
+	return editRegion(min, max, [center, radius2, value](const glm::ivec3& start, int count, uint8_t* row) {
+		float dy = (float)start.y - center.y;
+		float dz = (float)start.z - center.z;
+		float rowRadius2 = radius2 - dy * dy - dz * dz;
+		if (rowRadius2 < 0.0f) return;
+
+		// Tramo de la fila dentro de la esfera
+		float halfWidth = std::sqrt(rowRadius2);
+		int first = std::max(0, (int)std::ceil(center.x - halfWidth) - start.x);
+		int last = std::min(count - 1, (int)std::floor(center.x + halfWidth) - start.x);
+		if (first <= last) std::memset(row + first, value, last - first + 1);
+	});
+}
+
+int VoxelWorld::replaceMaterial(const glm::ivec3& min, const glm::ivec3& max, uint8_t from, uint8_t to) {
+	return editRegion(min, max, [from, to](const glm::ivec3&, int count, uint8_t* row) {
+		for (int i = 0; i < count; i++) {
+			if (row[i] == from) row[i] = to;
+		}
+	});
+}
+
+VoxelVolume VoxelWorld::copyRegion(const glm::ivec3& min, const glm::ivec3& max) {
+	PROFILE_SCOPE("World: copy region");
+	VoxelVolume volume;
+	if (min.x > max.x || min.y > max.y || min.z > max.z) return volume;
+	volume.size = max - min + 1;
+	volume.voxels.assign(volume.size.x * volume.size.y * volume.size.z, 0);
+
+	// Fuera del mundo se queda en aire
+	glm::ivec3 worldMax = glm::ivec3(worldWidth, worldHeight, worldDepth) * chunkSize - 1;
+	glm::ivec3 lo = glm::max(min, glm::ivec3(0));
+	glm::ivec3 hi = glm::min(max, worldMax);
+	if (lo.x > hi.x || lo.y > hi.y || lo.z > hi.z) return volume;
+
+	glm::ivec3 firstChunk = lo / chunkSize;
+	glm::ivec3 lastChunk = hi / chunkSize;
+	for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+		for (int cy = firstChunk.y; cy <= lastChunk.y; cy++) {
+			for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+				const Chunk* chunk = ensureGenerated(cx, cy, cz);
+				if (!chunk) continue;
+
+				glm::ivec3 chunkMin = glm::ivec3(cx, cy, cz) * chunkSize;
+				glm::ivec3 a = glm::max(lo, chunkMin);
+				glm::ivec3 b = glm::min(hi, chunkMin + chunkSize - 1);
+				int count = b.x - a.x + 1;
+
+				for (int z = a.z; z <= b.z; z++) {
+					for (int y = a.y; y <= b.y; y++) {
+						uint8_t* dst = &volume.voxels[((z - min.z) * volume.size.y + (y - min.y)) * volume.size.x + (a.x - min.x)];
+						if (chunk->voxelData.empty()) {
+							std::memset(dst, chunk->uniformValue, count);
+						}
+						else if (chunk->layout == ChunkLayout::Linear) {
+							glm::ivec3 local = glm::ivec3(a.x, y, z) - chunkMin;
+							std::memcpy(dst, &chunk->voxelData[(local.z * chunkSize + local.y) * chunkSize + local.x], count);
+						}
+						else {
+							glm::ivec3 local = glm::ivec3(a.x, y, z) - chunkMin;
+							for (int i = 0; i < count; i++) dst[i] = chunk->voxelData[chunk->voxelIndex(local.x + i, local.y, local.z)];
+						}
+					}
+				}
+			}
+		}
+	}
+	return volume;
+}
+
+int VoxelWorld::paste(const VoxelVolume& volume, const glm::ivec3& origin, bool skipAir) {
+	if (volume.size.x <= 0 || volume.size.y <= 0 || volume.size.z <= 0) return 0;
+
+	return editRegion(origin, origin + volume.size - 1,
+		[&volume, origin, skipAir](const glm::ivec3& start, int count, uint8_t* row) {
+		glm::ivec3 src = start - origin;
+		const uint8_t* in = &volume.voxels[(src.z * volume.size.y + src.y) * volume.size.x + src.x];
+		if (!skipAir) {
+			std::memcpy(row, in, count);
+			return;
+		}
+		for (int i = 0; i < count; i++) {
+			if (in[i] != 0) row[i] = in[i];
+		}
+	});
+}
+
+const Chunk* VoxelWorld::findGeneratedChunk(int cx, int cy, int cz) const {
+	if (cx < 0 || cx >= worldWidth || cy < 0 || cy >= worldHeight || cz < 0 || cz >= worldDepth)
+		return nullptr;
+
+	uint32_t id = (cx << 20) | (cy << 10) | cz;
+	auto it = chunks.find(id);
+	if (it == chunks.end() || !it->second->generated.load(std::memory_order_acquire)) return nullptr;
+	return it->second.get();
+}
+
+RaycastHit VoxelWorld::raycast(const glm::vec3& rayOrigin, const glm::vec3& direction, float maxDistance) const {
+	RaycastHit result;
+	// Las mallas centran el voxel v en v: ocupa [v - 0.5, v + 0.5]
+	glm::vec3 origin = rayOrigin + glm::vec3(0.5f);
+	float len = glm::length(direction);
+	if (len < 1e-6f || maxDistance <= 0.0f) return result;
+	glm::vec3 dir = direction / len;
+
+	const float inf = std::numeric_limits<float>::infinity();
+	glm::ivec3 worldMax = glm::ivec3(worldWidth, worldHeight, worldDepth) * chunkSize;
+
+	glm::ivec3 step(0);
+	glm::vec3 invDir(0.0f);
+	float t = 0.0f;
+	float tEnd = maxDistance;
+	int enterAxis = -1;
+
+	// Recortar el rayo a la caja del mundo
+	for (int a = 0; a < 3; a++) {
+		if (dir[a] == 0.0f) {
+			if (origin[a] < 0.0f || origin[a] >= (float)worldMax[a]) return result;
+			continue;
+		}
+		step[a] = dir[a] > 0.0f ? 1 : -1;
+		invDir[a] = 1.0f / dir[a];
+		float t0 = (0.0f - origin[a]) * invDir[a];
+		float t1 = ((float)worldMax[a] - origin[a]) * invDir[a];
+		if (t0 > t1) std::swap(t0, t1);
+		if (t0 > t) {
+			t = t0;
+			enterAxis = a;
+		}
+		tEnd = std::min(tEnd, t1);
+	}
+	if (t > tEnd) return result;
+
+	glm::ivec3 voxel = glm::ivec3(glm::floor(origin + dir * t));
+	glm::ivec3 normal(0);
+	if (enterAxis >= 0) {
+		// El punto de entrada cae justo en el plano: quedarse en el lado de dentro
+		voxel[enterAxis] = step[enterAxis] > 0 ? 0 : worldMax[enterAxis] - 1;
+		normal[enterAxis] = -step[enterAxis];
+	}
+	voxel = glm::clamp(voxel, glm::ivec3(0), worldMax - 1);
+
+	// Distancia al siguiente plano de voxel por eje (sin acumular error)
+	glm::vec3 tNext;
+	auto updateNext = [&](int a) {
+		tNext[a] = step[a] == 0 ? inf :
+			((float)(voxel[a] + (step[a] > 0 ? 1 : 0)) - origin[a]) * invDir[a];
+	};
+	for (int a = 0; a < 3; a++) updateNext(a);
+
+	// Salta hasta salir de la caja [boxMin, boxMin + size) de una vez
+	auto skipBox = [&](const glm::ivec3& boxMin, int size) {
+		float tExit = inf;
+		int axis = 0;
+		for (int a = 0; a < 3; a++) {
+			if (step[a] == 0) continue;
+			float plane = (float)(step[a] > 0 ? boxMin[a] + size : boxMin[a]);
+			float ta = (plane - origin[a]) * invDir[a];
+			if (ta < tExit) {
+				tExit = ta;
+				axis = a;
+			}
+		}
+		glm::vec3 p = origin + dir * tExit;
+		for (int a = 0; a < 3; a++) {
+			if (a == axis) voxel[a] = step[a] > 0 ? boxMin[a] + size : boxMin[a] - 1;
+			else voxel[a] = glm::clamp((int)std::floor(p[a]), boxMin[a], boxMin[a] + size - 1);
+			updateNext(a);
+		}
+		normal = glm::ivec3(0);
+		normal[axis] = -step[axis];
+		t = tExit;
+	};
+
+	glm::ivec3 cachedCoord(-1);
+	const Chunk* chunk = nullptr;
+
+	while (t <= tEnd) {
+		if (voxel.x < 0 || voxel.x >= worldMax.x || voxel.y < 0 || voxel.y >= worldMax.y ||
+			voxel.z < 0 || voxel.z >= worldMax.z) break;
+
+		// Coordenadas no negativas: la divisin entera ya redondea hacia abajo
+		glm::ivec3 coord = voxel / chunkSize;
+		if (coord != cachedCoord) {
+			chunk = findGeneratedChunk(coord.x, coord.y, coord.z);
+			cachedCoord = coord;
+		}
+		glm::ivec3 chunkMin = coord * chunkSize;
+		glm::ivec3 local = voxel - chunkMin;
+
+		// Sin generar o todo aire: saltar el chunk entero
+		if (!chunk || chunk->content == ChunkContent::Empty) {
+			skipBox(chunkMin, chunkSize);
+			continue;
+		}
+		// Ladrillo de 8x8x8 sin slidos
+		if (chunk->isBrickEmpty(local.x, local.y, local.z)) {
+			skipBox(chunkMin + (local & ~7), 8);
+			continue;
+		}
+
+		// Solo se lee el material del voxel en el que acierta
+		if (chunk->isSolid(local.x, local.y, local.z)) {
+			result.hit = true;
+			result.voxel = voxel;
+			result.normal = normal;
+			result.distance = t;
+			result.value = chunk->getVoxel(local.x, local.y, local.z);
+			return result;
+		}
+
+		int axis = 0;
+		if (tNext.y < tNext[axis]) axis = 1;
+		if (tNext.z < tNext[axis]) axis = 2;
+		t = tNext[axis];
+		voxel[axis] += step[axis];
+		updateNext(axis);
+		normal = glm::ivec3(0);
+		normal[axis] = -step[axis];
+	}
+	return result;
+}
+
+void VoxelWorld::raycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& hits) {
+	PROFILE_SCOPE("World: raycast batch");
+	hits.resize(rays.size());
+
+	// Bloques grandes: un rayo cuesta poco ms que el propio job
+	const size_t kRaysPerJob = 256;
+	std::vector<JobHandle> batch;
+	batch.reserve(rays.size() / kRaysPerJob + 1);
+
+	for (size_t begin = 0; begin < rays.size(); begin += kRaysPerJob) {
+		size_t end = std::min(begin + kRaysPerJob, rays.size());
+		// Prioridad negativa: por delante de la generacin y el mallado
+		batch.push_back(jobs->run([this, &rays, &hits, begin, end] {
+			for (size_t i = begin; i < end; i++)
+				hits[i] = raycast(rays[i].origin, rays[i].direction, rays[i].maxDistance);
+		}, -1.0f));
+	}
+	for (const JobHandle& job : batch) jobs->wait(job);
+}
+
+bool VoxelWorld::shouldUseLOD(const Chunk* chunk, const glm::vec3& cameraPos) const {
+	return calculateLODLevel(chunk, cameraPos) > 0;
+}
+
+int VoxelWorld::calculateLODLevel(const Chunk* chunk, const glm::vec3& cameraPos) const {
+	glm::vec3 center = glm::vec3(chunk->position * chunkSize) + glm::vec3(chunkSize * 0.5f);
+	return lodForDistance(glm::length(center - cameraPos) / chunkSize);
+}
+
+int VoxelWorld::lodForDistance(float distInChunks) const {
+	// Cada nivel duplica la distancia: 0-2 chunks LOD0, 2-4 LOD1, 4-8 LOD2...
+	int lod = 0;
+	float threshold = 2.0f;
+	while (lod < maxLOD && distInChunks > threshold) {
+		lod++;
+		threshold *= 2.0f;
+	}
+	return lod;
+}
+
+void VoxelWorld::updateLOD(const glm::vec3& cameraPos) {
+	PROFILE_SCOPE("World: update LOD");
+
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		glm::vec3 center = glm::vec3(chunk->position * chunkSize) + glm::vec3(chunkSize * 0.5f);
+		chunk->distanceToCamera = glm::length(center - cameraPos);
+
+		// Fuera de distancia no se dibuja: se conserva el LOD (el prefetch usa el de entrada)
+		if (chunk->distanceToCamera > (float)(renderDistance * chunkSize)) continue;
+
+		int lod = calculateLODLevel(chunk, cameraPos);
+		if (lod != chunk->lodLevel) {
+			chunk->lodLevel = lod;
+			chunk->needsUpdate = true;
+			chunk->dirtySections = Chunk::kAllSections;
+		}
+	}
+}
+
+bool VoxelWorld::isChunkVisible(const Chunk* chunk, const glm::vec3& cameraPos) const {
+	glm::vec3 center = glm::vec3(chunk->position * chunkSize) + glm::vec3(chunkSize * 0.5f);
+	return glm::length(center - cameraPos) <= (float)(renderDistance * chunkSize);
+}
+
+bool VoxelWorld::isChunkInFrustum(const Chunk* chunk, const glm::mat4& viewProj) const {
+	// Planos del frustum (Gribb/Hartmann) a partir de las filas de viewProj
+	glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+	glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+	glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+	glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+	glm::vec4 planes[6] = {
+		row3 + row0, row3 - row0,
+		row3 + row1, row3 - row1,
+		row3 + row2, row3 - row2
+	};
+
+	glm::vec3 boxMin = glm::vec3(chunk->position * chunkSize) - 0.5f;
+	glm::vec3 boxMax = boxMin + glm::vec3((float)chunkSize);
+
+	for (int i = 0; i < 6; i++) {
+		// Vrtice positivo del AABB respecto al plano
+		glm::vec3 p(
+			planes[i].x >= 0.0f ? boxMax.x : boxMin.x,
+			planes[i].y >= 0.0f ? boxMax.y : boxMin.y,
+			planes[i].z >= 0.0f ? boxMax.z : boxMin.z);
+		if (glm::dot(glm::vec3(planes[i]), p) + planes[i].w < 0.0f) return false;
+	}
+	return true;
+}
+
+int VoxelWorld::cullChunks(const glm::vec3& cameraPos, const glm::mat4& viewProj) {
+	PROFILE_SCOPE("World: cull");
+
+	visibleChunks = 0;
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		chunk->isVisible = isChunkVisible(chunk, cameraPos) && isChunkInFrustum(chunk, viewProj);
+		if (chunk->isVisible) visibleChunks++;
+	}
+	return visibleChunks;
+}
+
+float VoxelWorld::jobPriority(const Chunk* chunk, const glm::vec3& cameraPos) const {
+	glm::vec3 center = glm::vec3(chunk->position * chunkSize) + glm::vec3(chunkSize * 0.5f);
+	glm::vec3 predicted = cameraPos + cameraVelocity * priorityLookahead;
+	float priority = glm::length(center - predicted);
+
+	// Fuera del frustum se degrada, pero no se cancela: puede volver al girar
+	if (!chunk->isVisible) priority += (float)(renderDistance * chunkSize);
+	return priority;
+}
+
+void VoxelWorld::cancelChunkJobs(Chunk* chunk) {
+	chunk->jobEpoch++;
+
+	// Los jobs cancelados van al frente de la cola: salen sin trabajar y liberan el chunk
+	float drain = -std::numeric_limits<float>::max();
+	jobs->setPriority(chunk->generateJob, drain);
+	jobs->setPriority(chunk->meshJob, drain);
+	jobs->setPriority(chunk->uploadJob, drain);
+
+	// El mallado trabaja sobre una copia: se puede volver a encolar ya
+	if (chunk->meshJob) {
+		chunk->meshJob.reset();
+		chunk->uploadJob.reset();
+		chunk->needsUpdate = true;
+		chunk->dirtySections = Chunk::kAllSections;
+	}
+}
+
+void VoxelWorld::updateJobPriorities(const glm::vec3& cameraPos) {
+	PROFILE_SCOPE("World: job priorities");
+
+	// Margen para no cancelar la generacin de vecinos de chunks visibles (tambin
+	// los de las esquinas, a sqrt(3) chunks)
+	float cancelDist = (renderDistance + 2.0f) * chunkSize;
+
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		bool generating = !JobSystem::isFinished(chunk->generateJob);
+		if (!generating && !chunk->meshJob) continue;
+
+		// Lo especulativo se mantiene mientras siga en la trayectoria
+		bool ahead = chunk->prefetched && isChunkAhead(chunk, cameraPos);
+		if (chunk->distanceToCamera > cancelDist && !ahead) {
+			cancelChunkJobs(chunk);
+			continue;
+		}
+
+		float priority = jobPriority(chunk, cameraPos);
+		jobs->setPriority(chunk->generateJob, priority);
+		jobs->setPriority(chunk->meshJob, priority);
+		jobs->setPriority(chunk->uploadJob, priority);
+	}
+
+	jobs->refreshPriorities();
+}
+
+glm::vec3 VoxelWorld::predictCameraPos(const glm::vec3& cameraPos, float seconds) const {
+	glm::vec3 offset = cameraVelocity * seconds;
+	float maxOffset = (float)(renderDistance * chunkSize);
+	float length = glm::length(offset);
+	if (length > maxOffset) offset *= maxOffset / length;
+	return cameraPos + offset;
+}
+
+bool VoxelWorld::isChunkAhead(const Chunk* chunk, const glm::vec3& cameraPos) const {
+	glm::vec3 center = glm::vec3(chunk->position * chunkSize) + glm::vec3(chunkSize * 0.5f);
+	glm::vec3 ahead = predictCameraPos(cameraPos, prefetchHorizon);
+	return glm::length(center - ahead) <= (float)(renderDistance * chunkSize);
+}
+
+bool VoxelWorld::isChunkReady(const Chunk* chunk) const {
+	return chunk->generated && !chunk->needsUpdate && !chunk->meshJob;
+}
+
+void VoxelWorld::updatePrefetchStats(const glm::vec3& cameraPos) {
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+
+		if (!isChunkVisible(chunk, cameraPos)) {
+			if (chunk->prefetched && !isChunkAhead(chunk, cameraPos)) {
+				prefetchStats.wasted++;
+				chunk->prefetched = false;
+			}
+			chunk->seen = false;
+			continue;
+		}
+
+		if (chunk->seen || !chunk->isVisible) continue;
+		chunk->seen = true;
+
+		bool ready = isChunkReady(chunk);
+		if (chunk->prefetched) {
+			if (ready) prefetchStats.hits++;
+			else prefetchStats.late++;
+		}
+		else if (!ready) {
+			prefetchStats.misses++;
+		}
+		chunk->prefetched = false;
+	}
+}
+
+int VoxelWorld::prefetchAhead(const glm::vec3& cameraPos) {
+	PROFILE_SCOPE("World: prefetch");
+
+	updatePrefetchStats(cameraPos);
+	if (prefetchBudget <= 0 || glm::length(cameraVelocity) < 1.0f) return 0;
+
+	int inFlight = 0;
+	for (auto& entry : chunks) {
+		const Chunk* chunk = entry.second.get();
+		if (chunk->prefetched && (!JobSystem::isFinished(chunk->generateJob) || chunk->meshJob)) inFlight++;
+	}
+
+	// Chunks en distancia de la posicin prevista que an no lo estn de la actual,
+	// los que antes van a entrar primero
+	glm::vec3 ahead = predictCameraPos(cameraPos, prefetchHorizon);
+	glm::ivec3 center = glm::ivec3(glm::floor(ahead / (float)chunkSize));
+	float maxDist = (float)(renderDistance * chunkSize);
+
+	std::vector<std::pair<float, Chunk*>> candidates;
+	for (int cz = center.z - renderDistance; cz <= center.z + renderDistance; cz++) {
+		for (int cy = center.y - renderDistance; cy <= center.y + renderDistance; cy++) {
+			for (int cx = center.x - renderDistance; cx <= center.x + renderDistance; cx++) {
+				if (cx < 0 || cx >= worldWidth || cy < 0 || cy >= worldHeight || cz < 0 || cz >= worldDepth)
+					continue;
+
+				glm::vec3 chunkCenter = glm::vec3(cx, cy, cz) * (float)chunkSize + glm::vec3(chunkSize * 0.5f);
+				float dist = glm::length(chunkCenter - cameraPos);
+				if (dist <= maxDist || glm::length(chunkCenter - ahead) > maxDist) continue;
+
+				Chunk* chunk = getOrCreateChunk(cx, cy, cz);
+				if (!chunk || isChunkReady(chunk)) continue;
+				candidates.push_back(std::make_pair(dist, chunk));
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(),
+		[](const std::pair<float, Chunk*>& a, const std::pair<float, Chunk*>& b) { return a.first < b.first; });
+
+	int requested = 0;
+	for (const auto& candidate : candidates) {
+		if (requested >= prefetchBudget || inFlight >= maxSpeculativeJobs) break;
+
+		Chunk* chunk = candidate.second;
+		if (!JobSystem::isFinished(chunk->generateJob) || chunk->meshJob) continue;
+
+		// Primero se genera; la malla se encola en un frame posterior
+		if (!chunk->generated) {
+			requestGeneration(chunk, jobPriority(chunk, cameraPos));
+		}
+		else {
+			// Mallar ya con el LOD que tendr al entrar en distancia
+			chunk->lodLevel = lodForDistance((float)renderDistance);
+			scheduleChunkMesh(chunk);
+		}
+
+		chunk->prefetched = true;
+		prefetchStats.requested++;
+		requested++;
+		inFlight++;
+	}
+	return requested;
+}
+
+// Resultado de un job de mallado (una malla por seccin); 'done' queda a false si se
+// cancel. Las mallas salen de la arena y vuelven a ella con el ltimo job que lo usa.
+struct MeshBuild {
+	MeshArena& arena;
+	std::vector<Mesh> sections;
+	bool done = false;
+
+	explicit MeshBuild(MeshArena& arena) : arena(arena) {}
+	~MeshBuild() { arena.release(sections); }
+};
+
+// Secciones de greedyFaceMeshSections para un chunk de size^3
+static size_t sectionCount(int size) {
+	size_t perAxis = (size + Chunk::kSectionSize - 1) / Chunk::kSectionSize;
+	return perAxis * perAxis * perAxis;
+}
+
+void VoxelWorld::attachMesh(Chunk* chunk, const std::shared_ptr<ChunkMesh>& mesh) {
+	chunk->mesh = mesh;
+	chunk->vertexCount = mesh ? mesh->vertexCount : 0;
+	chunk->indexCount = mesh ? mesh->indexCount : 0;
+}
+
+bool VoxelWorld::waitForNeighbors(Chunk* chunk) {
+	float priority = chunk->distanceToCamera;
+	std::vector<JobHandle> pending;
+	for (int i = 0; i < 27; i++) {
+		glm::ivec3 offset(i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1);
+		if (offset == glm::ivec3(0)) continue;
+		glm::ivec3 pos = chunk->position + offset;
+		Chunk* neighbor = getOrCreateChunk(pos.x, pos.y, pos.z);
+		if (!neighbor || neighbor->generated) continue;
+		requestGeneration(neighbor, priority);
+		pending.push_back(neighbor->generateJob);
+	}
+	if (pending.empty()) return false;
+
+	uint32_t epoch = chunk->jobEpoch.load();
+	JobHandle retryJob = jobs->create([this, chunk, epoch] {
+		if (chunk->jobEpoch.load() != epoch) return;
+		chunk->meshJob.reset();
+		chunk->uploadJob.reset();
+		// Un vecino cancelado se vuelve a pedir desde aqu
+		if (chunk->needsUpdate) scheduleChunkMesh(chunk);
+	}, priority, JobAffinity::MainThread);
+	for (const JobHandle& job : pending) jobs->addDependency(retryJob, job);
+
+	chunk->meshJob = retryJob;
+	chunk->uploadJob = retryJob;
+	jobs->submit(retryJob);
+	return true;
+}
+
+void VoxelWorld::copyPaddedVoxels(const Chunk* chunk, std::vector<uint8_t>& out) const {
+	const int cs = chunkSize;
+	const int ps = cs + 2;
+	out.assign(ps * ps * ps, 0);
+
+	// Los 27 chunks alrededor (null: aire)
+	const Chunk* around[27];
+	for (int i = 0; i < 27; i++) {
+		glm::ivec3 offset(i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1);
+		const Chunk* c = (offset == glm::ivec3(0)) ? chunk : findChunk(chunk->position + offset);
+		around[i] = (c && c->generated.load(std::memory_order_acquire)) ? c : nullptr;
+	}
+
+	auto region = [cs](int v) { return v < 0 ? 0 : (v >= cs ? 2 : 1); };
+	auto wrap = [cs](int v) { return v < 0 ? v + cs : (v >= cs ? v - cs : v); };
+
+	for (int z = -1; z <= cs; z++) {
+		for (int y = -1; y <= cs; y++) {
+			uint8_t* row = &out[((z + 1) * ps + y + 1) * ps];
+			for (int x = -1; x <= cs; x++) {
+				// Interior de la fila: copia directa
+				if (x == 0 && region(y) == 1 && region(z) == 1) {
+					if (chunk->voxelData.empty()) std::memset(row + 1, chunk->uniformValue, cs);
+					else if (chunk->layout == ChunkLayout::Linear) std::memcpy(row + 1, &chunk->voxelData[(z * cs + y) * cs], cs);
+					else for (int i = 0; i < cs; i++) row[i + 1] = chunk->getVoxel(i, y, z);
+					x = cs - 1;
+					continue;
+				}
+
+				const Chunk* c = around[(region(z) * 3 + region(y)) * 3 + region(x)];
+				if (c) row[x + 1] = c->getVoxel(wrap(x), wrap(y), wrap(z));
+			}
+		}
+	}
+}
+
+void VoxelWorld::scheduleChunkMesh(Chunk* chunk) {
+	// Todo aire: ni mallado ni buffers
+	if (chunk->content == ChunkContent::Empty) {
+		attachMesh(chunk, nullptr);
+		chunk->needsUpdate = false;
+		chunk->dirtySections = 0;
+		return;
+	}
+
+	int lod = chunk->lodLevel;
+	MeshingMode mode = meshingMode;
+	// Las caras por voxel (LOD 0) miran al borde de los vecinos: se malla con
+	// ellos ya generados. Surface nets y los LOD lejanos rellenan el borde con aire.
+	bool bordered = mode == MeshingMode::Blocky && lod == 0;
+	if (bordered && waitForNeighbors(chunk)) return;
+
+	// Luz horneada solo en LOD 0; los LOD lejanos van a plena luz de cielo
+	std::shared_ptr<std::vector<uint8_t>> lightData;
+	int lightValue = -1;
+	if (light && lod == 0) {
+		// Sin luz an: se malla cuando el LightEngine la inicialice
+		if (!chunk->lit) return;
+		std::unique_lock<std::mutex> lock(voxelMutex, std::try_to_lock);
+		// El job de luz est en mitad de un lote: se reintenta el prximo frame
+		if (!lock.owns_lock()) return;
+		lightData = std::make_shared<std::vector<uint8_t>>();
+		light->copyPadded(chunk, *lightData);
+		const std::vector<uint8_t>& data = *lightData;
+		if (std::all_of(data.begin(), data.end(), [&](uint8_t v) { return v == data[0]; }))
+			lightValue = data[0];
+	}
+
+	// Copia de los voxels: las ediciones del hilo principal no compiten con el job
+	std::shared_ptr<std::vector<uint8_t>> voxels = std::make_shared<std::vector<uint8_t>>();
+	if (bordered) copyPaddedVoxels(chunk, *voxels);
+	else chunk->copyVoxels(*voxels);
+	bool uniform = chunk->content == ChunkContent::Uniform;
+	// Sin borde un chunk uniforme se identifica por su valor; con borde, el hash
+	// y la comparacin incluyen los voxels de los vecinos
+	bool compact = uniform && !bordered;
+	uint64_t hash = compact ? hashUniform(chunk->uniformValue) : hashVoxels(*voxels);
+
+	int size = chunkSize;
+	uint32_t epoch = chunk->jobEpoch.load();
+	float priority = chunk->distanceToCamera;
+	bool optimize = meshOptimization;
+	uint64_t key = hash ^ ((uint64_t)(lod + 1) * 0xff51afd7ed558ccdull) ^
+		((uint64_t)(lightValue + 2) * 0xc4ceb9fe1a85ec53ull) ^ ((uint64_t)mode * 0x9fb21c651e98df25ull);
+	// Con luz no uniforme la malla es propia del chunk: no se comparte
+	bool shareable = !lightData || lightValue >= 0;
+
+	// Malla propia ya subida y solo algunas secciones cambiadas: se remallan y
+	// se resuben esas (current y chunk->mesh son las dos nicas referencias)
+	std::shared_ptr<ChunkMesh> current = chunk->mesh;
+	uint8_t dirty = chunk->dirtySections;
+	if (bordered && !uniform && dirty != Chunk::kAllSections && current && current->ready &&
+		current->lodLevel == 0 && current->sections.size() == 8 && current.use_count() == 2) {
+		chunk->needsUpdate = false;
+		chunk->dirtySections = 0;
+		if (dirty == 0) return;
+
+		// Deja de representar el contenido con el que se cache
+		auto entry = meshCache.find(current->cacheKey);
+		if (entry != meshCache.end() && entry->second.lock() == current) meshCache.erase(entry);
+		current->voxels.reset();
+		current->lightValue = -1;
+		partialRemeshes++;
+
+		std::shared_ptr<MeshBuild> build = std::make_shared<MeshBuild>(meshArena);
+		JobHandle meshJob = jobs->create([this, chunk, voxels, lightData, build, dirty, size, epoch] {
+			if (chunk->jobEpoch.load() != epoch) {
+				cancelledJobs++;
+				return;
+			}
+			PROFILE_SCOPE("World: remesh sections");
+			thread_local GreedyMesher workerMesher;
+			meshArena.acquire(build->sections, sectionCount(size));
+			workerMesher.greedyFaceMeshSectionsPadded(voxels->data(), glm::ivec3(size), lightData ? lightData->data() : nullptr,
+				Chunk::kSectionSize, dirty, build->sections);
+			build->done = true;
+		}, priority);
+
+		JobHandle uploadJob = jobs->create([this, chunk, build, current, dirty, epoch] {
+			// Cancelado: el chunk ya tiene todas las secciones pendientes
+			if (chunk->jobEpoch.load() != epoch) return;
+			if (build->done) {
+				uploadMesh(current.get(), build->sections, dirty);
+				attachMesh(chunk, current);
+			}
+			else {
+				chunk->needsUpdate = true;
+				chunk->dirtySections = Chunk::kAllSections;
+			}
+			chunk->meshJob.reset();
+			chunk->uploadJob.reset();
+		}, priority, JobAffinity::MainThread);
+		jobs->addDependency(uploadJob, meshJob);
+
+		chunk->meshJob = meshJob;
+		chunk->uploadJob = uploadJob;
+		jobs->submit(meshJob);
+		jobs->submit(uploadJob);
+		return;
+	}
+
+	// Mismo contenido, LOD y luz que una malla ya hecha (o en vuelo): se comparte
+	auto cached = shareable ? meshCache.find(key) : meshCache.end();
+	if (cached != meshCache.end()) {
+		std::shared_ptr<ChunkMesh> shared = cached->second.lock();
+		bool same = shared && !shared->failed && shared->contentHash == hash && shared->lodLevel == lod &&
+			shared->lightValue == lightValue && shared->mode == mode &&
+			(compact ? !shared->voxels : shared->voxels && *shared->voxels == *voxels);
+
+		if (same) {
+			meshCacheHits++;
+			chunk->needsUpdate = false;
+			chunk->dirtySections = 0;
+			if (shared->ready) {
+				attachMesh(chunk, shared);
+				return;
+			}
+
+			JobHandle attachJob = jobs->create([this, chunk, shared, epoch] {
+				if (chunk->jobEpoch.load() != epoch) return;
+				if (shared->ready) {
+					attachMesh(chunk, shared);
+				}
+				else {
+					chunk->needsUpdate = true;
+					chunk->dirtySections = Chunk::kAllSections;
+				}
+				chunk->meshJob.reset();
+				chunk->uploadJob.reset();
+			}, priority, JobAffinity::MainThread);
+			jobs->addDependency(attachJob, shared->uploadJob);
+
+			chunk->meshJob = attachJob;
+			chunk->uploadJob = attachJob;
+			jobs->submit(attachJob);
+			return;
+		}
+	}
+	meshCacheMisses++;
+
+	std::shared_ptr<ChunkMesh> target = std::make_shared<ChunkMesh>();
+	target->contentHash = hash;
+	target->lodLevel = lod;
+	target->mode = mode;
+	target->lightValue = lightValue;
+	target->cacheKey = key;
+	if (!compact) target->voxels = voxels;
+	if (shareable) meshCache[key] = target;
+
+	std::shared_ptr<MeshBuild> build = std::make_shared<MeshBuild>(meshArena);
+	JobHandle meshJob = jobs->create([this, chunk, voxels, lightData, build, lod, mode, optimize, size, epoch] {
+		if (chunk->jobEpoch.load() != epoch) {
+			cancelledJobs++;
+			return;
+		}
+		PROFILE_SCOPE("World: mesh chunk");
+		// El mesher reutiliza buffers internos: uno por hilo
+		thread_local GreedyMesher workerMesher;
+		// LOD 0 por secciones (se pueden remallar sueltas); los LOD lejanos, en una
+		if (mode == MeshingMode::Smooth) {
+			thread_local SurfaceNets workerNets;
+			meshArena.acquire(build->sections, 1);
+			workerNets.generate(voxels->data(), glm::ivec3(size), lightData ? lightData->data() : nullptr, lod, build->sections[0]);
+		}
+		else if (lod == 0) {
+			meshArena.acquire(build->sections, sectionCount(size));
+			workerMesher.greedyFaceMeshSectionsPadded(voxels->data(), glm::ivec3(size), lightData ? lightData->data() : nullptr,
+				Chunk::kSectionSize, Chunk::kAllSections, build->sections);
+		}
+		else {
+			meshArena.acquire(build->sections, 1);
+			workerMesher.generateLODMesh(voxels->data(), glm::ivec3(size), lod, build->sections[0]);
+		}
+		// Las mallas de quads no ganan nada con MeshOptimizer: solo surface nets
+		if (optimize && mode == MeshingMode::Smooth) {
+			thread_local MeshOptimizer workerOptimizer;
+			workerOptimizer.optimize(build->sections[0]);
+		}
+		build->done = true;
+	}, priority);
+
+	JobHandle uploadJob = jobs->create([this, chunk, build, target, epoch] {
+		// La malla se sube aunque el chunk se cancelara despus: otros la esperan
+		if (build->done) {
+			uploadMesh(target.get(), build->sections, ~0u);
+			target->ready = true;
+		}
+		else {
+			target->failed = true;
+		}
+		target->uploadJob.reset();
+
+		// Cancelado: los handles del chunk ya son de otra malla
+		if (chunk->jobEpoch.load() != epoch) return;
+		if (target->ready) {
+			attachMesh(chunk, target);
+		}
+		else {
+			chunk->needsUpdate = true;
+			chunk->dirtySections = Chunk::kAllSections;
+		}
+		chunk->meshJob.reset();
+		chunk->uploadJob.reset();
+	}, priority, JobAffinity::MainThread);
+	jobs->addDependency(uploadJob, meshJob);
+	target->uploadJob = uploadJob;
+
+	chunk->needsUpdate = false;
+	chunk->dirtySections = 0;
+	chunk->meshJob = meshJob;
+	chunk->uploadJob = uploadJob;
+	jobs->submit(meshJob);
+	jobs->submit(uploadJob);
+}
+
+int VoxelWorld::updateMeshes(int budget) {
+	PROFILE_SCOPE("World: schedule meshes");
+
+	// Purgar entradas de mallas que ya no usa ningn chunk
+	if (meshCache.size() > 2 * chunks.size() + 64) {
+		for (auto it = meshCache.begin(); it != meshCache.end();) {
+			if (it->second.expired()) it = meshCache.erase(it);
+			else ++it;
+		}
+	}
+
+	int scheduled = 0;
+	for (auto& entry : chunks) {
+		if (budget >= 0 && scheduled >= budget) break;
+
+		Chunk* chunk = entry.second.get();
+		// La luz cambi: se remallan sus secciones (aunque haya un mallado en vuelo)
+		if (chunk->lightDirty.load(std::memory_order_relaxed)) {
+			chunk->dirtySections |= chunk->lightDirty.exchange(0);
+			chunk->needsUpdate = true;
+		}
+		if (!chunk->generated || chunk->meshJob) continue;
+		if (!chunk->needsUpdate || !chunk->isVisible) continue;
+		scheduleChunkMesh(chunk);
+		if (chunk->meshJob) scheduled++;
+	}
+	return scheduled;
+}
+
+int VoxelWorld::processMainThreadJobs(int budget) {
+	return jobs->runMainThreadJobs(budget);
+}
+
+void VoxelWorld::finishJobs() {
+	jobs->waitIdle();
+}
+
+// Holgura de cada hueco: una edicin pequea cabe sin reubicar el resto
+static int sectionCapacity(int count) {
+	return count + count / 8 + 24;
+}
+
+// Una seccin de 16^3 no llega a 65535 vrtices (peor caso: tablero de ajedrez, 12
+// por voxel), as que remallar secciones sueltas nunca obliga a pasar a 32 bits.
+static_assert(Chunk::kSectionSize * Chunk::kSectionSize * Chunk::kSectionSize * 12 <= 65535,
+	"mesh sections must fit 16-bit indices");
+const int VoxelWorld::kSharedQuads;
+
+// Cuentas nuevas de las secciones de 'mask'. Si alguna no cabe en su hueco, reparte
+// de nuevo todos los huecos y devuelve true; 'previous' queda con los de antes.
+// Al subir todas las secciones se elige el tamao de ndice y si se usa el EBO de
+// quads compartido (hasta 'maxSharedVertices' vrtices por seccin).
+static bool placeSections(ChunkMesh* target, const std::vector<Mesh>& sections, uint32_t mask,
+	int maxSharedVertices, std::vector<MeshSection>& previous) {
+	previous = target->sections;
+	bool relayout = target->sections.size() != sections.size();
+	if (relayout) target->sections.assign(sections.size(), MeshSection());
+
+	for (size_t i = 0; i < sections.size() && !relayout; i++) {
+		if (!(mask & (1u << i))) continue;
+		const MeshSection& slot = target->sections[i];
+		if ((int)sections[i].vertices.size() > slot.vertexCapacity || (int)sections[i].indexCount() > slot.indexCapacity)
+			relayout = true;
+	}
+
+	target->vertexCount = target->indexCount = target->translucentIndexCount = 0;
+	int vertexOffset = 0, indexOffset = 0;
+	for (size_t i = 0; i < sections.size(); i++) {
+		MeshSection& slot = target->sections[i];
+		if (mask & (1u << i)) {
+			slot.vertexCount = (int)sections[i].vertices.size();
+			slot.indexCount = (int)sections[i].indexCount();
+			slot.translucentIndexCount = (int)sections[i].translucentIndexCount;
+		}
+		if (relayout) {
+			// Una sola seccin (LOD lejano): no se remalla por partes, sin holgura
+			bool single = sections.size() == 1;
+			slot.vertexOffset = vertexOffset;
+			slot.indexOffset = indexOffset;
+			slot.vertexCapacity = single ? slot.vertexCount : sectionCapacity(slot.vertexCount);
+			slot.indexCapacity = single ? slot.indexCount : sectionCapacity(slot.indexCount);
+			vertexOffset += slot.vertexCapacity;
+			indexOffset += slot.indexCapacity;
+		}
+		target->vertexCount += slot.vertexCount;
+		target->indexCount += slot.indexCount;
+		target->translucentIndexCount += slot.translucentIndexCount;
+	}
+	if (relayout) {
+		target->vertexCapacity = vertexOffset;
+		target->indexCapacity = indexOffset;
+	}
+	if (relayout && (mask & ((1u << sections.size()) - 1)) == (1u << sections.size()) - 1) {
+		int maxVertices = 0;
+		bool quads = true;
+		for (size_t i = 0; i < sections.size(); i++) {
+			maxVertices = std::max(maxVertices, target->sections[i].vertexCount);
+			quads = quads && sections[i].quads;
+		}
+		target->sharedQuadIndices = quads && maxVertices <= maxSharedVertices;
+		target->indexSize = target->sharedQuadIndices || maxVertices <= 65535 ? 2 : 4;
+	}
+	return relayout;
+}
+
+#ifndef VOXELGL_HEADLESS
+
+ChunkMesh::~ChunkMesh() {
+	if (vao) glDeleteVertexArrays(1, &vao);
+	if (vbo) glDeleteBuffers(1, &vbo);
+	if (ebo) glDeleteBuffers(1, &ebo);
+}
+
+GLuint VoxelWorld::getQuadIndexBuffer() {
+	if (quadIndexBuffer) return quadIndexBuffer;
+	std::vector<uint16_t> indices(kSharedQuads * 6);
+	static const uint16_t pattern[6] = { 0, 1, 2, 0, 2, 3 };
+	for (size_t i = 0; i < indices.size(); i++) indices[i] = (uint16_t)(i / 6 * 4 + pattern[i % 6]);
+	glGenBuffers(1, &quadIndexBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, quadIndexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	return quadIndexBuffer;
+}
+
+// Formato de Vertex sobre el VBO enlazado, en el VAO enlazado
+static void setVertexAttributes() {
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+	glEnableVertexAttribArray(2);
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(Vertex, material));
+	glEnableVertexAttribArray(3);
+	// Luz horneada: cielo y bloque normalizados a [0, 1]
+	glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, light));
+	glEnableVertexAttribArray(4);
+}
+
+void VoxelWorld::uploadMesh(ChunkMesh* target, const std::vector<Mesh>& sections, uint32_t mask) {
+	PROFILE_SCOPE("World: upload chunk");
+
+	std::vector<MeshSection> previous;
+	bool relayout = placeSections(target, sections, mask, kSharedQuads * 4, previous);
+	if (target->indexCount == 0 && target->vao == 0) return;  // Sin caras: sin buffers
+	bool ownIndices = !target->sharedQuadIndices;
+
+	// Las copias y subidas van por GL_COPY_WRITE_BUFFER: no tocan el VAO enlazado
+	if (relayout || target->vao == 0) {
+		sectionRelayouts++;
+		GLuint vbo = 0, ebo = 0;
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+		glBufferData(GL_COPY_WRITE_BUFFER, target->vertexCapacity * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+		if (ownIndices) {
+			glGenBuffers(1, &ebo);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+			glBufferData(GL_COPY_WRITE_BUFFER, target->indexCapacity * target->indexSize, nullptr, GL_STATIC_DRAW);
+		}
+
+		// Las secciones sin cambios se mueven en la GPU a sus huecos nuevos
+		for (size_t i = 0; i < previous.size() && target->vbo; i++) {
+			if (mask & (1u << i)) continue;
+			const MeshSection& from = previous[i];
+			const MeshSection& to = target->sections[i];
+			if (from.vertexCount > 0) {
+				glBindBuffer(GL_COPY_READ_BUFFER, target->vbo);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from.vertexOffset * sizeof(Vertex),
+					to.vertexOffset * sizeof(Vertex), from.vertexCount * sizeof(Vertex));
+			}
+			if (from.indexCount > 0 && ownIndices) {
+				glBindBuffer(GL_COPY_READ_BUFFER, target->ebo);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from.indexOffset * target->indexSize,
+					to.indexOffset * target->indexSize, from.indexCount * target->indexSize);
+			}
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+		if (target->vbo) glDeleteBuffers(1, &target->vbo);
+		if (target->ebo) glDeleteBuffers(1, &target->ebo);
+		target->vbo = vbo;
+		target->ebo = ebo;
+
+		if (target->vao == 0) glGenVertexArrays(1, &target->vao);
+		glBindVertexArray(target->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, target->vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ownIndices ? target->ebo : getQuadIndexBuffer());
+		setVertexAttributes();
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	std::vector<uint16_t> shortIndices;
+	std::vector<uint32_t> quadIndices;
+	for (size_t i = 0; i < sections.size(); i++) {
+		if (!(mask & (1u << i))) continue;
+		const Mesh& mesh = sections[i];
+		const MeshSection& slot = target->sections[i];
+		if (mesh.indexCount() == 0) continue;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, target->vbo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, slot.vertexOffset * sizeof(Vertex), mesh.vertices.size() * sizeof(Vertex), mesh.vertices.data());
+		if (!ownIndices) continue;
+
+		// Quads demasiado grandes para el EBO compartido: ndices explcitos
+		const std::vector<uint32_t>* indices = &mesh.indices;
+		if (mesh.quads) {
+			quadIndices.resize(mesh.indexCount());
+			for (size_t k = 0; k < quadIndices.size(); k++) quadIndices[k] = mesh.index(k);
+			indices = &quadIndices;
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, target->ebo);
+		if (target->indexSize == 2) {
+			shortIndices.assign(indices->begin(), indices->end());
+			glBufferSubData(GL_COPY_WRITE_BUFFER, slot.indexOffset * 2, shortIndices.size() * 2, shortIndices.data());
+		}
+		else {
+			glBufferSubData(GL_COPY_WRITE_BUFFER, slot.indexOffset * 4, indices->size() * 4, indices->data());
+		}
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static GLenum indexType(const ChunkMesh* mesh) {
+	return mesh->indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+// Byte del EBO donde empieza el ndice 'index' de una seccin. En el EBO de quads
+// todas las secciones empiezan en 0 (su base de vrtice las separa).
+static const void* indexOffset(const ChunkMesh* mesh, const MeshSection& slot, int index) {
+	int first = mesh->sharedQuadIndices ? index : slot.indexOffset + index;
+	return (const void*)(size_t)(first * mesh->indexSize);
+}
+
+// Centro de una seccin en coordenadas de mundo (para ordenar lo translcido)
+static glm::vec3 sectionCenter(const Chunk* chunk, const ChunkMesh* mesh, int section, int chunkSize) {
+	glm::vec3 origin = glm::vec3(chunk->position * chunkSize) - glm::vec3(0.5f);
+	if (mesh->sections.size() == 1) return origin + glm::vec3(chunkSize * 0.5f);
+	glm::ivec3 cell(section & 1, (section >> 1) & 1, section >> 2);
+	return origin + glm::vec3(cell * Chunk::kSectionSize) + glm::vec3(Chunk::kSectionSize * 0.5f);
+}
+
+void VoxelWorld::render(GLShader* shader, const glm::vec3& cameraPos, const glm::mat4& viewProj) {
+	PROFILE_SCOPE("World: render");
+
+	streamChunks(cameraPos);
+	updateLOD(cameraPos);
+	cullChunks(cameraPos, viewProj);
+	updateJobPriorities(cameraPos);
+	updateMeshes();
+	prefetchAhead(cameraPos);
+	processMainThreadJobs();
+
+	renderedTriangles = 0;
+	// Pasada opaca: un multi-draw por chunk con la parte opaca de cada seccin. Las
+	// secciones con parte translcida se guardan con su distancia a la cmara.
+	struct TranslucentDraw {
+		float distance;
+		Chunk* chunk;
+		int section;
+	};
+	std::vector<TranslucentDraw> translucent;
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<GLint> baseVertices;
+	for (auto& entry : chunks) {
+		Chunk* chunk = entry.second.get();
+		if (!chunk->isVisible || !chunk->mesh || chunk->indexCount == 0) continue;
+		const ChunkMesh* mesh = chunk->mesh.get();
+
+		counts.clear();
+		offsets.clear();
+		baseVertices.clear();
+		for (int i = 0; i < (int)mesh->sections.size(); i++) {
+			const MeshSection& slot = mesh->sections[i];
+			int opaqueCount = slot.indexCount - slot.translucentIndexCount;
+			if (opaqueCount > 0) {
+				counts.push_back(opaqueCount);
+				offsets.push_back(indexOffset(mesh, slot, 0));
+				baseVertices.push_back(slot.vertexOffset);
+				renderedTriangles += opaqueCount / 3;
+			}
+			if (slot.translucentIndexCount > 0) {
+				glm::vec3 delta = sectionCenter(chunk, mesh, i, chunkSize) - cameraPos;
+				translucent.push_back({ glm::dot(delta, delta), chunk, i });
+			}
+		}
+		if (counts.empty()) continue;
+
+		// Mallas en coordenadas locales del chunk
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(chunk->position * chunkSize));
+		shader->setMat4("model", model);
+
+		glBindVertexArray(mesh->vao);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), indexType(mesh), offsets.data(),
+			(GLsizei)counts.size(), baseVertices.data());
+	}
+
+	// Pasada translcida: de lejos a cerca por seccin, con blending y sin escribir profundidad
+	if (!translucent.empty()) {
+		PROFILE_SCOPE("World: render translucent");
+		std::sort(translucent.begin(), translucent.end(),
+			[](const TranslucentDraw& a, const TranslucentDraw& b) { return a.distance > b.distance; });
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+		for (const TranslucentDraw& draw : translucent) {
+			const ChunkMesh* mesh = draw.chunk->mesh.get();
+			const MeshSection& slot = mesh->sections[draw.section];
+
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(draw.chunk->position * chunkSize));
+			shader->setMat4("model", model);
+
+			glBindVertexArray(mesh->vao);
+			glDrawElementsBaseVertex(GL_TRIANGLES, slot.translucentIndexCount, indexType(mesh),
+				indexOffset(mesh, slot, slot.indexCount - slot.translucentIndexCount), slot.vertexOffset);
+			renderedTriangles += slot.translucentIndexCount / 3;
+		}
+		glDepthMask(GL_TRUE);
+		glDisable(GL_BLEND);
+	}
+	glBindVertexArray(0);
+}
+
+#else
+
+ChunkMesh::~ChunkMesh() {}
+
+// Sin contexto GL: solo se registran los tamaos y los huecos de la malla
+void VoxelWorld::uploadMesh(ChunkMesh* target, const std::vector<Mesh>& sections, uint32_t mask) {
+	std::vector<MeshSection> previous;
+	if (placeSections(target, sections, mask, kSharedQuads * 4, previous)) sectionRelayouts++;
+}
+
+void VoxelWorld::render(GLShader* /*shader*/, const glm::vec3& cameraPos, const glm::mat4& viewProj) {
+	streamChunks(cameraPos);
+	updateLOD(cameraPos);
+	cullChunks(cameraPos, viewProj);
+	updateJobPriorities(cameraPos);
+	updateMeshes();
+	prefetchAhead(cameraPos);
+	processMainThreadJobs();
+
+	renderedTriangles = 0;
+	for (auto& entry : chunks) {
+		if (entry.second->isVisible) renderedTriangles += entry.second->indexCount / 3;
+	}
+}
+
+#endif
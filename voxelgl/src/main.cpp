@@ -1,6 +1,13 @@
 #include "GLShader.h"
-#include "GreedyMesher.h"
+#include "VoxelWorld.h"
+#include "MaterialAtlas.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "VoxelCollision.h"
+#include "MaterialTable.h"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -9,7 +16,12 @@
 
 GLFWwindow* window = nullptr;
 GLShader* shader = nullptr;
-glm::vec3 cameraPos(0.0f, 0.0f, 2.0f);
+MaterialAtlas* atlas = nullptr;
+GpuTimer* gpuTimer = nullptr;
+VoxelWorld* world = nullptr;
+VoxelCollision* collision = nullptr;
+std::ofstream cameraPathFile;
+glm::vec3 cameraPos(256.0f, 100.0f, 256.0f);
 glm::vec3 cameraFront(0.0f, 0.0f, -1.0f);
 glm::vec3 cameraUp(0.0f, 1.0f, 0.0f);
 float yaw = -90.0f, pitch = 0.0f;
@@ -17,18 +29,12 @@ bool firstMouse = true;
 float lastX = 640, lastY = 360;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
-GreedyMesher mesher;
-glm::ivec3 chunkSize(3, 3, 3);
-std::vector<uint8_t> chunk = {
-	1, 0, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1
-};
-Mesh mesh = mesher.greedy3DBinaryToVertices(chunk.data(), chunkSize);
-
-// Buffers de OpenGL
-GLuint vao, vbo, ebo;
-
+// Modo a pie: caja del jugador con gravedad y colisiones contra el mundo
+bool walkMode = false;
+bool onGround = false;
+glm::vec3 playerVelocity(0.0f);
+// Material que pone el clic derecho (0: el del bloque apuntado)
+uint8_t placeMaterial = 0;
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 	glViewport(0, 0, width, height);
 }
@@ -66,19 +72,117 @@ void processInput(GLFWwindow* window) {
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
-	float cameraSpeed = 10.0f * deltaTime;
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		cameraPos += cameraSpeed * cameraFront;
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		cameraPos -= cameraSpeed * cameraFront;
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-		cameraPos += cameraSpeed * cameraUp;
-	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-		cameraPos -= cameraSpeed * cameraUp;
+	// F: alternar entre vuelo libre y andar
+	static bool walkKeyDown = false;
+	bool walkKey = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+	if (walkKey && !walkKeyDown) {
+		walkMode = !walkMode;
+		playerVelocity = glm::vec3(0.0f);
+	}
+	walkKeyDown = walkKey;
+
+	// G: alternar mallado por bloques y suave (surface nets)
+	static bool smoothKeyDown = false;
+	bool smoothKey = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+	if (smoothKey && !smoothKeyDown && world) {
+		bool smooth = world->getMeshingMode() == MeshingMode::Blocky;
+		world->setMeshingMode(smooth ? MeshingMode::Smooth : MeshingMode::Blocky);
+	}
+	smoothKeyDown = smoothKey;
+
+	if (walkMode && collision) {
+		glm::vec3 forward = glm::normalize(glm::vec3(cameraFront.x, 0.0f, cameraFront.z));
+		glm::vec3 right = glm::normalize(glm::cross(forward, cameraUp));
+		glm::vec3 wish(0.0f);
+		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) wish += forward;
+		if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) wish -= forward;
+		if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) wish -= right;
+		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) wish += right;
+		if (glm::length(wish) > 0.0f) wish = glm::normalize(wish) * 5.0f;
+
+		float dt = std::min(deltaTime, 0.05f);
+		playerVelocity.x = wish.x;
+		playerVelocity.z = wish.z;
+		playerVelocity.y = std::max(playerVelocity.y - 25.0f * dt, -50.0f);
+		if (onGround && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) playerVelocity.y = 8.0f;
+
+		// Ojos 0.2 por debajo del techo de la caja
+		AABB box = { cameraPos - glm::vec3(0.3f, 1.6f, 0.3f), cameraPos + glm::vec3(0.3f, 0.2f, 0.3f) };
+		MoveResult result = collision->move(box, playerVelocity * dt);
+		cameraPos += result.delta;
+		if (result.blocked.y != 0) playerVelocity.y = 0.0f;
+		onGround = result.onGround;
+	}
+	else {
+		float cameraSpeed = 10.0f * deltaTime;
+		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+			cameraPos += cameraSpeed * cameraFront;
+		if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+			cameraPos -= cameraSpeed * cameraFront;
+		if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+			cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+			cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+		if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+			cameraPos += cameraSpeed * cameraUp;
+		if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+			cameraPos -= cameraSpeed * cameraUp;
+	}
+
+	// F12: exportar la traza de profiling
+	static bool traceKeyDown = false;
+	bool traceKey = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+	if (traceKey && !traceKeyDown)
+		Profiler::get().exportChromeTrace("voxelgl_trace.json");
+	traceKeyDown = traceKey;
+
+	// F9: grabar/parar la ruta de cmara (para voxelbench)
+	static bool pathKeyDown = false;
+	bool pathKey = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+	if (pathKey && !pathKeyDown) {
+		if (cameraPathFile.is_open()) {
+			cameraPathFile.close();
+			std::cout << "Camera path saved: camera_path.txt" << std::endl;
+		}
+		else {
+			cameraPathFile.open("camera_path.txt");
+		}
+	}
+	pathKeyDown = pathKey;
+
+	// 0..7: material a poner (0: copiar el apuntado; ver MaterialTable)
+	for (int key = 0; key <= 7; key++) {
+		if (glfwGetKey(window, GLFW_KEY_0 + key) == GLFW_PRESS) placeMaterial = (uint8_t)key;
+	}
+
+	// Clic izquierdo: quitar el bloque apuntado; derecho: poner uno en su cara
+	static bool leftDown = false, rightDown = false;
+	bool left = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+	bool right = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+	if (world && ((left && !leftDown) || (right && !rightDown))) {
+		RaycastHit hit = world->raycast(cameraPos, cameraFront, 64.0f);
+		if (hit.hit) {
+			glm::ivec3 target = left ? hit.voxel : hit.voxel + hit.normal;
+			uint8_t value = placeMaterial != 0 ? placeMaterial : hit.value;
+			world->setWorldVoxel(target.x, target.y, target.z, left ? 0 : value);
+		}
+	}
+	leftDown = left;
+	rightDown = right;
+
+	// Clic central: explosin (esfera de aire en una sola edicin en bloque)
+	static bool middleDown = false;
+	bool middle = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS;
+	if (world && middle && !middleDown) {
+		RaycastHit hit = world->raycast(cameraPos, cameraFront, 64.0f);
+		if (hit.hit) world->fillSphere(glm::vec3(hit.voxel), 4.5f, 0);
+	}
+	middleDown = middle;
+
+	if (cameraPathFile.is_open()) {
+		cameraPathFile << cameraPos.x << " " << cameraPos.y << " " << cameraPos.z << " "
+			<< cameraFront.x << " " << cameraFront.y << " " << cameraFront.z << "\n";
+	}
 }
 
 bool initGL() {
@@ -126,41 +230,20 @@ bool initGL() {
 }
 
 int main() {
+	Profiler::get().setThreadName("main");
+
 	if (!initGL()) {
 		return -1;
 	}
 
-	// Crear y configurar VAO, VBO, EBO
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-	glGenBuffers(1, &ebo);
-
-	glBindVertexArray(vao);
+	gpuTimer = new GpuTimer();
 
-	// 1. Vrtices
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), mesh.vertices.data(), GL_STATIC_DRAW);
-
-	// 2. ndices
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(GLuint), mesh.indices.data(), GL_STATIC_DRAW);
-
-	// 3. Atributos de vrtice
-	// Posicin (location = 0)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-	glEnableVertexAttribArray(0);
-
-	// Normal (location = 1)
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-	glEnableVertexAttribArray(1);
-
-	// UV (location = 2)
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
-	glEnableVertexAttribArray(2);
-
-	// Desvincular buffers
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0); // IMPORTANTE: desvincular VAO al final
+	// Mundo de 16x4x16 chunks: se genera y malla en streaming con los workers
+	world = new VoxelWorld(16, 4, 16);
+	world->setRenderDistance(6);
+	// Las ediciones se guardan en regiones + journal y se recuperan al volver a abrir
+	world->openRegionStore("world");
+	collision = new VoxelCollision(world);
 
 	// Cargar shaders
 	shader = new GLShader();
@@ -169,12 +252,26 @@ int main() {
 		return -1;
 	}
 
+	// Atlas de materiales (una capa por material)
+	atlas = new MaterialAtlas();
+	if (!atlas->create(16, 8)) {
+		std::cerr << "Failed to create material atlas" << std::endl;
+		return -1;
+	}
+	atlas->setMaterialColor(1, glm::vec3(0.45f, 0.75f, 0.35f)); // Hierba
+	atlas->setMaterialColor(2, glm::vec3(0.55f, 0.40f, 0.25f)); // Tierra
+	atlas->setMaterialColor(3, glm::vec3(0.50f, 0.50f, 0.50f)); // Piedra
+	atlas->setMaterialColor(MaterialTable::kLamp, glm::vec3(1.00f, 0.90f, 0.60f)); // Lmpara
+	atlas->setMaterialColor(MaterialTable::kGlass, glm::vec3(0.80f, 0.90f, 0.95f), 0.35f); // Cristal
+	atlas->setMaterialColor(MaterialTable::kLeaves, glm::vec3(0.25f, 0.55f, 0.20f), 1.0f, 0.35f); // Hojas
+	atlas->setMaterialColor(MaterialTable::kWater, glm::vec3(0.20f, 0.40f, 0.80f), 0.55f); // Agua
+
 	// Configurar matriz de proyeccin
 	glm::mat4 projection = glm::perspective(
 		glm::radians(60.0f),
 		1280.0f / 720.0f,
 		0.1f,
-		100.0f
+		500.0f
 	);
 
 	// Variables para FPS
@@ -184,13 +281,26 @@ int main() {
 
 	// Bucle principal
 	while (!glfwWindowShouldClose(window)) {
+		Profiler::get().beginFrame();
+
 		float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
 		// Input
+		glm::vec3 previousCameraPos = cameraPos;
 		processInput(window);
 
+		// La velocidad real de vuelo prioriza los chunks hacia donde se va
+		if (deltaTime > 0.0f)
+			world->setCameraVelocity((cameraPos - previousCameraPos) / deltaTime);
+
+		// Mips del atlas en streaming, un nivel por frame
+		{
+			PROFILE_SCOPE("Atlas mips");
+			atlas->update(1);
+		}
+
 		// Limpiar buffers
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -201,9 +311,6 @@ int main() {
 			cameraUp
 		);
 
-		// Matriz de modelo (identidad - en origen)
-		glm::mat4 model = glm::mat4(1.0f);
-
 		// Usar shader
 		shader->use();
 
@@ -212,16 +319,30 @@ int main() {
 		shader->setMat4("view", view);
 		shader->setVec3("camPos", cameraPos);
 
-		// Dibujar geometra
-		glBindVertexArray(vao);
-		glDrawElements(GL_TRIANGLES, mesh.indices.size(), GL_UNSIGNED_INT, 0); // 6 ndices = 2 tringulos
-		glBindVertexArray(0);
+		// Un solo binding de texturas para toda la geometra
+		atlas->bind(0);
+		shader->setInt("materials", 0);
+
+		// Streaming, remallado en los workers, subidas y dibujado del mundo
+		{
+			PROFILE_SCOPE("Draw");
+			GPU_PROFILE_SCOPE(*gpuTimer, "Draw");
+			world->render(shader, cameraPos, projection * view);
+		}
+		gpuTimer->collect();
+		world->updatePersistence();
 
 		// Actualizar FPS en el ttulo
 		frameCount++;
 		if (currentFrame - lastTime >= fpsUpdateInterval) {
 			float fps = frameCount / (currentFrame - lastTime);
+			FrameStats stats = Profiler::get().getFrameStats();
 			std::string title = "Voxel Test - FPS: " + std::to_string((int)fps) +
+				" - p50/p95/p99: " + std::to_string(stats.p50Ms).substr(0, 4) + "/" +
+				std::to_string(stats.p95Ms).substr(0, 4) + "/" +
+				std::to_string(stats.p99Ms).substr(0, 4) + " ms" +
+				" - Chunks: " + std::to_string(world->getVisibleChunks()) + "/" +
+				std::to_string(world->getTotalChunks()) +
 				" - Camera: (" +
 				std::to_string((int)cameraPos.x) + ", " +
 				std::to_string((int)cameraPos.y) + ", " +
@@ -232,16 +353,21 @@ int main() {
 		}
 
 		// Intercambiar buffers y procesar eventos
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("Swap");
+			glfwSwapBuffers(window);
+		}
 		glfwPollEvents();
+
+		Profiler::get().endFrame();
 	}
 
-	// Limpiar
+	// Limpiar (el mundo antes que el contexto GL)
+	delete collision;
+	delete world;
 	delete shader;
-
-	glDeleteVertexArrays(1, &vao);
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo);
+	delete atlas;
+	delete gpuTimer;
 
 	glfwTerminate();
 	return 0;